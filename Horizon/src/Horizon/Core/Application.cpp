@@ -2,6 +2,9 @@
 #include "Application.hpp"
 
 #include "Horizon/Core/Logging.hpp"
+#include "Horizon/Core/Jobs.hpp"
+
+#include "Horizon/Utils/AllocationTracker.hpp"
 
 namespace Hz
 {
@@ -9,10 +12,13 @@ namespace Hz
 	Application::Application()
 	{
 		Log::Init();
+		Jobs::Init();
 	}
 
 	Application::~Application()
 	{
+		Jobs::Destroy();
+		AllocationTracker::Shutdown();
 	}
 
 }
@@ -0,0 +1,124 @@
+#include "hzpch.h"
+#include "FrameAllocator.hpp"
+
+#include "Horizon/Core/Logging.hpp"
+
+#include "Horizon/Utils/Profiler.hpp"
+
+#include <cstdlib>
+
+namespace Hz
+{
+
+    void FrameAllocator::Init(uint32_t framesInFlight, size_t capacity)
+    {
+        HZ_ASSERT((framesInFlight > 0 && framesInFlight <= MaxFramesInFlight), "Invalid amount of frames in flight passed to FrameAllocator::Init.");
+        Destroy();
+
+        for (uint32_t i = 0; i < framesInFlight; i++)
+        {
+            Arena& arena = s_Data.Arenas[i];
+            arena.Memory = static_cast<byte*>(std::malloc(capacity));
+            arena.Capacity = (arena.Memory ? capacity : 0);
+        }
+
+        s_Data.Current.store(0, std::memory_order_relaxed);
+    }
+
+    void FrameAllocator::Destroy()
+    {
+        std::scoped_lock<std::mutex> lock(s_Data.OverflowMutex);
+
+        for (auto& arena : s_Data.Arenas)
+        {
+            for (void* ptr : arena.Overflow)
+                std::free(ptr);
+
+            std::free(arena.Memory);
+
+            arena.Memory = nullptr;
+            arena.Capacity = 0;
+            arena.Offset.store(0, std::memory_order_relaxed);
+            arena.Overflow.clear();
+            arena.OverflowBytes = 0;
+        }
+    }
+
+    void FrameAllocator::NewFrame(uint32_t frame)
+    {
+        HZ_ASSERT((frame < MaxFramesInFlight), "Frame index passed to FrameAllocator::NewFrame exceeds MaxFramesInFlight.");
+
+        std::scoped_lock<std::mutex> lock(s_Data.OverflowMutex);
+        Arena& arena = s_Data.Arenas[frame];
+
+        size_t used = std::min(arena.Offset.load(std::memory_order_relaxed), arena.Capacity) + arena.OverflowBytes;
+        s_Data.Peak = std::max<uint64_t>(s_Data.Peak, used);
+
+        // Note: When the arena overflowed we grow it, so the steady state doesn't touch the heap again
+        if (!arena.Overflow.empty())
+        {
+            for (void* ptr : arena.Overflow)
+                std::free(ptr);
+            arena.Overflow.clear();
+            arena.Overflow.shrink_to_fit();
+
+            size_t capacity = std::max(arena.Capacity * 2, used + used / 2);
+            HZ_LOG_WARN("FrameAllocator arena {0} overflowed by {1} bytes, growing it from {2} to {3} bytes.", frame, arena.OverflowBytes, arena.Capacity, capacity);
+
+            std::free(arena.Memory);
+            arena.Memory = static_cast<byte*>(std::malloc(capacity));
+            arena.Capacity = (arena.Memory ? capacity : 0);
+            arena.OverflowBytes = 0;
+        }
+
+        arena.Offset.store(0, std::memory_order_relaxed);
+        s_Data.Current.store(frame, std::memory_order_release);
+
+        HZ_PROFILE_PLOT("FrameAllocator Used", (int64_t)used);
+    }
+
+    void* FrameAllocator::Allocate(size_t size, size_t alignment)
+    {
+        Arena& arena = s_Data.Arenas[s_Data.Current.load(std::memory_order_acquire)];
+
+        // Note: We reserve enough for the worst case alignment, so a single atomic add is enough
+        size_t reserved = size + alignment - 1;
+        size_t offset = arena.Offset.fetch_add(reserved, std::memory_order_relaxed);
+
+        if (offset + reserved <= arena.Capacity)
+        {
+            uintptr_t address = reinterpret_cast<uintptr_t>(arena.Memory + offset);
+            address = (address + alignment - 1) & ~(uintptr_t)(alignment - 1);
+            return reinterpret_cast<void*>(address);
+        }
+
+        // Out of space, fall back to the heap until the arena is reset
+        std::scoped_lock<std::mutex> lock(s_Data.OverflowMutex);
+
+        void* ptr = std::malloc(size + alignment - 1);
+        if (!ptr)
+            throw std::bad_alloc();
+
+        arena.Overflow.push_back(ptr);
+        arena.OverflowBytes += size;
+        s_Data.Overflows.fetch_add(1, std::memory_order_relaxed);
+
+        uintptr_t address = reinterpret_cast<uintptr_t>(ptr);
+        address = (address + alignment - 1) & ~(uintptr_t)(alignment - 1);
+        return reinterpret_cast<void*>(address);
+    }
+
+    FrameAllocatorStatistics FrameAllocator::GetStatistics()
+    {
+        std::scoped_lock<std::mutex> lock(s_Data.OverflowMutex);
+        const Arena& arena = s_Data.Arenas[s_Data.Current.load(std::memory_order_acquire)];
+
+        FrameAllocatorStatistics statistics = {};
+        statistics.Capacity = arena.Capacity;
+        statistics.Used = std::min(arena.Offset.load(std::memory_order_relaxed), arena.Capacity) + arena.OverflowBytes;
+        statistics.Peak = std::max<uint64_t>(s_Data.Peak, statistics.Used);
+        statistics.Overflows = s_Data.Overflows.load(std::memory_order_relaxed);
+        return statistics;
+    }
+
+}
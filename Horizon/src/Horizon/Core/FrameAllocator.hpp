@@ -0,0 +1,204 @@
+#pragma once
+
+#include "Horizon/Core/Core.hpp"
+
+#include <new>
+#include <span>
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+
+namespace Hz
+{
+
+    ///////////////////////////////////////////////////////////
+    // Specifications
+    ///////////////////////////////////////////////////////////
+    struct FrameAllocatorStatistics
+    {
+    public:
+        uint64_t Capacity = 0;      // Of the current frame's arena
+        uint64_t Used = 0;          // Bytes handed out by the current frame's arena
+        uint64_t Peak = 0;          // Most bytes a single frame has ever used
+        uint64_t Overflows = 0;     // Allocations that didn't fit and went to the heap (the arena grows the next time around)
+    };
+
+    ///////////////////////////////////////////////////////////
+    // Core class
+    ///////////////////////////////////////////////////////////
+    // A linear (bump) allocator with one arena per frame in flight. Allocating is a single atomic add,
+    // there is no freeing, the whole arena is reset at once when its frame comes around again.
+    // This makes memory handed out during a frame valid until the same frame in flight begins again,
+    // so it may be referenced by anything that is done by then (e.g. GPU work of that frame).
+    // Note: Nothing allocated here gets destructed, only trivially destructible types are allowed.
+    class FrameAllocator
+    {
+    public:
+        static void Init(uint32_t framesInFlight, size_t capacity = DefaultCapacity);
+        static void Destroy();
+
+        static void NewFrame(uint32_t frame); // Note: Gets called by the renderer once the frame's previous work is done
+
+        static void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t)); // Can be called from any thread
+
+        // Returns uninitialized memory for count objects
+        template<typename T>
+        static T* Allocate(size_t count = 1)
+        {
+            static_assert(std::is_trivially_destructible_v<T>, "The FrameAllocator never calls destructors.");
+            return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+        }
+
+        template<typename T, typename ...TArgs>
+        static T* New(TArgs&& ...args)
+        {
+            return new (Allocate<T>(1)) T(std::forward<TArgs>(args)...);
+        }
+
+        template<typename T>
+        static std::span<T> AllocateSpan(size_t count)
+        {
+            return { Allocate<T>(count), count };
+        }
+
+        static FrameAllocatorStatistics GetStatistics();
+
+    public:
+        inline static constexpr const size_t DefaultCapacity = 1024ull * 1024ull; // Per frame in flight
+        inline static constexpr const uint32_t MaxFramesInFlight = 3;
+
+    private:
+        struct Arena
+        {
+        public:
+            byte* Memory = nullptr;
+            size_t Capacity = 0;
+            std::atomic<size_t> Offset = 0;
+
+            std::vector<void*> Overflow = { }; // Protected by the OverflowMutex
+            size_t OverflowBytes = 0;
+        };
+
+        // Note: We store our info in a struct, so we can ensure lifetime
+        // of all objects easily while the class remains static.
+        struct Info
+        {
+        public:
+            std::array<Arena, MaxFramesInFlight> Arenas = { };
+            std::atomic<uint32_t> Current = 0;
+
+            std::mutex OverflowMutex = {};
+            std::atomic<uint64_t> Overflows = 0;
+            uint64_t Peak = 0;
+        };
+
+        inline static Info s_Data = {};
+    };
+
+    ///////////////////////////////////////////////////////////
+    // Containers
+    ///////////////////////////////////////////////////////////
+    // Allows standard containers to live in the current frame's arena, deallocation is a no-op.
+    // Note: The container must not outlive the frame (in flight) it was created in.
+    template<typename T>
+    class FrameStdAllocator
+    {
+    public:
+        using value_type = T;
+
+        FrameStdAllocator() = default;
+        template<typename U>
+        FrameStdAllocator(const FrameStdAllocator<U>&) noexcept {}
+
+        T* allocate(size_t count) { return static_cast<T*>(FrameAllocator::Allocate(sizeof(T) * count, alignof(T))); }
+        void deallocate(T*, size_t) noexcept {}
+
+        template<typename U>
+        bool operator == (const FrameStdAllocator<U>&) const noexcept { return true; }
+    };
+
+    template<typename T>
+    using FrameVector = std::vector<T, FrameStdAllocator<T>>;
+
+    // A vector with room for N elements inline, when it grows beyond that it moves into the current frame's arena.
+    // Meant for short lived (stack) lists on hot paths, so they never touch the heap.
+    // Note: Growing invalidates pointers, just like std::vector.
+    template<typename T, size_t N>
+    class InlineVector
+    {
+    public:
+        static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>, "InlineVector only supports trivial types.");
+        static_assert((N > 0), "InlineVector needs room for at least 1 element.");
+
+        InlineVector() = default;
+        explicit InlineVector(size_t count, const T& value = T()) { resize(count, value); }
+        InlineVector(const InlineVector&) = delete;
+        InlineVector& operator = (const InlineVector&) = delete;
+
+        void reserve(size_t capacity)
+        {
+            if (capacity <= m_Capacity)
+                return;
+
+            T* data = FrameAllocator::Allocate<T>(capacity);
+            std::copy(m_Data, m_Data + m_Size, data);
+
+            m_Data = data;
+            m_Capacity = capacity;
+        }
+
+        void resize(size_t count, const T& value = T())
+        {
+            reserve(count);
+            for (size_t i = m_Size; i < count; i++)
+                m_Data[i] = value;
+
+            m_Size = count;
+        }
+
+        void push_back(const T& value)
+        {
+            if (m_Size == m_Capacity)
+                reserve(m_Capacity * 2);
+
+            m_Data[m_Size++] = value;
+        }
+
+        template<typename ...TArgs>
+        T& emplace_back(TArgs&& ...args)
+        {
+            if (m_Size == m_Capacity)
+                reserve(m_Capacity * 2);
+
+            return *new (&m_Data[m_Size++]) T(std::forward<TArgs>(args)...);
+        }
+
+        inline void clear() { m_Size = 0; }
+
+        inline T* data() { return m_Data; }
+        inline const T* data() const { return m_Data; }
+        inline size_t size() const { return m_Size; }
+        inline size_t capacity() const { return m_Capacity; }
+        inline bool empty() const { return (m_Size == 0); }
+
+        inline T* begin() { return m_Data; }
+        inline T* end() { return m_Data + m_Size; }
+        inline const T* begin() const { return m_Data; }
+        inline const T* end() const { return m_Data + m_Size; }
+
+        inline T& operator [] (size_t index) { return m_Data[index]; }
+        inline const T& operator [] (size_t index) const { return m_Data[index]; }
+
+    private:
+        alignas(T) byte m_Storage[sizeof(T) * N];
+
+        T* m_Data = reinterpret_cast<T*>(m_Storage);
+        size_t m_Size = 0;
+        size_t m_Capacity = N;
+    };
+
+}
@@ -0,0 +1,359 @@
+#include "hzpch.h"
+#include "Jobs.hpp"
+
+#include "Horizon/Core/Logging.hpp"
+
+#include "Horizon/Utils/Profiler.hpp"
+
+namespace Hz
+{
+
+    ///////////////////////////////////////////////////////////
+    // Counter
+    ///////////////////////////////////////////////////////////
+    JobCounter::JobCounter(uint32_t count)
+        : m_Pending(count)
+    {
+    }
+
+    void JobCounter::Decrement()
+    {
+        if (m_Pending.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return;
+
+        std::vector<JobFunction> continuations = { };
+        {
+            std::scoped_lock<std::mutex> lock(m_Mutex);
+            m_Finished = true;
+            continuations.swap(m_Continuations);
+        }
+
+        for (auto& continuation : continuations)
+            continuation();
+    }
+
+    bool JobCounter::AddContinuation(const JobFunction& continuation)
+    {
+        std::scoped_lock<std::mutex> lock(m_Mutex);
+        if (m_Finished)
+            return false;
+
+        m_Continuations.push_back(continuation);
+        return true;
+    }
+
+    ///////////////////////////////////////////////////////////
+    // Handle
+    ///////////////////////////////////////////////////////////
+    JobHandle::JobHandle(Ref<JobCounter> counter)
+        : m_Counter(counter)
+    {
+    }
+
+    void JobHandle::Wait() const
+    {
+        Jobs::Wait(*this);
+    }
+
+    ///////////////////////////////////////////////////////////
+    // Core class
+    ///////////////////////////////////////////////////////////
+    void Jobs::Init(uint32_t workerCount)
+    {
+        HZ_ASSERT((!s_Data.Running.load()), "Jobs::Init called while the pool is already running.");
+
+        s_Data.WorkerCount = workerCount;
+        s_Data.Queues = std::make_unique<Queue[]>(workerCount);
+        s_Data.Running.store(true);
+
+        s_Data.Workers.reserve(workerCount);
+        for (uint32_t i = 0; i < workerCount; i++)
+            s_Data.Workers.emplace_back(&Jobs::Worker, i);
+    }
+
+    void Jobs::Destroy()
+    {
+        if (!s_Data.Running.exchange(false))
+            return;
+
+        {
+            std::scoped_lock<std::mutex> lock(s_Data.SleepMutex);
+            s_Data.Condition.notify_all();
+        }
+
+        for (auto& worker : s_Data.Workers)
+            worker.join();
+
+        // Note: Whatever the workers didn't get to is finished here, so nobody waits forever
+        while (TryExecute());
+
+        s_Data.Workers.clear();
+        s_Data.Queues.reset();
+        s_Data.WorkerCount = 0;
+    }
+
+    JobHandle Jobs::Submit(JobFunction&& function, const char* name)
+    {
+        Ref<JobCounter> counter = Ref<JobCounter>::Create(1);
+        Schedule({ std::move(function), counter, name });
+
+        return JobHandle(counter);
+    }
+
+    JobHandle Jobs::Submit(JobFunction&& function, std::span<const JobHandle> dependencies, const char* name)
+    {
+        struct Deferred
+        {
+        public:
+            std::atomic<uint32_t> Remaining;
+            Job Pending;
+        };
+
+        Ref<JobCounter> counter = Ref<JobCounter>::Create(1);
+
+        // Note: The extra count is released at the end, so the job can't start while we're still registering
+        auto deferred = std::make_shared<Deferred>();
+        deferred->Remaining.store((uint32_t)dependencies.size() + 1);
+        deferred->Pending = { std::move(function), counter, name };
+
+        JobFunction release = [deferred]()
+        {
+            if (deferred->Remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                Schedule(std::move(deferred->Pending));
+        };
+
+        for (const auto& dependency : dependencies)
+        {
+            if (!dependency.m_Counter || !dependency.m_Counter->AddContinuation(release))
+                release();
+        }
+        release();
+
+        return JobHandle(counter);
+    }
+
+    JobHandle Jobs::ParallelFor(uint32_t count, uint32_t batchSize, JobRangeFunction&& function, const char* name)
+    {
+        if (count == 0)
+            return {};
+
+        batchSize = std::max(batchSize, 1u);
+        uint32_t batches = (count + batchSize - 1) / batchSize;
+
+        Ref<JobCounter> counter = Ref<JobCounter>::Create(batches);
+        auto shared = std::make_shared<JobRangeFunction>(std::move(function));
+
+        for (uint32_t i = 0; i < batches; i++)
+        {
+            uint32_t begin = i * batchSize;
+            uint32_t end = std::min(begin + batchSize, count);
+
+            Schedule({ [shared, begin, end]() { (*shared)(begin, end); }, counter, name });
+        }
+
+        return JobHandle(counter);
+    }
+
+    void Jobs::Wait(const JobHandle& handle)
+    {
+        HZ_PROFILE_SCOPE("Jobs::Wait");
+
+        while (!handle.Done())
+        {
+            if (!TryExecute())
+                std::this_thread::yield();
+        }
+    }
+
+    void Jobs::Wait(std::span<const JobHandle> handles)
+    {
+        for (const auto& handle : handles)
+            Wait(handle);
+    }
+
+    uint32_t Jobs::GetWorkerCount()
+    {
+        return s_Data.WorkerCount;
+    }
+
+    uint32_t Jobs::GetWorkerIndex()
+    {
+        return s_WorkerIndex;
+    }
+
+    uint32_t Jobs::GetDefaultWorkerCount()
+    {
+        // Note: One core is left for the main thread
+        return std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    }
+
+    void Jobs::Schedule(Job&& job)
+    {
+        if (!s_Data.Running.load(std::memory_order_acquire) || s_Data.WorkerCount == 0)
+        {
+            Execute(job);
+            return;
+        }
+
+        // Note: Workers push onto their own queue, other threads spread their jobs over all workers
+        uint32_t index = s_WorkerIndex;
+        if (index == NoWorker)
+            index = s_Data.NextQueue.fetch_add(1, std::memory_order_relaxed) % s_Data.WorkerCount;
+
+        s_Data.Queued.fetch_add(1);
+        {
+            Queue& queue = s_Data.Queues[index];
+            std::scoped_lock<std::mutex> lock(queue.Mutex);
+            queue.Jobs.push_back(std::move(job));
+        }
+
+        // Note: Taking the lock makes sure a worker that is about to sleep has seen the new job
+        if (s_Data.Sleeping.load() > 0)
+        {
+            { std::scoped_lock<std::mutex> lock(s_Data.SleepMutex); }
+            s_Data.Condition.notify_one();
+        }
+    }
+
+    void Jobs::Execute(Job& job)
+    {
+        {
+            HZ_PROFILE_SCOPE_DYNAMIC(job.Name);
+            job.Function();
+        }
+
+        // Note: The function is released before the counter, so its captures don't outlive the wait
+        job.Function = nullptr;
+        job.Counter->Decrement();
+    }
+
+    bool Jobs::TryExecute()
+    {
+        if (s_Data.WorkerCount == 0)
+            return false;
+
+        Job job = {};
+        bool found = false;
+
+        // Our own queue, newest first
+        if (s_WorkerIndex != NoWorker)
+        {
+            Queue& queue = s_Data.Queues[s_WorkerIndex];
+            std::scoped_lock<std::mutex> lock(queue.Mutex);
+            if (!queue.Jobs.empty())
+            {
+                job = std::move(queue.Jobs.back());
+                queue.Jobs.pop_back();
+                found = true;
+            }
+        }
+
+        // Steal the oldest job of another queue
+        uint32_t start = (s_WorkerIndex != NoWorker ? s_WorkerIndex + 1 : 0);
+        for (uint32_t i = 0; i < s_Data.WorkerCount && !found; i++)
+        {
+            Queue& queue = s_Data.Queues[(start + i) % s_Data.WorkerCount];
+            std::scoped_lock<std::mutex> lock(queue.Mutex);
+            if (!queue.Jobs.empty())
+            {
+                job = std::move(queue.Jobs.front());
+                queue.Jobs.pop_front();
+                found = true;
+            }
+        }
+
+        if (!found)
+            return false;
+
+        s_Data.Queued.fetch_sub(1);
+        Execute(job);
+        return true;
+    }
+
+    void Jobs::Worker(uint32_t index)
+    {
+        s_WorkerIndex = index;
+
+        std::string name = Text::Format("Horizon Worker {0}", index);
+        HZ_PROFILE_THREAD(name.c_str());
+
+        while (true)
+        {
+            if (TryExecute())
+                continue;
+
+            std::unique_lock<std::mutex> lock(s_Data.SleepMutex);
+            s_Data.Sleeping.fetch_add(1);
+            s_Data.Condition.wait(lock, []() { return (s_Data.Queued.load() > 0 || !s_Data.Running.load()); });
+            s_Data.Sleeping.fetch_sub(1);
+
+            if (!s_Data.Running.load())
+                break;
+        }
+    }
+
+    ///////////////////////////////////////////////////////////
+    // Graph
+    ///////////////////////////////////////////////////////////
+    JobGraph::Node JobGraph::Add(JobFunction&& function, const char* name)
+    {
+        m_Nodes.push_back({ std::move(function), name, { } });
+        return (Node)(m_Nodes.size() - 1);
+    }
+
+    void JobGraph::Precede(Node before, Node after)
+    {
+        HZ_ASSERT((before < m_Nodes.size() && after < m_Nodes.size()), "Invalid node passed to JobGraph::Precede.");
+        m_Nodes[after].Dependencies.push_back(before);
+    }
+
+    JobHandle JobGraph::Run()
+    {
+        // Note: Nodes are submitted in topological order, so the handles of their dependencies exist
+        std::vector<uint32_t> remaining(m_Nodes.size(), 0);
+        std::vector<std::vector<Node>> successors(m_Nodes.size());
+        for (Node node = 0; node < (Node)m_Nodes.size(); node++)
+        {
+            remaining[node] = (uint32_t)m_Nodes[node].Dependencies.size();
+            for (Node dependency : m_Nodes[node].Dependencies)
+                successors[dependency].push_back(node);
+        }
+
+        std::vector<Node> order = { };
+        order.reserve(m_Nodes.size());
+        for (Node node = 0; node < (Node)m_Nodes.size(); node++)
+        {
+            if (remaining[node] == 0)
+                order.push_back(node);
+        }
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            for (Node successor : successors[order[i]])
+            {
+                if (--remaining[successor] == 0)
+                    order.push_back(successor);
+            }
+        }
+
+        if (order.size() != m_Nodes.size())
+        {
+            HZ_LOG_ERROR("JobGraph contains a cycle, nothing was submitted.");
+            return {};
+        }
+
+        std::vector<JobHandle> handles(m_Nodes.size());
+        std::vector<JobHandle> dependencies = { };
+        for (Node node : order)
+        {
+            dependencies.clear();
+            for (Node dependency : m_Nodes[node].Dependencies)
+                dependencies.push_back(handles[dependency]);
+
+            JobFunction function = m_Nodes[node].Function; // Note: Copied, so the graph can be run again
+            handles[node] = Jobs::Submit(std::move(function), dependencies, m_Nodes[node].Name);
+        }
+
+        return Jobs::Submit([]() {}, handles, "JobGraph");
+    }
+
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include "Horizon/Core/Core.hpp"
+
+#include <span>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+
+namespace Hz
+{
+
+    using JobFunction = std::function<void()>;
+    using JobRangeFunction = std::function<void(uint32_t begin, uint32_t end)>; // Note: end is exclusive
+
+    ///////////////////////////////////////////////////////////
+    // Counter
+    ///////////////////////////////////////////////////////////
+    // Counts the jobs that still have to finish, once it hits zero its continuations get run.
+    class JobCounter : public RefCounted
+    {
+    public:
+        JobCounter(uint32_t count);
+        ~JobCounter() = default;
+
+        inline bool Done() const { return (m_Pending.load(std::memory_order_acquire) == 0); }
+
+    private:
+        void Decrement();
+        bool AddContinuation(const JobFunction& continuation); // Returns false when the counter is already done
+
+    private:
+        std::atomic<uint32_t> m_Pending;
+
+        std::mutex m_Mutex = {};
+        bool m_Finished = false;
+        std::vector<JobFunction> m_Continuations = { };
+
+        friend class Jobs;
+    };
+
+    ///////////////////////////////////////////////////////////
+    // Handle
+    ///////////////////////////////////////////////////////////
+    // A lightweight reference to submitted work, an empty handle is always done.
+    class JobHandle
+    {
+    public:
+        JobHandle() = default;
+        JobHandle(Ref<JobCounter> counter);
+        ~JobHandle() = default;
+
+        inline bool Done() const { return (!m_Counter || m_Counter->Done()); }
+        void Wait() const; // Note: Executes other jobs while waiting
+
+        inline bool Valid() const { return (bool)m_Counter; }
+
+    private:
+        Ref<JobCounter> m_Counter = nullptr;
+
+        friend class Jobs;
+    };
+
+    ///////////////////////////////////////////////////////////
+    // Core class
+    ///////////////////////////////////////////////////////////
+    // A work-stealing thread pool. Every worker has its own queue, it takes its newest job first (cache friendly)
+    // and when it runs dry it steals the oldest job of another worker. Threads that aren't workers (like the main thread)
+    // spread their jobs over the workers and help out while they Wait().
+    // Note: When the pool isn't running (or has no workers) jobs are executed right away on the submitting thread.
+    class Jobs
+    {
+    public:
+        static void Init(uint32_t workerCount = GetDefaultWorkerCount());
+        static void Destroy(); // Note: Finishes all queued jobs before returning
+
+        static JobHandle Submit(JobFunction&& function, const char* name = "Job");
+        static JobHandle Submit(JobFunction&& function, std::span<const JobHandle> dependencies, const char* name = "Job"); // Starts once all dependencies are done
+
+        // Splits [0, count) into batches of batchSize, which run in parallel
+        static JobHandle ParallelFor(uint32_t count, uint32_t batchSize, JobRangeFunction&& function, const char* name = "ParallelFor");
+
+        static void Wait(const JobHandle& handle);
+        static void Wait(std::span<const JobHandle> handles);
+
+        static uint32_t GetWorkerCount();
+        static uint32_t GetWorkerIndex(); // Note: Returns NoWorker on threads which aren't workers
+        static uint32_t GetDefaultWorkerCount();
+
+    public:
+        inline static constexpr const uint32_t NoWorker = UINT32_MAX;
+
+    private:
+        struct Job
+        {
+        public:
+            JobFunction Function = nullptr;
+            Ref<JobCounter> Counter = nullptr;
+            const char* Name = "Job";
+        };
+
+        struct Queue
+        {
+        public:
+            std::mutex Mutex = {};
+            std::deque<Job> Jobs = { };
+        };
+
+        static void Schedule(Job&& job);
+        static void Execute(Job& job);
+        static bool TryExecute(); // Runs a single job of our own queue or stolen from another, returns false when there was none
+        static void Worker(uint32_t index);
+
+    private:
+        // Note: We store our info in a struct, so we can ensure lifetime
+        // of all objects easily while the class remains static.
+        struct Info
+        {
+        public:
+            std::vector<std::thread> Workers = { };
+            std::unique_ptr<Queue[]> Queues = nullptr; // One for every worker
+            uint32_t WorkerCount = 0;
+
+            std::atomic<bool> Running = false;
+            std::atomic<uint32_t> Queued = 0;       // Jobs waiting in the queues
+            std::atomic<uint32_t> Sleeping = 0;     // Workers waiting on the condition
+            std::atomic<uint32_t> NextQueue = 0;    // For distributing jobs of other threads
+
+            std::mutex SleepMutex = {};
+            std::condition_variable Condition = {};
+        };
+
+        inline static Info s_Data = {};
+        inline static thread_local uint32_t s_WorkerIndex = NoWorker;
+    };
+
+    ///////////////////////////////////////////////////////////
+    // Graph
+    ///////////////////////////////////////////////////////////
+    // Describes jobs and the order between them up front, Run() submits every node once its predecessors are done.
+    // A graph can be run multiple times.
+    class JobGraph
+    {
+    public:
+        using Node = uint32_t;
+
+        JobGraph() = default;
+        ~JobGraph() = default;
+
+        Node Add(JobFunction&& function, const char* name = "Job");
+        void Precede(Node before, Node after); // after only starts once before is done
+
+        JobHandle Run(); // The handle is done once all nodes are done
+
+        inline size_t Size() const { return m_Nodes.size(); }
+
+    private:
+        struct Entry
+        {
+        public:
+            JobFunction Function = nullptr;
+            const char* Name = "Job";
+            std::vector<Node> Dependencies = { };
+        };
+
+        std::vector<Entry> m_Nodes = { };
+    };
+
+}
@@ -3,6 +3,7 @@
 
 #include "Horizon/Core/Logging.hpp"
 #include "Horizon/Utils/Profiler.hpp"
+#include "Horizon/Utils/AllocationTracker.hpp"
 
 #include "Horizon/Renderer/Renderer.hpp"
 #include "Horizon/Renderer/GraphicsContext.hpp"
@@ -148,6 +149,7 @@ namespace Hz
 	void Window::PollEvents()
 	{
         HZ_MARK_FRAME();
+        HZ_ALLOCATION_TAG(AllocationTag::Core);
 		glfwPollEvents();
 	}
 
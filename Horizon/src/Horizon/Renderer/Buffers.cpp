@@ -61,24 +61,123 @@ namespace Hz
 		return 0;
 	}
 
-	BufferLayout::BufferLayout(const std::initializer_list<BufferElement>& elements)
-		: m_Elements(elements)
+	BufferLayout::BufferLayout(const std::initializer_list<BufferElement>& elements, BufferPacking packing)
+		: m_Elements(elements), m_Packing(packing)
 	{
 		CalculateOffsetsAndStride();
 	}
 
+	BufferLayout::BufferLayout(const std::vector<BufferElement>& elements, BufferPacking packing)
+		: m_Elements(elements), m_Packing(packing)
+	{
+		CalculateOffsetsAndStride();
+	}
+
+    // Returns the { alignment, size } of a type inside a std430 struct
+    static std::pair<size_t, size_t> Std430AlignmentAndSize(DataType type)
+    {
+        switch (type)
+        {
+        case DataType::Float:   return { 4, 4 };
+        case DataType::Float2:  return { 8, 8 };
+        case DataType::Float3:  return { 16, 12 };
+        case DataType::Float4:  return { 16, 16 };
+        case DataType::Mat3:    return { 16, 16 * 3 }; // Every column is padded to a vec4
+        case DataType::Mat4:    return { 16, 16 * 4 };
+        case DataType::Int:     return { 4, 4 };
+        case DataType::Int2:    return { 8, 8 };
+        case DataType::Int3:    return { 16, 12 };
+        case DataType::Int4:    return { 16, 16 };
+        case DataType::Bool:    return { 4, 4 };   // A bool is 32 bits in GLSL
+        }
+
+		HZ_ASSERT(false, "Unknown DataType!");
+        return { 0, 0 };
+    }
+
 	void BufferLayout::CalculateOffsetsAndStride()
 	{
 		size_t offset = 0;
 		m_Stride = 0;
-		for (auto& element : m_Elements)
-		{
-			element.Offset = offset;
-			offset += element.Size;
-			m_Stride += element.Size;
-		}
+
+        if (m_Packing == BufferPacking::Tight)
+        {
+		    for (auto& element : m_Elements)
+		    {
+			    element.Offset = offset;
+			    offset += element.Size;
+			    m_Stride += element.Size;
+		    }
+
+            return;
+        }
+
+        // Std430
+        size_t structAlignment = 4;
+        for (auto& element : m_Elements)
+        {
+            auto [alignment, size] = Std430AlignmentAndSize(element.Type);
+            structAlignment = std::max(structAlignment, alignment);
+
+            offset = (offset + alignment - 1) & ~(alignment - 1);
+            element.Offset = offset;
+            offset += size;
+        }
+
+        // The stride of an array of structs is rounded up to the struct's alignment
+        m_Stride = (uint32_t)((offset + structAlignment - 1) & ~(structAlignment - 1));
 	}
 
+    namespace VertexPulling
+    {
+
+        BufferLayout Std430(const BufferLayout& layout)
+        {
+            return BufferLayout(layout.GetElements(), BufferPacking::Std430);
+        }
+
+        std::vector<uint8_t> Repack(const BufferLayout& src, const BufferLayout& dst, const void* vertices, size_t vertexCount)
+        {
+            HZ_ASSERT((src.GetElements().size() == dst.GetElements().size()), "Source and destination layout don't have the same amount of elements.");
+
+            std::vector<uint8_t> result((size_t)dst.GetStride() * vertexCount, 0);
+            const uint8_t* source = static_cast<const uint8_t*>(vertices);
+
+            const auto& srcElements = src.GetElements();
+            const auto& dstElements = dst.GetElements();
+
+            for (size_t vertex = 0; vertex < vertexCount; vertex++)
+            {
+                const uint8_t* srcVertex = source + vertex * src.GetStride();
+                uint8_t* dstVertex = result.data() + vertex * dst.GetStride();
+
+                for (size_t i = 0; i < srcElements.size(); i++)
+                {
+                    const BufferElement& srcElement = srcElements[i];
+                    const BufferElement& dstElement = dstElements[i];
+
+                    // Matrices have padded columns in std430, so we copy them column by column
+                    if (srcElement.Type == DataType::Mat3)
+                    {
+                        const size_t srcColumn = (src.GetPacking() == BufferPacking::Std430 ? 16 : 12);
+                        const size_t dstColumn = (dst.GetPacking() == BufferPacking::Std430 ? 16 : 12);
+
+                        for (size_t column = 0; column < 3; column++)
+                            memcpy(dstVertex + dstElement.Offset + column * dstColumn, srcVertex + srcElement.Offset + column * srcColumn, 12);
+
+                        continue;
+                    }
+
+                    // Note: Bools are 1 byte in the tight layout and 4 bytes in std430, the remaining bytes are already zeroed.
+                    memcpy(dstVertex + dstElement.Offset, srcVertex + srcElement.Offset, std::min(srcElement.Size, dstElement.Size));
+                }
+            }
+
+            return result;
+        }
+
+    }
+
     ///////////////////////////////////////////////////////////
     // Buffers
     ///////////////////////////////////////////////////////////
@@ -21,6 +21,12 @@ namespace Hz
 	};
 	size_t DataTypeSize(DataType type);
 
+    enum class BufferPacking : uint8_t
+    {
+        Tight = 0,  // Elements are tightly packed, used for fixed-function vertex input
+        Std430      // Elements follow std430 rules, used for vertex pulling from storage buffers
+    };
+
 	struct BufferElement
 	{
 	public:
@@ -42,10 +48,12 @@ namespace Hz
 	{
 	public:
 		BufferLayout() = default;
-		BufferLayout(const std::initializer_list<BufferElement>& elements);
+		BufferLayout(const std::initializer_list<BufferElement>& elements, BufferPacking packing = BufferPacking::Tight);
+		BufferLayout(const std::vector<BufferElement>& elements, BufferPacking packing = BufferPacking::Tight);
 		~BufferLayout() = default;
 
 		inline uint32_t GetStride() const { return m_Stride; }
+		inline BufferPacking GetPacking() const { return m_Packing; }
 		inline const std::vector<BufferElement>& GetElements() const { return m_Elements; }
 
 		inline std::vector<BufferElement>::iterator begin() { return m_Elements.begin(); }
@@ -59,8 +67,19 @@ namespace Hz
 	private:
 		std::vector<BufferElement> m_Elements = { };
 		uint32_t m_Stride = 0;
+        BufferPacking m_Packing = BufferPacking::Tight;
 	};
 
+    // Helpers for laying out mesh data for vertex pulling (fetching vertices manually in the shader).
+    namespace VertexPulling
+    {
+        // Returns the same elements laid out as a std430 struct, as seen by a shader reading `Vertex vertices[]` from a storage buffer or buffer reference.
+        BufferLayout Std430(const BufferLayout& layout);
+
+        // Repacks `vertexCount` vertices from the `src` layout to the `dst` layout, elements are matched by index.
+        std::vector<uint8_t> Repack(const BufferLayout& src, const BufferLayout& dst, const void* vertices, size_t vertexCount);
+    }
+
     enum class BufferMemoryUsage
     {
         Unknown = 0,
@@ -77,6 +96,10 @@ namespace Hz
     {
     public:
         BufferMemoryUsage Usage = BufferMemoryUsage::GPU;
+
+        // Vertex pulling
+        bool StorageAccess = false; // Allows Vertex/Index buffers to be uploaded to a DescriptorType::StorageBuffer
+        bool DeviceAddress = false; // Allows retrieving the buffer's device address with GetDeviceAddress()
     };
 
 	///////////////////////////////////////////////////////////
@@ -91,6 +114,9 @@ namespace Hz
 		virtual void Bind(Ref<CommandBuffer> commandBuffer) const = 0;
         static void Bind(Ref<CommandBuffer> commandBuffer, std::vector<Ref<VertexBuffer>>&& buffers);
 
+        virtual size_t GetSize() const = 0;
+        virtual uint64_t GetDeviceAddress() const = 0; // Requires BufferSpecification::DeviceAddress
+
 		static Ref<VertexBuffer> Create(const BufferSpecification& specs, void* data, size_t size);
 	};
 
@@ -103,6 +129,7 @@ namespace Hz
 		virtual void Bind(Ref<CommandBuffer> commandBuffer) const = 0;
 
 		virtual uint32_t GetCount() const = 0;
+        virtual uint64_t GetDeviceAddress() const = 0; // Requires BufferSpecification::DeviceAddress
 
 		static Ref<IndexBuffer> Create(const BufferSpecification& specs, uint32_t* indices, uint32_t count);
 	};
@@ -155,6 +182,7 @@ namespace Hz
 		virtual void SetData(void* data, size_t size, size_t offset = 0) = 0;
 
 		virtual size_t GetSize() const = 0;
+        virtual uint64_t GetDeviceAddress() const = 0; // Of the current frame's buffer, requires BufferSpecification::DeviceAddress
 
 		static Ref<StorageBuffer> Create(const BufferSpecification& specs, size_t dataSize);
 	};
@@ -7,6 +7,52 @@
 namespace Hz
 {
 
+    // Commands recorded by the renderer (on the CPU)
+    struct RenderCounters
+    {
+    public:
+        uint32_t Draws = 0;
+        uint32_t Dispatches = 0;
+
+        uint32_t PipelineBinds = 0;
+        uint32_t DescriptorBinds = 0;
+        uint32_t VertexBufferBinds = 0;
+        uint32_t IndexBufferBinds = 0;
+
+        uint32_t Barriers = 0;  // Note: Barriers recorded by the renderer itself (uploads, transitions, mips) only show up in the frame counters
+
+        // Binds that were skipped, since the exact same thing was already bound
+        uint32_t ElidedPipelineBinds = 0;
+        uint32_t ElidedDescriptorBinds = 0;
+        uint32_t ElidedVertexBufferBinds = 0;
+        uint32_t ElidedIndexBufferBinds = 0;
+        uint32_t ElidedViewports = 0;
+        uint32_t ElidedScissors = 0;
+    };
+
+    // Collected on the GPU with a pipeline statistics query
+    struct PipelineStatistics
+    {
+    public:
+        uint64_t InputVertices = 0;
+        uint64_t InputPrimitives = 0;
+        uint64_t VertexInvocations = 0;
+        uint64_t ClippingInvocations = 0;
+        uint64_t ClippingPrimitives = 0;     // Primitives that survived clipping
+        uint64_t FragmentInvocations = 0;    // Compare with the amount of pixels to spot overdraw
+        uint64_t ComputeInvocations = 0;
+    };
+
+    struct PassStatistics
+    {
+    public:
+        PipelineStatistics Pipeline = { };
+        RenderCounters Counters = { };
+
+        uint64_t Frame = 0;             // The frame the command buffer was recorded in
+        bool Available = false;         // Whether Pipeline is filled in, Note: Requires the pipelineStatisticsQuery feature
+    };
+
     class CommandBuffer : public RefCounted
     {
     public:
@@ -15,6 +61,9 @@ namespace Hz
 
         // The Begin, End & Submit methods are in the Renderer class
 
+        // Note: Statistics of the last recording that finished executing, they lag behind by the amount of frames in flight
+        virtual PassStatistics GetStatistics() const = 0;
+
         static Ref<CommandBuffer> Create();
     };
 
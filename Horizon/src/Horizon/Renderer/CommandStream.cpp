@@ -0,0 +1,183 @@
+#include "hzpch.h"
+#include "CommandStream.hpp"
+
+#include "Horizon/Core/Logging.hpp"
+
+#include <numeric>
+
+namespace Hz
+{
+
+    ///////////////////////////////////////////////////////////
+    // State
+    ///////////////////////////////////////////////////////////
+    // Note: Binding what's already bound doesn't dirty the state, so commands keep sharing it
+    void CommandStream::BindPipeline(Ref<Pipeline> pipeline, PipelineBindPoint bindPoint)
+    {
+        if (m_Current.BoundPipeline.Raw() == pipeline.Raw() && m_Current.BindPoint == bindPoint)
+            return;
+
+        m_Current.BoundPipeline = pipeline;
+        m_Current.BindPoint = bindPoint;
+        m_Dirty = true;
+    }
+
+    void CommandStream::BindDescriptorSet(Ref<DescriptorSet> set, std::span<const uint32_t> dynamicOffsets)
+    {
+        uint32_t setID = set->GetSetID();
+        HZ_ASSERT((setID < CommandState::MaxDescriptorSets), "Set ID passed to CommandStream::BindDescriptorSet exceeds CommandState::MaxDescriptorSets.");
+
+        if (m_Current.Sets[setID].Raw() == set.Raw() && dynamicOffsets.empty() && m_Current.DynamicOffsetCount[setID] == 0)
+            return;
+
+        m_Current.Sets[setID] = set;
+        m_Current.DynamicOffsetStart[setID] = (uint32_t)m_DynamicOffsets.size();
+        m_Current.DynamicOffsetCount[setID] = (uint32_t)dynamicOffsets.size();
+        m_DynamicOffsets.insert(m_DynamicOffsets.end(), dynamicOffsets.begin(), dynamicOffsets.end());
+        m_Dirty = true;
+    }
+
+    void CommandStream::BindVertexBuffer(Ref<VertexBuffer> buffer)
+    {
+        if (m_Current.Vertices.Raw() == buffer.Raw())
+            return;
+
+        m_Current.Vertices = buffer;
+        m_Dirty = true;
+    }
+
+    void CommandStream::BindIndexBuffer(Ref<IndexBuffer> buffer)
+    {
+        if (m_Current.Indices.Raw() == buffer.Raw())
+            return;
+
+        m_Current.Indices = buffer;
+        m_Dirty = true;
+    }
+
+    ///////////////////////////////////////////////////////////
+    // Commands
+    ///////////////////////////////////////////////////////////
+    void CommandStream::Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance)
+    {
+        HZ_ASSERT((m_Current.BoundPipeline), "CommandStream::Draw called without a bound pipeline.");
+
+        CommandPacket packet = {};
+        packet.Type = CommandType::Draw;
+        packet.State = FlushState();
+        packet.Draw = { vertexCount, instanceCount, firstVertex, firstInstance };
+        m_Packets.push_back(packet);
+    }
+
+    void CommandStream::DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance)
+    {
+        HZ_ASSERT((m_Current.BoundPipeline && m_Current.Indices), "CommandStream::DrawIndexed called without a bound pipeline or index buffer.");
+
+        CommandPacket packet = {};
+        packet.Type = CommandType::DrawIndexed;
+        packet.State = FlushState();
+        packet.DrawIndexed = { indexCount, instanceCount, firstIndex, vertexOffset, firstInstance };
+        m_Packets.push_back(packet);
+    }
+
+    void CommandStream::Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+    {
+        HZ_ASSERT((m_Current.BoundPipeline), "CommandStream::Dispatch called without a bound pipeline.");
+
+        CommandPacket packet = {};
+        packet.Type = CommandType::Dispatch;
+        packet.State = FlushState();
+        packet.Dispatch = { groupCountX, groupCountY, groupCountZ };
+        m_Packets.push_back(packet);
+    }
+
+    ///////////////////////////////////////////////////////////
+    // Stream
+    ///////////////////////////////////////////////////////////
+    void CommandStream::Append(const CommandStream& other)
+    {
+        uint32_t stateOffset = (uint32_t)m_States.size();
+        uint32_t dynamicOffset = (uint32_t)m_DynamicOffsets.size();
+
+        m_States.reserve(m_States.size() + other.m_States.size());
+        for (const auto& state : other.m_States)
+        {
+            CommandState& appended = m_States.emplace_back(state);
+            for (auto& start : appended.DynamicOffsetStart)
+                start += dynamicOffset;
+        }
+
+        m_DynamicOffsets.insert(m_DynamicOffsets.end(), other.m_DynamicOffsets.begin(), other.m_DynamicOffsets.end());
+
+        m_Packets.reserve(m_Packets.size() + other.m_Packets.size());
+        for (CommandPacket packet : other.m_Packets)
+        {
+            packet.State += stateOffset;
+            m_Packets.push_back(packet);
+        }
+
+        // Note: Our last state is no longer at the back, so it has to be stored again
+        m_Dirty = true;
+    }
+
+    void CommandStream::Reset()
+    {
+        m_Packets.clear();
+        m_States.clear();
+        m_DynamicOffsets.clear();
+
+        m_Current = {};
+        m_Dirty = true;
+    }
+
+    void CommandStream::SortByState()
+    {
+        // Note: We rank the states once, so sorting the packets only compares integers
+        auto less = [this](uint32_t a, uint32_t b) -> bool
+        {
+            const CommandState& left = m_States[a];
+            const CommandState& right = m_States[b];
+
+            if (left.BoundPipeline.Raw() != right.BoundPipeline.Raw())
+                return left.BoundPipeline.Raw() < right.BoundPipeline.Raw();
+
+            for (uint32_t i = 0; i < CommandState::MaxDescriptorSets; i++)
+            {
+                if (left.Sets[i].Raw() != right.Sets[i].Raw())
+                    return left.Sets[i].Raw() < right.Sets[i].Raw();
+            }
+
+            if (left.Vertices.Raw() != right.Vertices.Raw())
+                return left.Vertices.Raw() < right.Vertices.Raw();
+
+            return left.Indices.Raw() < right.Indices.Raw();
+        };
+
+        std::vector<uint32_t> order(m_States.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), less);
+
+        std::vector<uint32_t> rank(m_States.size());
+        for (uint32_t i = 0; i < (uint32_t)order.size(); i++)
+            rank[order[i]] = i;
+
+        Sort([&rank](const CommandPacket& a, const CommandPacket& b) { return rank[a.State] < rank[b.State]; });
+    }
+
+    void CommandStream::FilterByPipeline(Ref<Pipeline> pipeline)
+    {
+        Filter([this, raw = pipeline.Raw()](const CommandPacket& packet) { return (m_States[packet.State].BoundPipeline.Raw() == raw); });
+    }
+
+    uint32_t CommandStream::FlushState()
+    {
+        if (m_Dirty)
+        {
+            m_States.push_back(m_Current);
+            m_Dirty = false;
+        }
+
+        return (uint32_t)(m_States.size() - 1);
+    }
+
+}
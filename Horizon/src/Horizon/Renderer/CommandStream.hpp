@@ -0,0 +1,138 @@
+#pragma once
+
+#include "Horizon/Core/Core.hpp"
+
+#include "Horizon/Renderer/Pipeline.hpp"
+#include "Horizon/Renderer/Descriptors.hpp"
+#include "Horizon/Renderer/Buffers.hpp"
+
+#include <span>
+#include <array>
+#include <vector>
+#include <algorithm>
+
+namespace Hz
+{
+
+    ///////////////////////////////////////////////////////////
+    // Specifications
+    ///////////////////////////////////////////////////////////
+    enum class CommandType : uint8_t { Draw = 0, DrawIndexed, Dispatch };
+
+    // Everything that has to be bound for a command, deduplicated so consecutive commands share one
+    struct CommandState
+    {
+    public:
+        inline static constexpr const uint32_t MaxDescriptorSets = 4;
+
+        Ref<Pipeline> BoundPipeline = nullptr;
+        PipelineBindPoint BindPoint = PipelineBindPoint::Graphics;
+
+        std::array<Ref<DescriptorSet>, MaxDescriptorSets> Sets = { };  // Indexed by set ID
+        std::array<uint32_t, MaxDescriptorSets> DynamicOffsetStart = { }; // Into CommandStream::GetDynamicOffsets()
+        std::array<uint32_t, MaxDescriptorSets> DynamicOffsetCount = { };
+
+        Ref<VertexBuffer> Vertices = nullptr;
+        Ref<IndexBuffer> Indices = nullptr;
+    };
+
+    struct DrawArguments
+    {
+    public:
+        uint32_t VertexCount;
+        uint32_t InstanceCount;
+        uint32_t FirstVertex;
+        uint32_t FirstInstance;
+    };
+
+    struct DrawIndexedArguments
+    {
+    public:
+        uint32_t IndexCount;
+        uint32_t InstanceCount;
+        uint32_t FirstIndex;
+        int32_t VertexOffset;
+        uint32_t FirstInstance;
+    };
+
+    struct DispatchArguments
+    {
+    public:
+        uint32_t GroupCountX;
+        uint32_t GroupCountY;
+        uint32_t GroupCountZ;
+    };
+
+    // A single recorded command, Note: Trivially copyable so the stream can be sorted & filtered cheaply
+    struct CommandPacket
+    {
+    public:
+        CommandType Type = CommandType::Draw;
+        uint32_t State = 0; // Index into CommandStream::GetState()
+
+        union
+        {
+            DrawArguments Draw;
+            DrawIndexedArguments DrawIndexed;
+            DispatchArguments Dispatch;
+        };
+    };
+    static_assert((sizeof(CommandPacket) <= 32), "CommandPacket should stay compact.");
+
+    ///////////////////////////////////////////////////////////
+    // Core class
+    ///////////////////////////////////////////////////////////
+    // Records draws/dispatches with the state they need into a linear buffer instead of calling into the driver.
+    // The recorded commands can be sorted & filtered and are translated by Renderer::Replay() into one or more command buffers.
+    // Note: A stream isn't thread safe, use one per recording thread and Append() them together afterwards.
+    // The stream keeps everything it references alive until Reset(), with a render thread it is read when the
+    // frame executes, so don't touch it until the next Present() (e.g. alternate between two).
+    class CommandStream : public RefCounted
+    {
+    public:
+        CommandStream() = default;
+        ~CommandStream() = default;
+
+        // State, applies to all commands recorded afterwards
+        void BindPipeline(Ref<Pipeline> pipeline, PipelineBindPoint bindPoint = PipelineBindPoint::Graphics);
+        void BindDescriptorSet(Ref<DescriptorSet> set, std::span<const uint32_t> dynamicOffsets = { });
+        void BindVertexBuffer(Ref<VertexBuffer> buffer);
+        void BindIndexBuffer(Ref<IndexBuffer> buffer);
+
+        // Commands
+        void Draw(uint32_t vertexCount = 3, uint32_t instanceCount = 1, uint32_t firstVertex = 0, uint32_t firstInstance = 0);
+        void DrawIndexed(uint32_t indexCount, uint32_t instanceCount = 1, uint32_t firstIndex = 0, int32_t vertexOffset = 0, uint32_t firstInstance = 0);
+        void Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ);
+
+        void Append(const CommandStream& other); // Adds the commands of other after ours
+        void Reset(); // Note: Keeps the memory around for the next recording
+
+        // Note: Stable, so commands which compare equal keep their recorded order
+        template<typename TCompare>
+        void Sort(TCompare&& less) { std::stable_sort(m_Packets.begin(), m_Packets.end(), std::forward<TCompare>(less)); }
+        void SortByState(); // Groups commands by pipeline, then descriptor sets, then buffers
+
+        template<typename TPredicate>
+        void Filter(TPredicate&& keep) { std::erase_if(m_Packets, [&](const CommandPacket& packet) { return !keep(packet); }); }
+        void FilterByPipeline(Ref<Pipeline> pipeline); // Keeps only the commands using pipeline
+
+        inline std::span<const CommandPacket> GetPackets() const { return m_Packets; }
+        inline const CommandState& GetState(uint32_t index) const { return m_States[index]; }
+        inline std::span<const uint32_t> GetDynamicOffsets() const { return m_DynamicOffsets; }
+
+        inline size_t Size() const { return m_Packets.size(); }
+        inline bool Empty() const { return m_Packets.empty(); }
+
+    private:
+        uint32_t FlushState(); // Returns the index of the current state, storing it first if it changed
+
+    private:
+        std::vector<CommandPacket> m_Packets = { };
+        std::vector<CommandState> m_States = { };
+        std::vector<uint32_t> m_DynamicOffsets = { };
+
+        CommandState m_Current = { };
+        bool m_Dirty = true;
+    };
+
+}
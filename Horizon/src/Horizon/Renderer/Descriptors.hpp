@@ -138,7 +138,7 @@ namespace Hz
     struct Uploadable
     {
     public:
-        using Type = std::variant<Ref<Image>, Ref<UniformBuffer>, Ref<StorageBuffer>>;
+        using Type = std::variant<Ref<Image>, Ref<Sampler>, Ref<UniformBuffer>, Ref<StorageBuffer>, Ref<VertexBuffer>, Ref<IndexBuffer>>; // Note: Vertex/Index buffers need BufferSpecification::StorageAccess
     public:
         Type Value;
         Descriptor Element;
@@ -160,6 +160,8 @@ namespace Hz
 		virtual void Bind(Ref<Pipeline> pipeline, Ref<CommandBuffer> commandBuffer, PipelineBindPoint bindPoint = PipelineBindPoint::Graphics, const std::vector<uint32_t>& dynamicOffsets = { }) = 0;
 
         virtual void Upload(const std::initializer_list<Uploadable>& elements) = 0;
+
+        virtual uint32_t GetSetID() const = 0;
     };
 
 	class DescriptorSets : public RefCounted
@@ -6,6 +6,7 @@
 #include "Horizon/Renderer/Descriptors.hpp"
 
 #include "Horizon/Vulkan/VulkanImage.hpp"
+#include "Horizon/Vulkan/VulkanSampler.hpp"
 #include "Horizon/Vulkan/VulkanContext.hpp"
 
 #include <Pulse/Enum/Enum.hpp>
@@ -31,6 +32,64 @@ namespace Hz
 	{
 	}
 
+	ImageFormatInfo ImageFormatInfo::Get(ImageFormat format)
+	{
+		switch (format)
+		{
+		case ImageFormat::RGBA16SFloat:
+		case ImageFormat::Depth32SFloatS8:
+			return { 1, 1, 8, false };
+
+		case ImageFormat::BC1:
+		case ImageFormat::BC1sRGB:
+		case ImageFormat::BC1A:
+		case ImageFormat::BC1AsRGB:
+		case ImageFormat::BC4:
+		case ImageFormat::BC4SNorm:
+		case ImageFormat::ETC2:
+		case ImageFormat::ETC2sRGB:
+		case ImageFormat::ETC2A1:
+		case ImageFormat::ETC2A1sRGB:
+			return { 4, 4, 8, true };
+
+		case ImageFormat::BC2:
+		case ImageFormat::BC2sRGB:
+		case ImageFormat::BC3:
+		case ImageFormat::BC3sRGB:
+		case ImageFormat::BC5:
+		case ImageFormat::BC5SNorm:
+		case ImageFormat::BC6H:
+		case ImageFormat::BC6HSFloat:
+		case ImageFormat::BC7:
+		case ImageFormat::BC7sRGB:
+		case ImageFormat::ETC2A:
+		case ImageFormat::ETC2AsRGB:
+		case ImageFormat::ASTC4x4:
+		case ImageFormat::ASTC4x4sRGB:
+			return { 4, 4, 16, true };
+
+		case ImageFormat::ASTC6x6:
+		case ImageFormat::ASTC6x6sRGB:
+			return { 6, 6, 16, true };
+		case ImageFormat::ASTC8x8:
+		case ImageFormat::ASTC8x8sRGB:
+			return { 8, 8, 16, true };
+
+		default:
+			break;
+		}
+
+		return { 1, 1, 4, false };
+	}
+
+	size_t ImageFormatInfo::GetSize(uint32_t width, uint32_t height) const
+	{
+		size_t blocksX = (std::max(width, 1u) + BlockWidth - 1) / BlockWidth;
+		size_t blocksY = (std::max(height, 1u) + BlockHeight - 1) / BlockHeight;
+
+		return blocksX * blocksY * BlockSize;
+	}
+
 	///////////////////////////////////////////////////////////
 	// Core class
 	///////////////////////////////////////////////////////////
@@ -42,4 +101,28 @@ namespace Hz
         return nullptr;
     }
 
+    Ref<Image> Image::CreateAsync(const ImageSpecification& specs, const SamplerSpecification& samplerSpecs)
+    {
+        if constexpr (RendererSpecification::API == RenderingAPI::Vulkan)
+            return VulkanImage::CreateAsync(specs, samplerSpecs);
+
+        return nullptr;
+    }
+
+    bool Image::FormatSupported(ImageFormat format)
+    {
+        if constexpr (RendererSpecification::API == RenderingAPI::Vulkan)
+            return VulkanImage::FormatSupported(format);
+
+        return false;
+    }
+
+    Ref<Sampler> Sampler::Create(const SamplerSpecification& specs)
+    {
+        if constexpr (RendererSpecification::API == RenderingAPI::Vulkan)
+            return Ref<VulkanSampler>::Create(specs);
+
+        return nullptr;
+    }
+
 }
@@ -92,9 +92,89 @@ namespace Hz
 		RGBA = 37,
 		BGRA = 44,
 		sRGB = 43,
+		RGBA16SFloat = 97,
+		R32SFloat = 100,
 		Depth32SFloat = 126,
 		Depth32SFloatS8 = 130,
-		Depth24UnormS8 = 129
+		Depth24UnormS8 = 129,
+
+		// Block compressed, Note: Check Image::FormatSupported before using these
+		BC1 = 131,
+		BC1sRGB = 132,
+		BC1A = 133,
+		BC1AsRGB = 134,
+		BC2 = 135,
+		BC2sRGB = 136,
+		BC3 = 137,
+		BC3sRGB = 138,
+		BC4 = 139,
+		BC4SNorm = 140,
+		BC5 = 141,
+		BC5SNorm = 142,
+		BC6H = 143,
+		BC6HSFloat = 144,
+		BC7 = 145,
+		BC7sRGB = 146,
+
+		ETC2 = 147,
+		ETC2sRGB = 148,
+		ETC2A1 = 149,
+		ETC2A1sRGB = 150,
+		ETC2A = 151,
+		ETC2AsRGB = 152,
+
+		ASTC4x4 = 157,
+		ASTC4x4sRGB = 158,
+		ASTC6x6 = 165,
+		ASTC6x6sRGB = 166,
+		ASTC8x8 = 171,
+		ASTC8x8sRGB = 172
+	};
+
+	enum class ImageViewType : uint32_t
+	{
+		Type1D = 0,
+		Type2D,
+		Type3D,			// Uses ImageSpecification::Depth
+		Cube,			// Requires 6 layers (+X, -X, +Y, -Y, +Z, -Z)
+		Type1DArray,
+		Type2DArray,
+		CubeArray		// Requires a multiple of 6 layers
+	};
+
+	// Filter used when mip levels are generated on the GPU
+	enum class MipFilter : uint8_t
+	{
+		Box = 0,	// 2x2 average
+		Kaiser,		// 6x6 Kaiser windowed sinc, sharper than a box filter
+		Min,		// Smallest of 2x2, for depth pyramids (R32SFloat)
+		Max			// Largest of 2x2, for depth pyramids (R32SFloat)
+	};
+
+	enum class SampleCount : uint8_t
+	{
+		Count1 = 1,
+		Count2 = 2,
+		Count4 = 4,
+		Count8 = 8,
+		Count16 = 16,
+		Count32 = 32,
+		Count64 = 64
+	};
+
+	struct ImageFormatInfo
+	{
+	public:
+		uint32_t BlockWidth = 1;
+		uint32_t BlockHeight = 1;
+		uint32_t BlockSize = 4; // In bytes
+
+		bool Compressed = false;
+
+	public:
+		static ImageFormatInfo Get(ImageFormat format);
+
+		size_t GetSize(uint32_t width, uint32_t height) const; // Size in bytes of a single mip level
 	};
 
 	struct ImageSpecification
@@ -109,8 +189,17 @@ namespace Hz
 
 		uint32_t Width = 0;
 		uint32_t Height = 0;
+		uint32_t Depth = 1;		// Only for ImageViewType::Type3D
+		uint32_t Layers = 1;	// For arrays & cubemaps
+
+		ImageViewType ViewType = ImageViewType::Type2D;
 
         bool MipMaps = true;
+        MipFilter MipmapFilter = MipFilter::Box;
+
+		// Note: Multisampled images never have mips, if they're only used as attachments they become
+		// Transient (lazily allocated), use a resolve attachment to get the result into a regular image.
+		SampleCount Samples = SampleCount::Count1;
 
 	public:
 		ImageSpecification() = default;
@@ -143,6 +232,18 @@ namespace Hz
         Linear
     };
 
+    enum class CompareOp
+    {
+        Never = 0,
+        Less,
+        Equal,
+        LessOrEqual,
+        Greater,
+        NotEqual,
+        GreaterOrEqual,
+        Always
+    };
+
     struct SamplerSpecification
     {
     public:
@@ -151,9 +252,23 @@ namespace Hz
         AddressMode Address = AddressMode::Repeat; // For U, V & W
         MipmapMode Mipmaps = MipmapMode::Linear;
 
+        float MaxAnisotropy = 1.0f; // 1.0f disables anisotropic filtering, Note: Gets clamped to the device limit
+
+        float LodBias = 0.0f;
+        float MinLod = 0.0f;
+        float MaxLod = LodClampNone;
+
+        bool CompareEnable = false; // For shadow map sampling (sampler2DShadow)
+        CompareOp Compare = CompareOp::Never;
+
     public:
         SamplerSpecification() = default;
         ~SamplerSpecification() = default;
+
+        bool operator == (const SamplerSpecification& other) const = default;
+
+    public:
+        inline static constexpr const float LodClampNone = 1000.0f;
     };
 
 	///////////////////////////////////////////////////////////
@@ -165,15 +280,37 @@ namespace Hz
         Image() = default;
         virtual ~Image() = default;
 
-        virtual void SetData(void* data, size_t size) = 0;
+        virtual void SetData(void* data, size_t size) = 0; // Note: Expects all layers (or the full volume) tightly packed
+        virtual void SetLayerData(uint32_t layer, void* data, size_t size) = 0; // Uploads the first level of a single layer
 
         virtual void Resize(uint32_t width, uint32_t height) = 0;
 
         virtual void Transition(ImageLayout initial, ImageLayout final) = 0;
 
-        virtual const ImageSpecification& GetSpecification() const = 0;
+        // Note: Returns a copy, the size & format of asynchronously loaded or streamed images change on the render thread
+        virtual ImageSpecification GetSpecification() const = 0;
+
+        virtual bool IsLoading() const = 0;
 
         static Ref<Image> Create(const ImageSpecification& specs, const SamplerSpecification& samplerSpecs = {});
+
+        // Returns immediately with a placeholder, the file gets decoded on the job system and uploaded at the start of a later frame.
+        // Note: Only for images with ImageUsage::File
+        static Ref<Image> CreateAsync(const ImageSpecification& specs, const SamplerSpecification& samplerSpecs = {});
+
+        static bool FormatSupported(ImageFormat format); // Note: Only valid after the renderer has been initialized
+    };
+
+    // Note: Samplers with equal specifications share the same underlying object
+    class Sampler : public RefCounted
+    {
+    public:
+        Sampler() = default;
+        virtual ~Sampler() = default;
+
+        virtual const SamplerSpecification& GetSpecification() const = 0;
+
+        static Ref<Sampler> Create(const SamplerSpecification& specs = {});
     };
 
 }
@@ -0,0 +1,55 @@
+#include "hzpch.h"
+#include "ImageDecoder.hpp"
+
+#include "Horizon/Core/Logging.hpp"
+
+#include "Horizon/Utils/Profiler.hpp"
+
+#include <cstring>
+
+#include <stb_image.h>
+
+namespace Hz
+{
+
+    ///////////////////////////////////////////////////////////
+    // Decoding
+    ///////////////////////////////////////////////////////////
+    bool ImageDecoder::Info(const std::filesystem::path& path, uint32_t& width, uint32_t& height)
+    {
+        int w, h, channels;
+        if (!stbi_info(path.string().c_str(), &w, &h, &channels))
+            return false;
+
+        width = (uint32_t)w;
+        height = (uint32_t)h;
+        return true;
+    }
+
+    bool ImageDecoder::DecodeInto(const std::filesystem::path& path, void* dst, size_t size)
+    {
+        HZ_PROFILE_SCOPE("ImageDecoder::DecodeInto");
+
+        int width, height, texChannels;
+        stbi_uc* pixels = stbi_load(path.string().c_str(), &width, &height, &texChannels, STBI_rgb_alpha);
+
+        if (!pixels)
+        {
+            HZ_LOG_ERROR("Failed to decode image '{0}': {1}", path.string(), stbi_failure_reason());
+            return false;
+        }
+
+        if ((size_t)width * height * 4 != size)
+        {
+            HZ_LOG_ERROR("Decoded image '{0}' doesn't match the reserved size.", path.string());
+            stbi_image_free((void*)pixels);
+            return false;
+        }
+
+        std::memcpy(dst, pixels, size);
+        stbi_image_free((void*)pixels);
+
+        return true;
+    }
+
+}
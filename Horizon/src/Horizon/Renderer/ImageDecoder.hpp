@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Horizon/Core/Core.hpp"
+
+#include <cstdint>
+#include <filesystem>
+
+namespace Hz
+{
+
+    // Decodes image files (png, jpg, ...) as RGBA8 and copies the pixels into caller provided memory.
+    class ImageDecoder
+    {
+    public:
+        static bool Info(const std::filesystem::path& path, uint32_t& width, uint32_t& height);
+
+        // Note: dst must hold width * height * 4 bytes. This isn't a zero copy decode, stb_image has no way to decode into
+        // caller memory, so the pixels are decoded into stb's heap allocation and then copied into dst once.
+        static bool DecodeInto(const std::filesystem::path& path, void* dst, size_t size);
+    };
+
+}
@@ -0,0 +1,318 @@
+#include "hzpch.h"
+#include "ImageEncoder.hpp"
+
+#include "Horizon/Core/Logging.hpp"
+
+#include "Horizon/Utils/Profiler.hpp"
+
+#include <array>
+#include <cstring>
+
+namespace Hz
+{
+
+    static uint16_t ToRGB565(const std::array<int, 3>& colour)
+    {
+        return (uint16_t)((((colour[0] * 31 + 127) / 255) << 11) | (((colour[1] * 63 + 127) / 255) << 5) | ((colour[2] * 31 + 127) / 255));
+    }
+
+    static std::array<int, 3> FromRGB565(uint16_t colour)
+    {
+        int r = (colour >> 11) & 31, g = (colour >> 5) & 63, b = colour & 31;
+        return { (r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2) };
+    }
+
+    ///////////////////////////////////////////////////////////
+    // Encoding
+    ///////////////////////////////////////////////////////////
+    std::optional<ImageFileData> ImageEncoder::Encode(const uint8_t* pixels, uint32_t width, uint32_t height, ImageFormat format, bool mipmaps)
+    {
+        HZ_PROFILE_SCOPE("ImageEncoder::Encode");
+
+        if (!SupportsFormat(format))
+        {
+            HZ_LOG_ERROR("ImageEncoder can't encode format {0}.", (uint32_t)format);
+            return std::nullopt;
+        }
+
+        ImageFormatInfo info = ImageFormatInfo::Get(format);
+        uint32_t levels = (mipmaps ? static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1 : 1);
+
+        ImageFileData data = {};
+        data.Format = format;
+        data.Width = width;
+        data.Height = height;
+
+        std::vector<uint8_t> level(pixels, pixels + ((size_t)width * height * 4));
+        uint32_t levelWidth = width, levelHeight = height;
+        for (uint32_t i = 0; i < levels; i++)
+        {
+            if (i > 0)
+                level = Downsample(level.data(), levelWidth, levelHeight, 1);
+
+            ImageFileLevel fileLevel = {};
+            fileLevel.Offset = data.Data.size();
+            fileLevel.Size = info.GetSize(levelWidth, levelHeight);
+            fileLevel.Width = levelWidth;
+            fileLevel.Height = levelHeight;
+
+            data.Data.resize(fileLevel.Offset + fileLevel.Size);
+            EncodeLevel(level.data(), levelWidth, levelHeight, format, data.Data.data() + fileLevel.Offset);
+
+            data.Levels.push_back(fileLevel);
+        }
+
+        return data;
+    }
+
+    bool ImageEncoder::SupportsFormat(ImageFormat format)
+    {
+        switch (format)
+        {
+        case ImageFormat::RGBA:
+        case ImageFormat::sRGB:
+        case ImageFormat::BC1:
+        case ImageFormat::BC1sRGB:
+        case ImageFormat::BC1A:
+        case ImageFormat::BC1AsRGB:
+        case ImageFormat::BC3:
+        case ImageFormat::BC3sRGB:
+        case ImageFormat::BC4:
+        case ImageFormat::BC5:
+            return true;
+
+        default:
+            break;
+        }
+
+        return false;
+    }
+
+    std::vector<uint8_t> ImageEncoder::Downsample(const uint8_t* pixels, uint32_t& width, uint32_t& height, uint32_t levels)
+    {
+        std::vector<uint8_t> current(pixels, pixels + ((size_t)width * height * 4));
+
+        for (uint32_t level = 0; level < levels; level++)
+        {
+            uint32_t nextWidth = std::max(width / 2, 1u);
+            uint32_t nextHeight = std::max(height / 2, 1u);
+            std::vector<uint8_t> next((size_t)nextWidth * nextHeight * 4);
+
+            for (uint32_t y = 0; y < nextHeight; y++)
+            {
+                uint32_t y0 = std::min(y * 2, height - 1);
+                uint32_t y1 = std::min(y * 2 + 1, height - 1);
+
+                for (uint32_t x = 0; x < nextWidth; x++)
+                {
+                    uint32_t x0 = std::min(x * 2, width - 1);
+                    uint32_t x1 = std::min(x * 2 + 1, width - 1);
+
+                    for (uint32_t c = 0; c < 4; c++)
+                    {
+                        uint32_t sum = current[((size_t)y0 * width + x0) * 4 + c] + current[((size_t)y0 * width + x1) * 4 + c]
+                                     + current[((size_t)y1 * width + x0) * 4 + c] + current[((size_t)y1 * width + x1) * 4 + c];
+
+                        next[((size_t)y * nextWidth + x) * 4 + c] = (uint8_t)((sum + 2) / 4);
+                    }
+                }
+            }
+
+            current.swap(next);
+            width = nextWidth;
+            height = nextHeight;
+        }
+
+        return current;
+    }
+
+    void ImageEncoder::EncodeLevel(const uint8_t* pixels, uint32_t width, uint32_t height, ImageFormat format, uint8_t* dst)
+    {
+        ImageFormatInfo info = ImageFormatInfo::Get(format);
+        if (!info.Compressed)
+        {
+            std::memcpy(dst, pixels, (size_t)width * height * 4);
+            return;
+        }
+
+        uint32_t blocksX = (width + 3) / 4;
+        uint32_t blocksY = (height + 3) / 4;
+
+        // Note: Edge blocks repeat the last row/column
+        std::array<uint8_t, 16 * 4> block = { };
+        for (uint32_t by = 0; by < blocksY; by++)
+        {
+            for (uint32_t bx = 0; bx < blocksX; bx++)
+            {
+                for (uint32_t y = 0; y < 4; y++)
+                {
+                    for (uint32_t x = 0; x < 4; x++)
+                    {
+                        uint32_t px = std::min(bx * 4 + x, width - 1);
+                        uint32_t py = std::min(by * 4 + y, height - 1);
+                        std::memcpy(&block[(y * 4 + x) * 4], &pixels[((size_t)py * width + px) * 4], 4);
+                    }
+                }
+
+                switch (format)
+                {
+                case ImageFormat::BC1:
+                case ImageFormat::BC1sRGB:
+                    EncodeBC1Block(block.data(), dst, false);
+                    break;
+                case ImageFormat::BC1A:
+                case ImageFormat::BC1AsRGB:
+                    EncodeBC1Block(block.data(), dst, true);
+                    break;
+                case ImageFormat::BC3:
+                case ImageFormat::BC3sRGB:
+                    EncodeBC4Block(block.data(), 3, dst);
+                    EncodeBC1Block(block.data(), dst + 8, false);
+                    break;
+                case ImageFormat::BC4:
+                    EncodeBC4Block(block.data(), 0, dst);
+                    break;
+                case ImageFormat::BC5:
+                    EncodeBC4Block(block.data(), 0, dst);
+                    EncodeBC4Block(block.data(), 1, dst + 8);
+                    break;
+
+                default:
+                    break;
+                }
+
+                dst += info.BlockSize;
+            }
+        }
+    }
+
+    void ImageEncoder::EncodeBC1Block(const uint8_t* block, uint8_t* dst, bool alpha)
+    {
+        // Bounding box of the (opaque) colours, inset to reduce the error at the ends
+        std::array<int, 3> min = { 255, 255, 255 };
+        std::array<int, 3> max = { 0, 0, 0 };
+        bool transparent = false;
+
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            if (alpha && block[i * 4 + 3] < 128)
+            {
+                transparent = true;
+                continue;
+            }
+
+            for (uint32_t c = 0; c < 3; c++)
+            {
+                min[c] = std::min(min[c], (int)block[i * 4 + c]);
+                max[c] = std::max(max[c], (int)block[i * 4 + c]);
+            }
+        }
+
+        if (min[0] > max[0]) // Fully transparent
+            min = max = { 0, 0, 0 };
+
+        for (uint32_t c = 0; c < 3; c++)
+        {
+            int inset = (max[c] - min[c]) / 16;
+            min[c] += inset;
+            max[c] -= inset;
+        }
+
+        uint16_t colour0 = ToRGB565(max);
+        uint16_t colour1 = ToRGB565(min);
+
+        // Note: colour0 > colour1 selects 4 colour mode, otherwise 3 colours + transparent black
+        if (transparent ? (colour0 > colour1) : (colour0 < colour1))
+            std::swap(colour0, colour1);
+
+        std::array<std::array<int, 3>, 4> palette = { FromRGB565(colour0), FromRGB565(colour1) };
+        for (uint32_t c = 0; c < 3; c++)
+        {
+            if (transparent)
+            {
+                palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                palette[3][c] = 0;
+            }
+            else
+            {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+            }
+        }
+
+        uint32_t indices = 0;
+        if (colour0 != colour1 || transparent)
+        {
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                uint32_t best = 0;
+                if (transparent && block[i * 4 + 3] < 128)
+                {
+                    best = 3;
+                }
+                else
+                {
+                    int bestError = std::numeric_limits<int>::max();
+                    for (uint32_t p = 0; p < (transparent ? 3u : 4u); p++)
+                    {
+                        int dr = palette[p][0] - block[i * 4 + 0], dg = palette[p][1] - block[i * 4 + 1], db = palette[p][2] - block[i * 4 + 2];
+                        int error = dr * dr + dg * dg + db * db;
+                        if (error < bestError)
+                        {
+                            bestError = error;
+                            best = p;
+                        }
+                    }
+                }
+
+                indices |= best << (i * 2);
+            }
+        }
+
+        std::memcpy(dst + 0, &colour0, sizeof(uint16_t));
+        std::memcpy(dst + 2, &colour1, sizeof(uint16_t));
+        std::memcpy(dst + 4, &indices, sizeof(uint32_t));
+    }
+
+    void ImageEncoder::EncodeBC4Block(const uint8_t* block, uint32_t channel, uint8_t* dst)
+    {
+        int min = 255, max = 0;
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            min = std::min(min, (int)block[i * 4 + channel]);
+            max = std::max(max, (int)block[i * 4 + channel]);
+        }
+
+        // Note: max > min selects the 8 value mode
+        std::array<int, 8> palette = { max, min };
+        for (int i = 1; i < 7; i++)
+            palette[i + 1] = ((7 - i) * max + i * min) / 7;
+
+        uint64_t indices = 0;
+        if (max != min)
+        {
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                uint64_t best = 0;
+                int bestError = std::numeric_limits<int>::max();
+                for (uint32_t p = 0; p < 8; p++)
+                {
+                    int error = std::abs(palette[p] - (int)block[i * 4 + channel]);
+                    if (error < bestError)
+                    {
+                        bestError = error;
+                        best = p;
+                    }
+                }
+
+                indices |= best << (i * 3);
+            }
+        }
+
+        dst[0] = (uint8_t)max;
+        dst[1] = (uint8_t)min;
+        for (uint32_t i = 0; i < 6; i++)
+            dst[2 + i] = (uint8_t)(indices >> (i * 8));
+    }
+
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Horizon/Core/Core.hpp"
+
+#include "Horizon/Renderer/Image.hpp"
+#include "Horizon/Renderer/ImageFile.hpp"
+
+#include <cstdint>
+#include <vector>
+#include <optional>
+
+namespace Hz
+{
+
+    // CPU block compression for offline conversion, Note: Not meant to be used at runtime.
+    class ImageEncoder
+    {
+    public:
+        // Encodes RGBA8 pixels, mip levels are generated with a box filter
+        static std::optional<ImageFileData> Encode(const uint8_t* pixels, uint32_t width, uint32_t height, ImageFormat format, bool mipmaps = true);
+
+        static bool SupportsFormat(ImageFormat format); // RGBA, sRGB, BC1(A), BC3, BC4 & BC5
+
+        // Halves RGBA8 pixels `levels` times using a box filter, width and height are updated
+        static std::vector<uint8_t> Downsample(const uint8_t* pixels, uint32_t& width, uint32_t& height, uint32_t levels);
+
+    private:
+        static void EncodeLevel(const uint8_t* pixels, uint32_t width, uint32_t height, ImageFormat format, uint8_t* dst);
+
+        static void EncodeBC1Block(const uint8_t* block, uint8_t* dst, bool alpha);
+        static void EncodeBC4Block(const uint8_t* block, uint32_t channel, uint8_t* dst);
+    };
+
+}
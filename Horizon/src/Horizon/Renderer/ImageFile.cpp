@@ -0,0 +1,496 @@
+#include "hzpch.h"
+#include "ImageFile.hpp"
+
+#include "Horizon/Core/Logging.hpp"
+
+#include "Horizon/Utils/Profiler.hpp"
+
+#include <array>
+#include <cctype>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace Hz
+{
+
+    static std::optional<std::vector<uint8_t>> ReadFile(const std::filesystem::path& path)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file.is_open())
+        {
+            HZ_LOG_ERROR("Failed to open image file '{0}'", path.string());
+            return std::nullopt;
+        }
+
+        std::vector<uint8_t> bytes((size_t)file.tellg());
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(bytes.data()), bytes.size());
+
+        return bytes;
+    }
+
+    template<typename T>
+    static T Read(const std::vector<uint8_t>& bytes, size_t offset)
+    {
+        T value = {};
+        std::memcpy(&value, bytes.data() + offset, sizeof(T));
+        return value;
+    }
+
+    template<typename T>
+    static void Write(std::vector<uint8_t>& bytes, T value)
+    {
+        size_t offset = bytes.size();
+        bytes.resize(offset + sizeof(T));
+        std::memcpy(bytes.data() + offset, &value, sizeof(T));
+    }
+
+    // Note: The amount of levels in a full mip chain, floor(log2(max(width, height))) + 1
+    static uint32_t GetMaxMipLevels(uint32_t width, uint32_t height)
+    {
+        uint32_t levels = 1;
+        for (uint32_t size = std::max(width, height); size > 1; size >>= 1)
+            levels++;
+
+        return levels;
+    }
+
+    // Note: Returns Undefined for formats which aren't part of ImageFormat
+    static ImageFormat GetImageFormat(uint32_t vkFormat)
+    {
+        switch (vkFormat)
+        {
+        case (uint32_t)ImageFormat::RGBA:
+        case (uint32_t)ImageFormat::BGRA:
+        case (uint32_t)ImageFormat::sRGB:
+        case (uint32_t)ImageFormat::BC1:
+        case (uint32_t)ImageFormat::BC1sRGB:
+        case (uint32_t)ImageFormat::BC1A:
+        case (uint32_t)ImageFormat::BC1AsRGB:
+        case (uint32_t)ImageFormat::BC2:
+        case (uint32_t)ImageFormat::BC2sRGB:
+        case (uint32_t)ImageFormat::BC3:
+        case (uint32_t)ImageFormat::BC3sRGB:
+        case (uint32_t)ImageFormat::BC4:
+        case (uint32_t)ImageFormat::BC4SNorm:
+        case (uint32_t)ImageFormat::BC5:
+        case (uint32_t)ImageFormat::BC5SNorm:
+        case (uint32_t)ImageFormat::BC6H:
+        case (uint32_t)ImageFormat::BC6HSFloat:
+        case (uint32_t)ImageFormat::BC7:
+        case (uint32_t)ImageFormat::BC7sRGB:
+        case (uint32_t)ImageFormat::ETC2:
+        case (uint32_t)ImageFormat::ETC2sRGB:
+        case (uint32_t)ImageFormat::ETC2A1:
+        case (uint32_t)ImageFormat::ETC2A1sRGB:
+        case (uint32_t)ImageFormat::ETC2A:
+        case (uint32_t)ImageFormat::ETC2AsRGB:
+        case (uint32_t)ImageFormat::ASTC4x4:
+        case (uint32_t)ImageFormat::ASTC4x4sRGB:
+        case (uint32_t)ImageFormat::ASTC6x6:
+        case (uint32_t)ImageFormat::ASTC6x6sRGB:
+        case (uint32_t)ImageFormat::ASTC8x8:
+        case (uint32_t)ImageFormat::ASTC8x8sRGB:
+            return (ImageFormat)vkFormat;
+
+        default:
+            break;
+        }
+
+        return ImageFormat::Undefined;
+    }
+
+    static ImageFormat GetImageFormatFromDXGI(uint32_t dxgiFormat)
+    {
+        switch (dxgiFormat)
+        {
+        case 28: return ImageFormat::RGBA;
+        case 29: return ImageFormat::sRGB;
+        case 87: return ImageFormat::BGRA;
+        case 71: return ImageFormat::BC1A;
+        case 72: return ImageFormat::BC1AsRGB;
+        case 74: return ImageFormat::BC2;
+        case 75: return ImageFormat::BC2sRGB;
+        case 77: return ImageFormat::BC3;
+        case 78: return ImageFormat::BC3sRGB;
+        case 80: return ImageFormat::BC4;
+        case 81: return ImageFormat::BC4SNorm;
+        case 83: return ImageFormat::BC5;
+        case 84: return ImageFormat::BC5SNorm;
+        case 95: return ImageFormat::BC6H;
+        case 96: return ImageFormat::BC6HSFloat;
+        case 98: return ImageFormat::BC7;
+        case 99: return ImageFormat::BC7sRGB;
+
+        default:
+            break;
+        }
+
+        return ImageFormat::Undefined;
+    }
+
+    static constexpr uint32_t FourCC(const char code[5])
+    {
+        return (uint32_t)code[0] | ((uint32_t)code[1] << 8) | ((uint32_t)code[2] << 16) | ((uint32_t)code[3] << 24);
+    }
+
+    static constexpr const std::array<uint8_t, 12> s_KTX2Identifier = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+    ///////////////////////////////////////////////////////////
+    // Loading
+    ///////////////////////////////////////////////////////////
+    bool ImageFile::IsContainer(const std::filesystem::path& path)
+    {
+        std::string extension = path.extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)std::tolower(c); });
+
+        return extension == ".ktx2" || extension == ".dds";
+    }
+
+    std::optional<ImageFileData> ImageFile::Load(const std::filesystem::path& path)
+    {
+        std::string extension = path.extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)std::tolower(c); });
+
+        if (extension == ".ktx2")
+            return LoadKTX2(path);
+        else if (extension == ".dds")
+            return LoadDDS(path);
+
+        HZ_LOG_ERROR("Unsupported image container '{0}'", path.string());
+        return std::nullopt;
+    }
+
+    std::optional<ImageFileData> ImageFile::LoadKTX2(const std::filesystem::path& path)
+    {
+        HZ_PROFILE_SCOPE("ImageFile::LoadKTX2");
+
+        auto file = ReadFile(path);
+        if (!file)
+            return std::nullopt;
+
+        const std::vector<uint8_t>& bytes = file.value();
+        if (bytes.size() < 80 || std::memcmp(bytes.data(), s_KTX2Identifier.data(), s_KTX2Identifier.size()) != 0)
+        {
+            HZ_LOG_ERROR("'{0}' is not a valid KTX2 file.", path.string());
+            return std::nullopt;
+        }
+
+        uint32_t vkFormat = Read<uint32_t>(bytes, 12);
+        uint32_t width = Read<uint32_t>(bytes, 20);
+        uint32_t height = Read<uint32_t>(bytes, 24);
+        uint32_t depth = Read<uint32_t>(bytes, 28);
+        uint32_t layers = Read<uint32_t>(bytes, 32);
+        uint32_t faces = Read<uint32_t>(bytes, 36);
+        uint32_t levels = std::max(Read<uint32_t>(bytes, 40), 1u);
+        uint32_t supercompression = Read<uint32_t>(bytes, 44);
+
+        ImageFileData data = {};
+        data.Format = GetImageFormat(vkFormat);
+        data.Width = width;
+        data.Height = std::max(height, 1u);
+
+        if (data.Format == ImageFormat::Undefined)
+        {
+            HZ_LOG_ERROR("KTX2 file '{0}' uses unsupported VkFormat {1}.", path.string(), vkFormat);
+            return std::nullopt;
+        }
+        if (supercompression != 0)
+        {
+            HZ_LOG_ERROR("KTX2 file '{0}' uses supercompression, which isn't supported.", path.string());
+            return std::nullopt;
+        }
+        if (depth > 1 || layers > 1 || faces != 1)
+        {
+            HZ_LOG_ERROR("KTX2 file '{0}' isn't a single 2D image.", path.string());
+            return std::nullopt;
+        }
+        if (data.Width == 0 || levels > GetMaxMipLevels(data.Width, data.Height))
+        {
+            HZ_LOG_ERROR("KTX2 file '{0}' has an invalid size or level count.", path.string());
+            return std::nullopt;
+        }
+        if (bytes.size() < 80 + (size_t)levels * 24)
+        {
+            HZ_LOG_ERROR("KTX2 file '{0}' is truncated.", path.string());
+            return std::nullopt;
+        }
+
+        ImageFormatInfo info = ImageFormatInfo::Get(data.Format);
+        for (uint32_t i = 0; i < levels; i++)
+        {
+            uint64_t offset = Read<uint64_t>(bytes, 80 + (size_t)i * 24);
+            uint64_t length = Read<uint64_t>(bytes, 80 + (size_t)i * 24 + 8);
+
+            ImageFileLevel level = {};
+            level.Offset = data.Data.size();
+            level.Size = (size_t)length;
+            level.Width = std::max(data.Width >> i, 1u);
+            level.Height = std::max(data.Height >> i, 1u);
+
+            // Note: Written so that a corrupt offset or length can't overflow
+            if (offset > bytes.size() || length > bytes.size() - offset || length < info.GetSize(level.Width, level.Height))
+            {
+                HZ_LOG_ERROR("KTX2 file '{0}' has an invalid level {1}.", path.string(), i);
+                return std::nullopt;
+            }
+
+            data.Data.insert(data.Data.end(), bytes.begin() + offset, bytes.begin() + offset + length);
+            data.Levels.push_back(level);
+        }
+
+        return data;
+    }
+
+    std::optional<ImageFileData> ImageFile::LoadDDS(const std::filesystem::path& path)
+    {
+        HZ_PROFILE_SCOPE("ImageFile::LoadDDS");
+
+        auto file = ReadFile(path);
+        if (!file)
+            return std::nullopt;
+
+        const std::vector<uint8_t>& bytes = file.value();
+        if (bytes.size() < 128 || Read<uint32_t>(bytes, 0) != FourCC("DDS "))
+        {
+            HZ_LOG_ERROR("'{0}' is not a valid DDS file.", path.string());
+            return std::nullopt;
+        }
+
+        // Note: Offsets include the 4 byte magic
+        uint32_t flags = Read<uint32_t>(bytes, 8);
+        uint32_t height = Read<uint32_t>(bytes, 12);
+        uint32_t width = Read<uint32_t>(bytes, 16);
+        uint32_t levels = (flags & 0x20000) ? std::max(Read<uint32_t>(bytes, 28), 1u) : 1u;
+
+        uint32_t pixelFlags = Read<uint32_t>(bytes, 80);
+        uint32_t fourCC = Read<uint32_t>(bytes, 84);
+        uint32_t bitCount = Read<uint32_t>(bytes, 88);
+        uint32_t redMask = Read<uint32_t>(bytes, 92);
+        uint32_t caps2 = Read<uint32_t>(bytes, 112);
+
+        ImageFileData data = {};
+        data.Width = width;
+        data.Height = height;
+
+        size_t offset = 128;
+        if ((pixelFlags & 0x4) && fourCC == FourCC("DX10"))
+        {
+            if (bytes.size() < 148)
+            {
+                HZ_LOG_ERROR("DDS file '{0}' is truncated.", path.string());
+                return std::nullopt;
+            }
+
+            data.Format = GetImageFormatFromDXGI(Read<uint32_t>(bytes, 128));
+            if (Read<uint32_t>(bytes, 140) > 1)
+            {
+                HZ_LOG_ERROR("DDS file '{0}' is an array, which isn't supported.", path.string());
+                return std::nullopt;
+            }
+
+            offset = 148;
+        }
+        else if (pixelFlags & 0x4)
+        {
+            switch (fourCC)
+            {
+            case FourCC("DXT1"): data.Format = ImageFormat::BC1A; break;
+            case FourCC("DXT3"): data.Format = ImageFormat::BC2; break;
+            case FourCC("DXT5"): data.Format = ImageFormat::BC3; break;
+            case FourCC("ATI1"):
+            case FourCC("BC4U"): data.Format = ImageFormat::BC4; break;
+            case FourCC("ATI2"):
+            case FourCC("BC5U"): data.Format = ImageFormat::BC5; break;
+
+            default:
+                break;
+            }
+        }
+        else if ((pixelFlags & 0x40) && bitCount == 32)
+        {
+            data.Format = (redMask == 0x000000FF ? ImageFormat::RGBA : ImageFormat::BGRA);
+        }
+
+        if (data.Format == ImageFormat::Undefined)
+        {
+            HZ_LOG_ERROR("DDS file '{0}' uses an unsupported pixel format.", path.string());
+            return std::nullopt;
+        }
+        if (caps2 & 0x200)
+        {
+            HZ_LOG_ERROR("DDS file '{0}' is a cubemap, which isn't supported.", path.string());
+            return std::nullopt;
+        }
+        if (data.Width == 0 || data.Height == 0 || levels > GetMaxMipLevels(data.Width, data.Height))
+        {
+            HZ_LOG_ERROR("DDS file '{0}' has an invalid size or level count.", path.string());
+            return std::nullopt;
+        }
+
+        // Note: DDS levels are tightly packed from most to least detailed
+        ImageFormatInfo info = ImageFormatInfo::Get(data.Format);
+        for (uint32_t i = 0; i < levels; i++)
+        {
+            ImageFileLevel level = {};
+            level.Width = std::max(data.Width >> i, 1u);
+            level.Height = std::max(data.Height >> i, 1u);
+            level.Size = info.GetSize(level.Width, level.Height);
+
+            if (offset > bytes.size() || level.Size > bytes.size() - offset)
+            {
+                HZ_LOG_ERROR("DDS file '{0}' is truncated.", path.string());
+                return std::nullopt;
+            }
+
+            level.Offset = data.Data.size();
+            data.Data.insert(data.Data.end(), bytes.begin() + offset, bytes.begin() + offset + level.Size);
+            data.Levels.push_back(level);
+
+            offset += level.Size;
+        }
+
+        return data;
+    }
+
+    ///////////////////////////////////////////////////////////
+    // Writing
+    ///////////////////////////////////////////////////////////
+    bool ImageFile::WriteKTX2(const std::filesystem::path& path, const ImageFileData& data)
+    {
+        HZ_PROFILE_SCOPE("ImageFile::WriteKTX2");
+
+        // Basic data format descriptor, Note: Only describes the formats the ImageEncoder produces
+        struct Sample { uint8_t Channel; uint32_t BitOffset; uint32_t BitLength; uint32_t Upper; };
+
+        bool sRGB = false;
+        uint8_t model = 0;
+        std::vector<Sample> samples = { };
+        switch (data.Format)
+        {
+        case ImageFormat::sRGB:
+            sRGB = true;
+            [[fallthrough]];
+        case ImageFormat::RGBA:
+            model = 1; // RGBSDA
+            samples = { { 0, 0, 8, 255 }, { 1, 8, 8, 255 }, { 2, 16, 8, 255 }, { (uint8_t)(15 | (sRGB ? 0x10 : 0)), 24, 8, 255 } };
+            break;
+
+        case ImageFormat::BC1sRGB:
+            sRGB = true;
+            [[fallthrough]];
+        case ImageFormat::BC1:
+            model = 128;
+            samples = { { 0, 0, 64, 0xFFFFFFFF } };
+            break;
+        case ImageFormat::BC1AsRGB:
+            sRGB = true;
+            [[fallthrough]];
+        case ImageFormat::BC1A:
+            model = 128;
+            samples = { { 1, 0, 64, 0xFFFFFFFF } };
+            break;
+        case ImageFormat::BC3sRGB:
+            sRGB = true;
+            [[fallthrough]];
+        case ImageFormat::BC3:
+            model = 130;
+            samples = { { (uint8_t)(15 | (sRGB ? 0x10 : 0)), 0, 64, 0xFFFFFFFF }, { 0, 64, 64, 0xFFFFFFFF } };
+            break;
+        case ImageFormat::BC4:
+            model = 131;
+            samples = { { 0, 0, 64, 0xFFFFFFFF } };
+            break;
+        case ImageFormat::BC5:
+            model = 132;
+            samples = { { 0, 0, 64, 0xFFFFFFFF }, { 1, 64, 64, 0xFFFFFFFF } };
+            break;
+
+        default:
+            HZ_LOG_ERROR("Writing KTX2 files with format {0} is not supported.", (uint32_t)data.Format);
+            return false;
+        }
+
+        ImageFormatInfo info = ImageFormatInfo::Get(data.Format);
+        uint32_t levels = (uint32_t)data.Levels.size();
+
+        std::vector<uint8_t> dfd = { };
+        uint32_t blockSize = 24 + 16 * (uint32_t)samples.size();
+        Write<uint32_t>(dfd, 4 + blockSize);
+        Write<uint32_t>(dfd, 0);                            // Vendor (Khronos) & descriptor type (basic)
+        Write<uint32_t>(dfd, 2 | (blockSize << 16));        // Version & block size
+        Write<uint8_t>(dfd, model);
+        Write<uint8_t>(dfd, 1);                             // BT709 primaries
+        Write<uint8_t>(dfd, sRGB ? 2 : 1);                  // Transfer function
+        Write<uint8_t>(dfd, 0);                             // Straight alpha
+        Write<uint32_t>(dfd, (info.BlockWidth - 1) | ((info.BlockHeight - 1) << 8));
+        Write<uint32_t>(dfd, info.BlockSize);               // Bytes plane 0
+        Write<uint32_t>(dfd, 0);
+        for (const auto& sample : samples)
+        {
+            Write<uint32_t>(dfd, sample.BitOffset | ((sample.BitLength - 1) << 16) | ((uint32_t)sample.Channel << 24));
+            Write<uint32_t>(dfd, 0);                        // Sample position
+            Write<uint32_t>(dfd, 0);                        // Lower
+            Write<uint32_t>(dfd, sample.Upper);
+        }
+
+        size_t dfdOffset = 80 + (size_t)levels * 24;
+        size_t alignment = std::max<size_t>(info.BlockSize, 4);
+
+        // Note: KTX2 recommends storing the least detailed level first
+        std::vector<uint64_t> offsets(levels);
+        size_t offset = dfdOffset + dfd.size();
+        for (uint32_t i = levels; i-- > 0;)
+        {
+            offset = (offset + alignment - 1) / alignment * alignment;
+            offsets[i] = offset;
+            offset += data.Levels[i].Size;
+        }
+
+        std::vector<uint8_t> bytes = { };
+        bytes.reserve(offset);
+        bytes.insert(bytes.end(), s_KTX2Identifier.begin(), s_KTX2Identifier.end());
+        Write<uint32_t>(bytes, (uint32_t)data.Format);
+        Write<uint32_t>(bytes, 1);                          // Type size
+        Write<uint32_t>(bytes, data.Width);
+        Write<uint32_t>(bytes, data.Height);
+        Write<uint32_t>(bytes, 0);                          // Depth
+        Write<uint32_t>(bytes, 0);                          // Layers
+        Write<uint32_t>(bytes, 1);                          // Faces
+        Write<uint32_t>(bytes, levels);
+        Write<uint32_t>(bytes, 0);                          // Supercompression
+        Write<uint32_t>(bytes, (uint32_t)dfdOffset);
+        Write<uint32_t>(bytes, (uint32_t)dfd.size());
+        Write<uint32_t>(bytes, 0);                          // Key/value data
+        Write<uint32_t>(bytes, 0);
+        Write<uint64_t>(bytes, 0);                          // Supercompression global data
+        Write<uint64_t>(bytes, 0);
+
+        for (uint32_t i = 0; i < levels; i++)
+        {
+            Write<uint64_t>(bytes, offsets[i]);
+            Write<uint64_t>(bytes, data.Levels[i].Size);
+            Write<uint64_t>(bytes, data.Levels[i].Size);
+        }
+
+        bytes.insert(bytes.end(), dfd.begin(), dfd.end());
+
+        for (uint32_t i = levels; i-- > 0;)
+        {
+            bytes.resize(offsets[i], 0);
+            bytes.insert(bytes.end(), data.Data.begin() + data.Levels[i].Offset, data.Data.begin() + data.Levels[i].Offset + data.Levels[i].Size);
+        }
+
+        std::ofstream file(path, std::ios::binary);
+        if (!file.is_open())
+        {
+            HZ_LOG_ERROR("Failed to open '{0}' for writing.", path.string());
+            return false;
+        }
+
+        file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+        return true;
+    }
+
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Horizon/Core/Core.hpp"
+
+#include "Horizon/Renderer/Image.hpp"
+
+#include <cstdint>
+#include <vector>
+#include <optional>
+#include <filesystem>
+
+namespace Hz
+{
+
+    struct ImageFileLevel
+    {
+    public:
+        size_t Offset = 0; // Into ImageFileData::Data
+        size_t Size = 0;
+
+        uint32_t Width = 0;
+        uint32_t Height = 0;
+    };
+
+    // Note: Pre-processed image data, levels are stored from most to least detailed
+    struct ImageFileData
+    {
+    public:
+        ImageFormat Format = ImageFormat::Undefined;
+
+        uint32_t Width = 0;
+        uint32_t Height = 0;
+
+        std::vector<ImageFileLevel> Levels = { };
+        std::vector<uint8_t> Data = { };
+    };
+
+    // Loads & writes container formats (.ktx2, .dds) which store ready to upload mip chains.
+    class ImageFile
+    {
+    public:
+        static bool IsContainer(const std::filesystem::path& path);
+
+        static std::optional<ImageFileData> Load(const std::filesystem::path& path); // Picks the loader based on the extension
+        static std::optional<ImageFileData> LoadKTX2(const std::filesystem::path& path);
+        static std::optional<ImageFileData> LoadDDS(const std::filesystem::path& path);
+
+        static bool WriteKTX2(const std::filesystem::path& path, const ImageFileData& data);
+    };
+
+}
@@ -34,6 +34,62 @@ namespace Hz
         FillRectangleNV = 1000153000,
     };
 
+    enum class BlendFactor
+    {
+        Zero = 0,
+        One,
+        SrcColour,
+        OneMinusSrcColour,
+        DstColour,
+        OneMinusDstColour,
+        SrcAlpha,
+        OneMinusSrcAlpha,
+        DstAlpha,
+        OneMinusDstAlpha,
+        ConstantColour,
+        OneMinusConstantColour,
+        ConstantAlpha,
+        OneMinusConstantAlpha,
+        SrcAlphaSaturate
+    };
+
+    enum class BlendOperation
+    {
+        Add = 0,
+        Subtract,
+        ReverseSubtract,
+        Min,
+        Max
+    };
+
+    enum class ColourComponents : uint8_t
+    {
+        None = 0,
+        R = 1 << 0,
+        G = 1 << 1,
+        B = 1 << 2,
+        A = 1 << 3,
+        RGB = R | G | B,
+        RGBA = R | G | B | A
+    };
+    ENABLE_BITWISE(ColourComponents)
+
+    struct BlendState
+    {
+    public:
+        bool Enabled = false;
+
+        BlendFactor SrcColour = BlendFactor::SrcAlpha;
+        BlendFactor DstColour = BlendFactor::OneMinusSrcAlpha;
+        BlendOperation ColourOp = BlendOperation::Add;
+
+        BlendFactor SrcAlpha = BlendFactor::One;
+        BlendFactor DstAlpha = BlendFactor::Zero;
+        BlendOperation AlphaOp = BlendOperation::Add;
+
+        ColourComponents WriteMask = ColourComponents::RGBA;
+    };
+
     enum class PipelineType
     {
         Graphics = 0,
@@ -49,12 +105,21 @@ namespace Hz
 
         // Graphics
 		BufferLayout Bufferlayout = {};
+		bool VertexPulling = false; // Skips fixed-function vertex input (ignores the Bufferlayout), vertices are fetched in the shader from a StorageBuffer or a buffer device address.
 
 		PolygonMode Polygonmode = PolygonMode::Fill;
 		CullingMode Cullingmode = CullingMode::Front;
 
 		float LineWidth = 1.0f;
-		bool Blending = false;
+		bool Blending = false;                     // Alpha blending for every colour attachment, used when ColourBlends is empty
+		std::vector<BlendState> ColourBlends = { };  // One per colour attachment, in the same order as the renderpass/dynamic render state
+
+		uint32_t Subpass = 0; // The renderpass' subpass this pipeline is used in
+		SampleCount Samples = SampleCount::Count1; // Needs to match the attachments' sample count
+
+		// Dynamic rendering, Note: Only used when the pipeline is created without a renderpass
+		std::vector<ImageFormat> ColourFormats = { };
+		ImageFormat DepthFormat = ImageFormat::Undefined;
 
         // Raytracing KHR
         uint32_t MaxRayRecursion = 1;
@@ -0,0 +1,212 @@
+#include "hzpch.h"
+#include "RenderQueue.hpp"
+
+#include "Horizon/Core/Logging.hpp"
+#include "Horizon/Core/Jobs.hpp"
+
+#include "Horizon/Renderer/Renderer.hpp"
+
+#include "Horizon/Utils/Profiler.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+namespace Hz
+{
+
+    // Note: Fibonacci hashing, spreads the (aligned) addresses over the available bits
+    static uint64_t HashPointer(const void* ptr, uint32_t bits)
+    {
+        if (!ptr)
+            return 0;
+
+        return ((uint64_t)reinterpret_cast<uintptr_t>(ptr) * 11400714819323198485ull) >> (64 - bits);
+    }
+
+    ///////////////////////////////////////////////////////////
+    // Key
+    ///////////////////////////////////////////////////////////
+    uint64_t RenderKey::Create(const RenderItem& item)
+    {
+        constexpr const uint64_t maxDepth = (1ull << DepthBits) - 1;
+
+        uint64_t pipeline = HashPointer(item.DrawPipeline.Raw(), PipelineBits);
+        uint64_t material = HashPointer(item.Material.Raw(), MaterialBits);
+        uint64_t mesh = HashPointer((item.Vertices ? (const void*)item.Vertices.Raw() : (const void*)item.Indices.Raw()), MeshBits);
+        // Note: NaN passes through std::clamp and converting it to an integer is undefined, so it's treated as the near plane
+        float normalized = (std::isnan(item.Depth) ? 0.0f : std::clamp(item.Depth, 0.0f, 1.0f));
+        uint64_t depth = (uint64_t)((double)normalized * (double)maxDepth);
+
+        uint64_t key = (uint64_t)item.Layer << (64 - LayerBits);
+        if (!item.Translucent)
+        {
+            key |= pipeline << (MaterialBits + DepthBits + MeshBits);
+            key |= material << (DepthBits + MeshBits);
+            key |= depth << MeshBits;
+        }
+        else
+        {
+            key |= 1ull << (64 - LayerBits - 1);
+            key |= (maxDepth - depth) << (PipelineBits + MaterialBits + MeshBits);
+            key |= pipeline << (MaterialBits + MeshBits);
+            key |= material << MeshBits;
+        }
+
+        return key | mesh;
+    }
+
+    ///////////////////////////////////////////////////////////
+    // Core class
+    ///////////////////////////////////////////////////////////
+    RenderQueue::RenderQueue()
+        : m_Streams({ Ref<CommandStream>::Create(), Ref<CommandStream>::Create() })
+    {
+    }
+
+    void RenderQueue::Submit(const RenderItem& item)
+    {
+        HZ_ASSERT((item.DrawPipeline), "RenderItem submitted to the RenderQueue without a pipeline.");
+        // Note: Recording can't unbind a set, so an item without a material would silently use the previous item's material
+        HZ_ASSERT((m_Items.empty() || (bool)item.Material == (bool)m_Items.front().Material), "RenderItems of a RenderQueue either all need a material or none may have one.");
+
+        m_Entries.push_back({ RenderKey::Create(item), (uint32_t)m_Items.size() });
+        m_Items.push_back(item);
+    }
+
+    void RenderQueue::Sort()
+    {
+        HZ_PROFILE_SCOPE("RenderQueue::Sort");
+
+        const size_t count = m_Entries.size();
+        if (count < 2)
+            return;
+
+        // Note: Passes where every key has the same digit don't change the order, so we skip them
+        uint64_t difference = 0;
+        for (const Entry& entry : m_Entries)
+            difference |= (entry.Key ^ m_Entries[0].Key);
+
+        uint32_t blocks = 1;
+        if (count >= ParallelThreshold && Jobs::GetWorkerCount() > 0)
+            blocks = std::min(Jobs::GetWorkerCount() + 1, MaxBlocks);
+
+        const size_t blockSize = (count + blocks - 1) / blocks;
+
+        m_Scratch.resize(count);
+        m_Histograms.resize((size_t)blocks * RadixSize);
+
+        Entry* src = m_Entries.data();
+        Entry* dst = m_Scratch.data();
+
+        auto forEachBlock = [blocks](JobRangeFunction&& function)
+        {
+            if (blocks == 1)
+                function(0, 1);
+            else
+                Jobs::Wait(Jobs::ParallelFor(blocks, 1, std::move(function), "RenderQueue::Sort"));
+        };
+
+        // Least significant digit first, every pass is stable so the previous passes' order is kept
+        for (uint32_t shift = 0; shift < 64; shift += RadixBits)
+        {
+            if (((difference >> shift) & (RadixSize - 1)) == 0)
+                continue;
+
+            // Count the digits of every block
+            forEachBlock([&](uint32_t begin, uint32_t end)
+            {
+                for (uint32_t block = begin; block < end; block++)
+                {
+                    uint32_t* histogram = &m_Histograms[(size_t)block * RadixSize];
+                    std::fill_n(histogram, RadixSize, 0u);
+
+                    size_t first = std::min(block * blockSize, count);
+                    size_t last = std::min(first + blockSize, count);
+                    for (size_t i = first; i < last; i++)
+                        histogram[(src[i].Key >> shift) & (RadixSize - 1)]++;
+                }
+            });
+
+            // Turn the counts into offsets, the blocks of a digit are laid out in order which keeps the pass stable
+            uint32_t offset = 0;
+            for (uint32_t digit = 0; digit < RadixSize; digit++)
+            {
+                for (uint32_t block = 0; block < blocks; block++)
+                {
+                    uint32_t& slot = m_Histograms[(size_t)block * RadixSize + digit];
+                    uint32_t amount = slot;
+                    slot = offset;
+                    offset += amount;
+                }
+            }
+
+            // Move every entry to its digit's next slot
+            forEachBlock([&](uint32_t begin, uint32_t end)
+            {
+                for (uint32_t block = begin; block < end; block++)
+                {
+                    uint32_t* offsets = &m_Histograms[(size_t)block * RadixSize];
+
+                    size_t first = std::min(block * blockSize, count);
+                    size_t last = std::min(first + blockSize, count);
+                    for (size_t i = first; i < last; i++)
+                        dst[offsets[(src[i].Key >> shift) & (RadixSize - 1)]++] = src[i];
+                }
+            });
+
+            std::swap(src, dst);
+        }
+
+        if (src != m_Entries.data())
+            m_Entries.swap(m_Scratch);
+    }
+
+    void RenderQueue::Record(CommandStream& stream) const
+    {
+        HZ_PROFILE_SCOPE("RenderQueue::Record");
+
+        for (const Entry& entry : m_Entries)
+        {
+            const RenderItem& item = m_Items[entry.Index];
+
+            stream.BindPipeline(item.DrawPipeline);
+            if (item.Material)
+                stream.BindDescriptorSet(item.Material);
+            if (item.Vertices)
+                stream.BindVertexBuffer(item.Vertices);
+
+            if (item.Indices)
+            {
+                stream.BindIndexBuffer(item.Indices);
+                stream.DrawIndexed((item.Count ? item.Count : item.Indices->GetCount()), item.InstanceCount);
+            }
+            else
+            {
+                stream.Draw(item.Count, item.InstanceCount);
+            }
+        }
+    }
+
+    void RenderQueue::Execute(Ref<CommandBuffer> cmdBuf)
+    {
+        uint64_t frame = Renderer::GetFrameCount();
+        HZ_ASSERT((frame != m_LastExecute), "RenderQueue::Execute called more than once in a frame, the previous recording might not have been replayed yet.");
+        m_LastExecute = frame;
+
+        Sort();
+
+        Ref<CommandStream> stream = m_Streams[frame % m_Streams.size()];
+
+        stream->Reset();
+        Record(*stream);
+
+        Renderer::Replay(cmdBuf, stream);
+    }
+
+    void RenderQueue::Reset()
+    {
+        m_Items.clear();
+        m_Entries.clear();
+    }
+
+}
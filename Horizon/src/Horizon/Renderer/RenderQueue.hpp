@@ -0,0 +1,103 @@
+#pragma once
+
+#include "Horizon/Core/Core.hpp"
+
+#include "Horizon/Renderer/Pipeline.hpp"
+#include "Horizon/Renderer/Descriptors.hpp"
+#include "Horizon/Renderer/Buffers.hpp"
+#include "Horizon/Renderer/CommandBuffer.hpp"
+#include "Horizon/Renderer/CommandStream.hpp"
+
+#include <array>
+#include <vector>
+
+namespace Hz
+{
+
+    ///////////////////////////////////////////////////////////
+    // Specifications
+    ///////////////////////////////////////////////////////////
+    struct RenderItem
+    {
+    public:
+        uint8_t Layer = 0;                          // Lower layers are drawn first
+        bool Translucent = false;                   // Translucent items are drawn back-to-front after the opaque ones of their layer
+        float Depth = 0.0f;                         // Normalized [0, 1] distance to the camera (e.g. viewDepth / farPlane)
+
+        Ref<Pipeline> DrawPipeline = nullptr;
+        Ref<DescriptorSet> Material = nullptr;      // Optional, but either every item of a queue has one or none does
+        Ref<VertexBuffer> Vertices = nullptr;       // Optional, for vertex pulling
+        Ref<IndexBuffer> Indices = nullptr;         // Optional, draws indexed when set
+
+        uint32_t Count = 0;                         // Amount of vertices, or indices when indexed (0 uses the whole index buffer)
+        uint32_t InstanceCount = 1;
+    };
+
+    // Layout of the 64-bit sort key (from the most significant bit)
+    // - Opaque:      Layer (8) | 0 | Pipeline (12) | Material (12) | Depth (24)            | Mesh (7)
+    // - Translucent: Layer (8) | 1 | Inverse depth (24)            | Pipeline (12) | Material (12) | Mesh (7)
+    // Note: Opaque items are grouped by state first and drawn front-to-back within a group, translucent items have to be
+    // drawn back-to-front so depth comes first. Pipeline/material/mesh are hashed, a collision only costs an extra bind.
+    struct RenderKey
+    {
+    public:
+        inline static constexpr const uint32_t LayerBits = 8;
+        inline static constexpr const uint32_t PipelineBits = 12;
+        inline static constexpr const uint32_t MaterialBits = 12;
+        inline static constexpr const uint32_t DepthBits = 24;
+        inline static constexpr const uint32_t MeshBits = 7;
+
+        static uint64_t Create(const RenderItem& item);
+    };
+
+    ///////////////////////////////////////////////////////////
+    // Core class
+    ///////////////////////////////////////////////////////////
+    // Collects the draws of a frame, radix sorts them by their RenderKey (in parallel using Jobs) and records them in that order.
+    // Note: Submitting isn't thread safe. Descriptor sets that are shared by all items (camera, ...) can be bound on the
+    // stream before Record(), they stay bound since items only bind their own material's set ID.
+    class RenderQueue
+    {
+    public:
+        RenderQueue();
+        ~RenderQueue() = default;
+
+        void Submit(const RenderItem& item);
+
+        void Sort();
+        void Record(CommandStream& stream) const; // Appends the items in their current order
+
+        // Sorts, records into an internal stream & replays that into the command buffer, Note: Doesn't Reset().
+        // Can only be called once per frame, since the stream is replayed when the render thread executes the frame.
+        void Execute(Ref<CommandBuffer> cmdBuf);
+
+        void Reset(); // Note: Keeps the memory around for the next frame
+
+        inline size_t Size() const { return m_Items.size(); }
+        inline bool Empty() const { return m_Items.empty(); }
+
+    private:
+        struct Entry
+        {
+        public:
+            uint64_t Key;
+            uint32_t Index; // Into m_Items
+        };
+
+        inline static constexpr const uint32_t RadixBits = 8;
+        inline static constexpr const uint32_t RadixSize = 1u << RadixBits;
+        inline static constexpr const uint32_t MaxBlocks = 32;
+        inline static constexpr const size_t ParallelThreshold = 4096; // Below this the job overhead isn't worth it
+
+    private:
+        std::vector<RenderItem> m_Items = { };
+        std::vector<Entry> m_Entries = { };
+        std::vector<Entry> m_Scratch = { };
+        std::vector<uint32_t> m_Histograms = { }; // RadixSize for every block
+
+        // Note: Two, indexed by the frame count, since a render thread may still be replaying last frame's stream
+        std::array<Ref<CommandStream>, 2> m_Streams = { };
+        uint64_t m_LastExecute = UINT64_MAX; // Renderer::GetFrameCount() of the last Execute()
+    };
+
+}
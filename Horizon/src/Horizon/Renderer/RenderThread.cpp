@@ -0,0 +1,166 @@
+#include "hzpch.h"
+#include "RenderThread.hpp"
+
+#include "Horizon/Core/Logging.hpp"
+
+#include "Horizon/Utils/Profiler.hpp"
+#include "Horizon/Utils/AllocationTracker.hpp"
+
+namespace Hz
+{
+
+    ///////////////////////////////////////////////////////////
+    // Command queue
+    ///////////////////////////////////////////////////////////
+    void RenderCommandQueue::Execute()
+    {
+        for (auto& chunk : m_Chunks)
+        {
+            size_t offset = 0;
+            while (offset < chunk.Used)
+            {
+                Header* header = reinterpret_cast<Header*>(chunk.Memory.get() + offset);
+                header->Execute(chunk.Memory.get() + offset + HeaderSize);
+
+                offset += header->Size;
+            }
+
+            chunk.Used = 0;
+        }
+
+        m_CurrentChunk = 0;
+        m_Count = 0;
+    }
+
+    byte* RenderCommandQueue::Allocate(size_t size)
+    {
+        size = AlignUp(size);
+
+        // Note: Chunks are never moved or freed, so commands can safely live in them until they're executed
+        while (m_CurrentChunk < m_Chunks.size())
+        {
+            Chunk& chunk = m_Chunks[m_CurrentChunk];
+            if (chunk.Used + size <= chunk.Capacity)
+            {
+                byte* memory = chunk.Memory.get() + chunk.Used;
+                chunk.Used += size;
+                return memory;
+            }
+
+            m_CurrentChunk++;
+        }
+
+        Chunk& chunk = m_Chunks.emplace_back();
+        chunk.Capacity = std::max(ChunkSize, size);
+        chunk.Memory = std::make_unique<byte[]>(chunk.Capacity);
+        chunk.Used = size;
+
+        return chunk.Memory.get();
+    }
+
+    ///////////////////////////////////////////////////////////
+    // Core class
+    ///////////////////////////////////////////////////////////
+    void RenderThread::Init()
+    {
+        HZ_ASSERT((!s_Data.Running.load()), "RenderThread::Init called while the render thread is already running.");
+
+        s_Data.Stop.store(false);
+        s_Data.Busy.store(false);
+        s_Data.SubmitIndex = 0;
+
+        s_Data.Running.store(true, std::memory_order_release);
+        s_Data.Thread = std::thread(&RenderThread::Worker);
+    }
+
+    void RenderThread::Destroy()
+    {
+        if (!s_Data.Running.load())
+            return;
+
+        Flush();
+
+        s_Data.Stop.store(true);
+        Kick();
+        s_Data.Thread.join();
+
+        s_Data.Running.store(false, std::memory_order_release);
+    }
+
+    void RenderThread::NextFrame()
+    {
+        if (!s_Data.Running.load(std::memory_order_acquire) || IsRenderThread())
+            return;
+
+        WaitIdle();
+
+        s_Data.SubmitIndex ^= 1;
+        Kick();
+    }
+
+    void RenderThread::Flush()
+    {
+        if (!s_Data.Running.load(std::memory_order_acquire) || IsRenderThread())
+            return;
+
+        NextFrame();
+        WaitIdle();
+    }
+
+    bool RenderThread::Active()
+    {
+        return s_Data.Running.load(std::memory_order_acquire);
+    }
+
+    bool RenderThread::IsRenderThread()
+    {
+        return s_IsRenderThread;
+    }
+
+    std::unique_lock<std::recursive_mutex> RenderThread::Lock()
+    {
+        return std::unique_lock<std::recursive_mutex>(s_Data.Mutex);
+    }
+
+    void RenderThread::Kick()
+    {
+        s_Data.Busy.store(true, std::memory_order_release);
+        s_Data.Busy.notify_one();
+    }
+
+    void RenderThread::WaitIdle()
+    {
+        HZ_PROFILE_SCOPE("RenderThread::WaitIdle");
+
+        while (s_Data.Busy.load(std::memory_order_acquire))
+            s_Data.Busy.wait(true, std::memory_order_acquire);
+    }
+
+    void RenderThread::Worker()
+    {
+        s_IsRenderThread = true;
+        HZ_PROFILE_THREAD("Horizon Render Thread");
+        HZ_ALLOCATION_TAG(AllocationTag::Renderer);
+
+        while (true)
+        {
+            s_Data.Busy.wait(false, std::memory_order_acquire);
+            if (s_Data.Stop.load())
+                break;
+
+            {
+                HZ_PROFILE_SCOPE("RenderThread::Execute");
+
+                // Note: The main thread has already swapped, so the queue we execute is the other one
+                s_Data.Queues[s_Data.SubmitIndex ^ 1].Execute();
+            }
+
+            s_Data.Busy.store(false, std::memory_order_release);
+            s_Data.Busy.notify_all();
+        }
+
+        s_Data.Busy.store(false, std::memory_order_release);
+        s_Data.Busy.notify_all();
+    }
+
+}
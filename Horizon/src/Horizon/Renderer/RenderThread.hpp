@@ -0,0 +1,148 @@
+#pragma once
+
+#include "Horizon/Core/Core.hpp"
+
+#include <new>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <utility>
+#include <type_traits>
+
+namespace Hz
+{
+
+    ///////////////////////////////////////////////////////////
+    // Command queue
+    ///////////////////////////////////////////////////////////
+    // A stream of type-erased commands, stored back to back in chunks of memory which are reused every frame.
+    // Note: Only one thread may push at a time and it may not be executed while pushing.
+    class RenderCommandQueue
+    {
+    public:
+        RenderCommandQueue() = default;
+        ~RenderCommandQueue() = default;
+
+        template<typename TFunc>
+        void Push(TFunc&& func)
+        {
+            using Func = std::decay_t<TFunc>;
+            static_assert((alignof(Func) <= Alignment), "Command captures are over-aligned.");
+
+            byte* memory = Allocate(HeaderSize + sizeof(Func));
+
+            Header* header = new (memory) Header();
+            header->Execute = [](byte* payload)
+            {
+                Func* func = reinterpret_cast<Func*>(payload);
+                (*func)();
+                func->~Func();
+            };
+            header->Size = (uint32_t)AlignUp(HeaderSize + sizeof(Func));
+
+            new (memory + HeaderSize) Func(std::forward<TFunc>(func));
+            m_Count++;
+        }
+
+        void Execute(); // Runs (and destroys) all commands in submission order
+
+        inline uint32_t GetCount() const { return m_Count; }
+        inline bool Empty() const { return (m_Count == 0); }
+
+    private:
+        byte* Allocate(size_t size);
+
+        inline static constexpr size_t AlignUp(size_t size) { return (size + Alignment - 1) & ~(Alignment - 1); }
+
+    private:
+        struct Header
+        {
+        public:
+            void (*Execute)(byte* payload) = nullptr;
+            uint32_t Size = 0; // Of the header and payload together
+        };
+
+        struct Chunk
+        {
+        public:
+            std::unique_ptr<byte[]> Memory = nullptr;
+            size_t Capacity = 0;
+            size_t Used = 0;
+        };
+
+        inline static constexpr const size_t Alignment = 16;
+        inline static constexpr const size_t HeaderSize = (sizeof(Header) + Alignment - 1) & ~(Alignment - 1);
+        inline static constexpr const size_t ChunkSize = 64ull * 1024ull;
+
+        std::vector<Chunk> m_Chunks = { };
+        size_t m_CurrentChunk = 0;
+        uint32_t m_Count = 0;
+    };
+
+    ///////////////////////////////////////////////////////////
+    // Core class
+    ///////////////////////////////////////////////////////////
+    // An optional thread which replays the renderer's commands (RendererSpecification::UseRenderThread).
+    // The main thread records the next frame into one queue while the render thread executes the previous one,
+    // Present() hands the queue over. So the main thread runs at most one frame ahead of the render thread.
+    // Note: Only the calls through Renderer are deferred automatically, other recording
+    // (Pipeline::Use, buffer binds, per-frame buffer updates, ...) has to be wrapped in Renderer::Enqueue().
+    class RenderThread
+    {
+    public:
+        static void Init();
+        static void Destroy(); // Note: Executes all outstanding commands first
+
+        // Runs the command right away when the render thread isn't used or when called from the render thread itself
+        template<typename TFunc>
+        static void Enqueue(TFunc&& func)
+        {
+            if (!s_Data.Running.load(std::memory_order_acquire) || IsRenderThread())
+            {
+                func();
+                return;
+            }
+
+            s_Data.Queues[s_Data.SubmitIndex].Push(std::forward<TFunc>(func));
+        }
+
+        static void NextFrame(); // Hands the recorded commands to the render thread, waits for the previous frame to finish first
+        static void Flush(); // Hands over the recorded commands & waits till they're executed
+
+        static bool Active();
+        static bool IsRenderThread();
+
+        // Note: Guards the device's queues, which every thread submits to. It's only held around
+        // submitting, presenting & waiting idle, it's recursive so nested use is fine.
+        // Command pools aren't shared, the swapchain's pool is only used on the render thread.
+        static std::unique_lock<std::recursive_mutex> Lock();
+
+    private:
+        static void Kick();
+        static void WaitIdle();
+        static void Worker();
+
+    private:
+        // Note: We store our info in a struct, so we can ensure lifetime
+        // of all objects easily while the class remains static.
+        struct Info
+        {
+        public:
+            std::thread Thread = {};
+            std::atomic<bool> Running = false;
+            std::atomic<bool> Stop = false;
+
+            RenderCommandQueue Queues[2] = { };
+            uint32_t SubmitIndex = 0;           // Note: Only touched by the main thread, and by the render thread while Busy
+
+            std::atomic<bool> Busy = false;     // Whether the render thread is executing the other queue
+            std::recursive_mutex Mutex = {};
+        };
+
+        inline static Info s_Data = {};
+        inline static thread_local bool s_IsRenderThread = false;
+    };
+
+}
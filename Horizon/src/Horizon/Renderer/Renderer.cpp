@@ -3,12 +3,18 @@
 
 #include "Horizon/Core/Logging.hpp"
 
+#include "Horizon/Utils/AllocationTracker.hpp"
+
 #include "Horizon/Renderer/GraphicsContext.hpp"
 #include "Horizon/Renderer/Buffers.hpp"
 
 #include "Horizon/Vulkan/VulkanRenderer.hpp"
 #include "Horizon/Vulkan/VulkanContext.hpp"
 
+#include <span>
+#include <array>
+#include <algorithm>
+
 #include <Pulse/Enum/Enum.hpp>
 
 namespace Hz
@@ -20,9 +26,34 @@ namespace Hz
 
     using RendererType = typename RendererSelector<RendererSpecification::API>::Type;
 
+    // Note: The submits capture their wait list by value, this keeps it inside the command queue's storage instead of a heap allocated std::vector
+    struct WaitList
+    {
+    public:
+        WaitList(const std::vector<Ref<CommandBuffer>>& waitOn)
+            : Count((uint32_t)waitOn.size())
+        {
+            HZ_ASSERT((waitOn.size() <= MaxCount), "A submit can wait on at most {0} command buffers.", MaxCount);
+            std::copy(waitOn.begin(), waitOn.end(), CommandBuffers.begin());
+        }
+
+        inline std::span<const Ref<CommandBuffer>> Get() const { return { CommandBuffers.data(), Count }; }
+
+    public:
+        inline static constexpr const uint32_t MaxCount = 8;
+
+        std::array<Ref<CommandBuffer>, MaxCount> CommandBuffers = { };
+        uint32_t Count = 0;
+    };
+
     void Renderer::Init(const RendererSpecification& specs)
     {
+        s_RecordFrame = 0;
+        s_FrameCount = 0;
         RendererType::Init(specs);
+
+        if (specs.UseRenderThread)
+            RenderThread::Init();
     }
 
     bool Renderer::Initialized()
@@ -32,77 +63,113 @@ namespace Hz
 
     void Renderer::Destroy()
     {
+        RenderThread::Destroy();
         RendererType::Destroy();
     }
 
     void Renderer::Recreate(uint32_t width, uint32_t height, const bool vsync)
     {
-        RendererType::Recreate(width, height, vsync);
+        RenderThread::Enqueue([width, height, vsync]() { RendererType::Recreate(width, height, vsync); });
     }
 
     void Renderer::BeginFrame()
     {
-        RendererType::BeginFrame();
+        HZ_ALLOCATION_TAG(AllocationTag::Renderer);
+        RenderThread::Enqueue([frame = s_RecordFrame]() { RendererType::BeginFrame(frame); });
     }
 
     void Renderer::EndFrame()
     {
-        RendererType::EndFrame();
+        HZ_ALLOCATION_TAG(AllocationTag::Renderer);
+        RenderThread::Enqueue([]() { RendererType::EndFrame(); });
     }
 
     void Renderer::Present()
     {
-        RendererType::Present();
+        HZ_ALLOCATION_TAG(AllocationTag::Renderer);
+        RenderThread::Enqueue([]() { RendererType::Present(); });
+        s_RecordFrame = (s_RecordFrame + 1) % (uint32_t)GetSpecification().Buffers;
+        s_FrameCount++;
+
+        RenderThread::NextFrame();
     }
 
     void Renderer::BeginDynamic(Ref<CommandBuffer> cmdBuf, DynamicRenderState&& state)
     {
-        RendererType::BeginDynamic(cmdBuf, std::move(state));
+        HZ_ALLOCATION_TAG(AllocationTag::Renderer);
+        RenderThread::Enqueue([cmdBuf, state = std::move(state)]() mutable { RendererType::BeginDynamic(cmdBuf, std::move(state)); });
     }
 
     void Renderer::EndDynamic(Ref<CommandBuffer> cmdBuf)
     {
-        RendererType::EndDynamic(cmdBuf);
+        HZ_ALLOCATION_TAG(AllocationTag::Renderer);
+        RenderThread::Enqueue([cmdBuf]() { RendererType::EndDynamic(cmdBuf); });
     }
 
     void Renderer::Begin(Ref<CommandBuffer> cmdBuf)
     {
-        RendererType::Begin(cmdBuf);
+        HZ_ALLOCATION_TAG(AllocationTag::Renderer);
+        RenderThread::Enqueue([cmdBuf]() { RendererType::Begin(cmdBuf); });
     }
 
     void Renderer::Begin(Ref<Renderpass> renderpass)
     {
-        RendererType::Begin(renderpass);
+        HZ_ALLOCATION_TAG(AllocationTag::Renderer);
+        RenderThread::Enqueue([renderpass]() { RendererType::Begin(renderpass); });
     }
 
     void Renderer::End(Ref<CommandBuffer> cmdBuf)
     {
-        RendererType::End(cmdBuf);
+        HZ_ALLOCATION_TAG(AllocationTag::Renderer);
+        RenderThread::Enqueue([cmdBuf]() { RendererType::End(cmdBuf); });
+    }
+
+    void Renderer::NextSubpass(Ref<Renderpass> renderpass)
+    {
+        HZ_ALLOCATION_TAG(AllocationTag::Renderer);
+        RenderThread::Enqueue([renderpass]() { RendererType::NextSubpass(renderpass); });
     }
 
     void Renderer::End(Ref<Renderpass> renderpass)
     {
-        RendererType::End(renderpass);
+        HZ_ALLOCATION_TAG(AllocationTag::Renderer);
+        RenderThread::Enqueue([renderpass]() { RendererType::End(renderpass); });
     }
 
     void Renderer::Submit(Ref<CommandBuffer> cmdBuf, ExecutionPolicy policy, Queue queue, const std::vector<Ref<CommandBuffer>>& waitOn)
     {
-        RendererType::Submit(cmdBuf, policy, queue, waitOn);
+        HZ_ALLOCATION_TAG(AllocationTag::Renderer);
+        RenderThread::Enqueue([cmdBuf, policy, queue, waitList = WaitList(waitOn)]() { RendererType::Submit(cmdBuf, policy, queue, waitList.Get()); });
     }
 
     void Renderer::Submit(Ref<Renderpass> renderpass, ExecutionPolicy policy, Queue queue, const std::vector<Ref<CommandBuffer>>& waitOn)
     {
-        RendererType::Submit(renderpass, policy, queue, waitOn);
+        HZ_ALLOCATION_TAG(AllocationTag::Renderer);
+        RenderThread::Enqueue([renderpass, policy, queue, waitList = WaitList(waitOn)]() { RendererType::Submit(renderpass, policy, queue, waitList.Get()); });
     }
 
     void Renderer::Draw(Ref<CommandBuffer> cmdBuf, uint32_t vertexCount, uint32_t instanceCount)
     {
-        RendererType::Draw(cmdBuf, vertexCount, instanceCount);
+        HZ_ALLOCATION_TAG(AllocationTag::Renderer);
+        RenderThread::Enqueue([cmdBuf, vertexCount, instanceCount]() { RendererType::Draw(cmdBuf, vertexCount, instanceCount); });
     }
 
     void Renderer::DrawIndexed(Ref<CommandBuffer> cmdBuf, Ref<IndexBuffer> indexBuffer, uint32_t instanceCount)
     {
-        RendererType::DrawIndexed(cmdBuf, indexBuffer, instanceCount);
+        HZ_ALLOCATION_TAG(AllocationTag::Renderer);
+        RenderThread::Enqueue([cmdBuf, indexBuffer, instanceCount]() { RendererType::DrawIndexed(cmdBuf, indexBuffer, instanceCount); });
+    }
+
+    void Renderer::Replay(Ref<CommandBuffer> cmdBuf, Ref<CommandStream> stream)
+    {
+        HZ_ALLOCATION_TAG(AllocationTag::Renderer);
+        RenderThread::Enqueue([cmdBuf, stream]() { RendererType::Replay(cmdBuf, stream); });
+    }
+
+    void Renderer::Replay(const std::vector<Ref<CommandBuffer>>& cmdBufs, Ref<CommandStream> stream)
+    {
+        HZ_ALLOCATION_TAG(AllocationTag::Renderer);
+        RenderThread::Enqueue([cmdBufs, stream]() { RendererType::Replay(cmdBufs, stream); });
     }
 
     // Note: The 2 functions below actually use the GraphicsContect since the queue needs to live even after the renderer is destroyed
@@ -113,7 +180,8 @@ namespace Hz
 
     void Renderer::FreeObjects()
     {
-        RendererType::FreeObjects();
+        HZ_ALLOCATION_TAG(AllocationTag::Renderer);
+        RenderThread::Enqueue([]() { RendererType::FreeObjects(); });
     }
 
     uint32_t Renderer::GetAcquiredImage()
@@ -123,7 +191,15 @@ namespace Hz
 
     uint32_t Renderer::GetCurrentFrame()
     {
-        return RendererType::GetCurrentFrame();
+        if (RenderThread::IsRenderThread())
+            return RendererType::GetCurrentFrame();
+
+        return s_RecordFrame;
+    }
+
+    uint64_t Renderer::GetFrameCount()
+    {
+        return s_FrameCount;
     }
 
     const RendererSpecification& Renderer::GetSpecification()
@@ -131,4 +207,39 @@ namespace Hz
         return RendererType::GetSpecification();
     }
 
+    MemoryStatistics Renderer::GetMemoryStatistics()
+    {
+        return RendererType::GetMemoryStatistics();
+    }
+
+    void Renderer::AddMemoryBudgetCallback(MemoryBudgetCallback&& callback, float highThreshold)
+    {
+        RendererType::AddMemoryBudgetCallback(std::move(callback), highThreshold);
+    }
+
+    void Renderer::Defragment(const DefragmentationSpecification& specs)
+    {
+        RenderThread::Enqueue([specs]() { RendererType::Defragment(specs); });
+    }
+
+    bool Renderer::IsDefragmenting()
+    {
+        return RendererType::IsDefragmenting();
+    }
+
+    void Renderer::SetStreamingBudget(uint64_t bytes)
+    {
+        RendererType::SetStreamingBudget(bytes);
+    }
+
+    GpuTimings Renderer::GetGpuTimings()
+    {
+        return RendererType::GetGpuTimings();
+    }
+
+    RenderCounters Renderer::GetFrameCounters()
+    {
+        return RendererType::GetFrameCounters();
+    }
+
 }
@@ -7,11 +7,16 @@
 #include "Horizon/Renderer/Renderpass.hpp"
 #include "Horizon/Renderer/Buffers.hpp"
 #include "Horizon/Renderer/Image.hpp"
+#include "Horizon/Renderer/StreamedImage.hpp"
+#include "Horizon/Renderer/CommandStream.hpp"
+#include "Horizon/Renderer/RenderQueue.hpp"
+#include "Horizon/Renderer/RenderThread.hpp"
 // Note: I purposefully don't forward declare ^ since I want
 // the user to be able to just include the Renderer (this).
 
 #include <glm/glm.hpp>
 
+#include <array>
 #include <functional>
 
 namespace Hz
@@ -38,6 +43,9 @@ namespace Hz
         LoadOperation ColourLoadOp = LoadOperation::Clear;
         StoreOperation ColourStoreOp = StoreOperation::Store;
         glm::vec4 ColourClearValue = { 0.0f, 0.0f, 0.0f, 1.0f };
+        Ref<Image> ColourResolve = nullptr; // Single sampled image the (multisampled) ColourAttachment gets resolved into
+
+        std::vector<ColourAttachmentSpecification> ColourAttachments = { }; // Multiple render targets, these follow the ColourAttachment (if there is one)
 
         Ref<Image> DepthAttachment = nullptr;
         LoadOperation DepthLoadOp = LoadOperation::Clear;
@@ -47,6 +55,80 @@ namespace Hz
 
     using FreeFunction = std::function<void()>;
 
+    ///////////////////////////////////////////////////////////
+    // Statistics
+    ///////////////////////////////////////////////////////////
+    enum class ResourceKind : uint8_t { Vertex = 0, Index, Uniform, Storage, Image, Staging, Other, Count };
+    enum class MemoryPressure : uint8_t { Normal = 0, High, Exceeded };
+
+    struct MemoryHeapStatistics
+    {
+    public:
+        bool DeviceLocal = false;
+
+        uint64_t Usage = 0;         // Estimated usage of the heap by the whole process (driver included when VK_EXT_memory_budget is available)
+        uint64_t Budget = 0;        // Estimated amount of memory available to the process
+        uint64_t Peak = 0;          // Highest observed Usage
+
+        uint64_t AllocatedBytes = 0;    // Bytes in live allocations of our allocator
+        uint64_t BlockBytes = 0;        // Bytes in memory blocks reserved by our allocator
+
+        MemoryPressure Pressure = MemoryPressure::Normal; // Classified with the default threshold (0.9), callbacks get their own
+    };
+
+    struct MemoryStatistics
+    {
+    public:
+        std::vector<MemoryHeapStatistics> Heaps = { };
+
+        std::array<uint32_t, (size_t)ResourceKind::Count> Allocations = { };   // Live allocations per resource kind
+        std::array<uint64_t, (size_t)ResourceKind::Count> Bytes = { };         // Live bytes per resource kind
+        std::array<uint64_t, (size_t)ResourceKind::Count> PeakBytes = { };     // Highest observed Bytes per resource kind
+
+        uint64_t TotalUsage = 0;
+        uint64_t TotalBudget = 0;
+        uint64_t PeakUsage = 0;
+
+        bool BudgetExtension = false; // Whether VK_EXT_memory_budget (or equivalent) backs the Usage/Budget numbers
+    };
+
+    // Called when the MemoryPressure of a heap changes, so streaming systems can back off before running out of memory.
+    using MemoryBudgetCallback = std::function<void(uint32_t heap, MemoryPressure pressure, const MemoryStatistics& stats)>;
+
+    struct GpuZoneTiming
+    {
+    public:
+        const char* Name = nullptr;     // Note: Zone names are string literals
+        uint32_t Depth = 0;             // Nesting level inside of its command buffer
+
+        double Start = 0.0;             // In milliseconds, relative to the first timestamp of the frame
+        double Duration = 0.0;          // In milliseconds
+    };
+
+    struct GpuTimings
+    {
+    public:
+        std::vector<GpuZoneTiming> Zones = { };    // Ordered by the time they were recorded
+
+        uint64_t Frame = 0;             // The frame these timings were recorded in
+        double FrameTime = 0.0;         // In milliseconds, from the first to the last timestamp of the frame
+
+        bool Supported = false;         // Whether the device supports (host resettable) timestamp queries
+    };
+
+    enum class DefragmentationAlgorithm : uint8_t { Fast = 0, Balanced, Full };
+
+    // Note: Only GPU-only vertex/index buffers (without DeviceAddress) and file images are moved,
+    // their handles and the descriptor sets they are uploaded to are patched behind the scenes.
+    struct DefragmentationSpecification
+    {
+    public:
+        DefragmentationAlgorithm Algorithm = DefragmentationAlgorithm::Balanced;
+
+        uint32_t MaxMovesPerPass = 32;                  // A pass starts every frame and finishes after all frames in flight are done with the old memory
+        uint64_t MaxBytesPerPass = 32ull * 1024 * 1024;
+    };
+
     ///////////////////////////////////////////////////////////
     // Core class
     ///////////////////////////////////////////////////////////
@@ -72,6 +154,7 @@ namespace Hz
         static void Begin(Ref<CommandBuffer> cmdBuf);
         static void Begin(Ref<Renderpass> renderpass);
         static void End(Ref<CommandBuffer> cmdBuf);
+        static void NextSubpass(Ref<Renderpass> renderpass); // Moves on to the renderpass' next subpass, bind that subpass' pipeline afterwards
         static void End(Ref<Renderpass> renderpass);
         static void Submit(Ref<CommandBuffer> cmdBuf, ExecutionPolicy policy = ExecutionPolicy::InOrder | ExecutionPolicy::WaitForPrevious, Queue queue = Queue::Graphics, const std::vector<Ref<CommandBuffer>>& waitOn = {});
         static void Submit(Ref<Renderpass> renderpass, ExecutionPolicy policy = ExecutionPolicy::InOrder | ExecutionPolicy::WaitForPrevious, Queue queue = Queue::Graphics, const std::vector<Ref<CommandBuffer>>& waitOn = {});
@@ -79,12 +162,43 @@ namespace Hz
         static void Draw(Ref<CommandBuffer> cmdBuf, uint32_t vertexCount = 3, uint32_t instanceCount = 1);
         static void DrawIndexed(Ref<CommandBuffer> cmdBuf, Ref<IndexBuffer> indexBuffer, uint32_t instanceCount = 1);
 
+        // Translates the recorded commands into the command buffer(s), multiple command buffers each get an equal share in order & are recorded in parallel
+        // Note: The command buffers have to be begun (and inside the renderpass/dynamic rendering) already, multiple ones have to be distinct
+        static void Replay(Ref<CommandBuffer> cmdBuf, Ref<CommandStream> stream);
+        static void Replay(const std::vector<Ref<CommandBuffer>>& cmdBufs, Ref<CommandStream> stream);
+
         static void Free(FreeFunction&& func); // Adds to the renderfree queue
         static void FreeObjects(); // Executes the free queue
 
+        // Runs the function on the render thread in submission order, or right away without one (RendererSpecification::UseRenderThread).
+        // Note: The functions above are enqueued automatically, wrap any other recording (Pipeline::Use, buffer binds, ...) in this.
+        template<typename TFunc>
+        inline static void Enqueue(TFunc&& func) { RenderThread::Enqueue(std::forward<TFunc>(func)); }
+
         static uint32_t GetAcquiredImage();
-        static uint32_t GetCurrentFrame();
+        static uint32_t GetCurrentFrame(); // Of the calling thread, Note: With a render thread the main thread records a frame ahead
+        static uint64_t GetFrameCount(); // Amount of frames recorded, Note: Only for the recording thread
         static const RendererSpecification& GetSpecification();
+
+        // Memory, Note: Statistics are updated every BeginFrame(), they're returned by value since that can happen on the render thread
+        static MemoryStatistics GetMemoryStatistics();
+        static void AddMemoryBudgetCallback(MemoryBudgetCallback&& callback, float highThreshold = 0.9f); // A heap is under High pressure once Usage >= highThreshold * Budget
+
+        static void Defragment(const DefragmentationSpecification& specs = {}); // Starts an incremental defragmentation which progresses every BeginFrame()
+        static bool IsDefragmenting();
+
+        static void SetStreamingBudget(uint64_t bytes); // Total amount of bytes all StreamedImages may use
+
+        // Note: GPU timings lag behind by the amount of frames in flight, they are updated every BeginFrame().
+        // Returned by value, since with a render thread they get updated while the main thread reads them.
+        static GpuTimings GetGpuTimings();
+        static RenderCounters GetFrameCounters(); // Counters of the last frame, Note: Updated every BeginFrame(), returned by value for the same reason
+
+    private:
+        // Note: Owned by the recording thread and handed to the render thread with BeginFrame(),
+        // so the render thread executes a frame with the index its commands were recorded with.
+        inline static uint32_t s_RecordFrame = 0;
+        inline static uint64_t s_FrameCount = 0;
     };
 
 }
@@ -16,10 +16,11 @@ namespace Hz
     public:
 		BufferCount Buffers;
 		bool VSync;
+		bool UseRenderThread; // Records on the calling thread, executes on a dedicated render thread (see RenderThread)
 
 	public:
-		constexpr RendererSpecification(BufferCount buffers = BufferCount::Triple, bool vsync = true)
-			: Buffers(buffers), VSync(vsync)
+		constexpr RendererSpecification(BufferCount buffers = BufferCount::Triple, bool vsync = true, bool useRenderThread = false)
+			: Buffers(buffers), VSync(vsync), UseRenderThread(useRenderThread)
 		{
         }
 		constexpr ~RendererSpecification() = default;
@@ -8,6 +8,7 @@
 
 #include <glm/glm.hpp>
 
+#include <limits>
 #include <type_traits>
 
 namespace Hz
@@ -37,6 +38,31 @@ namespace Hz
         NoneEXT = None,
     };
 
+    struct ColourAttachmentSpecification
+    {
+    public:
+        Ref<Image> Attachment = nullptr;
+        LoadOperation LoadOp = LoadOperation::Clear;
+        StoreOperation StoreOp = StoreOperation::Store;
+        glm::vec4 ClearColour = { 0.0f, 0.0f, 0.0f, 1.0f };
+        ImageLayout PreviousLayout = ImageLayout::Undefined;   // Note: Only used by renderpasses, dynamic rendering uses the image's layout
+        ImageLayout FinalLayout = ImageLayout::ShaderRead;      // Note: Only used by renderpasses, dynamic rendering uses the image's layout
+
+        Ref<Image> Resolve = nullptr; // Single sampled image the (multisampled) attachment gets resolved into, receives the FinalLayout
+    };
+
+    // Subpasses let attachments be read (with subpassLoad) by later subpasses of the same renderpass,
+    // on tiled GPUs these never leave tile memory (make them Transient & StoreOperation::DontCare to skip the write-back).
+    struct SubpassSpecification
+    {
+    public:
+        inline static constexpr const uint32_t Depth = std::numeric_limits<uint32_t>::max(); // Refers to the DepthAttachment in InputAttachments
+
+        std::vector<uint32_t> ColourAttachments = { };  // Indices into the renderpass' colour attachments (ColourAttachment first, then ColourAttachments)
+        std::vector<uint32_t> InputAttachments = { };   // Attachments written by earlier subpasses, bound as DescriptorType::InputAttachment
+        bool DepthTest = true;                          // Uses the DepthAttachment (if there is one), read-only if it's also an input
+    };
+
 	struct RenderpassSpecification
 	{
 	public:
@@ -47,11 +73,20 @@ namespace Hz
 		ImageLayout PreviousColourImageLayout = ImageLayout::Undefined;
 		ImageLayout FinalColourImageLayout = ImageLayout::PresentSrcKHR;
 
+		// Multiple render targets, these follow the ColourAttachment (if there is one) in the fragment shader's output locations.
+		std::vector<ColourAttachmentSpecification> ColourAttachments = { };
+
 		Ref<Image> DepthAttachment = nullptr;
 		LoadOperation DepthLoadOp = LoadOperation::Clear;
         StoreOperation DepthStoreOp = StoreOperation::Store;
 		ImageLayout PreviousDepthImageLayout = ImageLayout::Undefined;
 		ImageLayout FinalDepthImageLayout = ImageLayout::Depth;
+
+		std::vector<SubpassSpecification> Subpasses = { }; // Empty means a single subpass which uses every attachment
+
+		// Multisampling, every attachment needs to have this amount of samples
+		SampleCount Samples = SampleCount::Count1;
+		std::vector<Ref<Image>> ColourResolve = { }; // Resolve targets of the ColourAttachment (usually the swapchain images), these receive the FinalColourImageLayout
 	};
 
     ///////////////////////////////////////////////////////////
@@ -68,10 +103,15 @@ namespace Hz
         virtual void Resize(uint32_t width, uint32_t height) = 0;
 
         virtual std::pair<uint32_t, uint32_t> GetSize() const = 0;
+        virtual uint32_t GetColourAttachmentCount() const = 0;
+        virtual uint32_t GetColourAttachmentCount(uint32_t subpass) const = 0; // Colour attachments written by the subpass
+        virtual uint32_t GetSubpassCount() const = 0;
 
 		virtual const RenderpassSpecification& GetSpecification() = 0;
 		virtual Ref<CommandBuffer> GetCommandBuffer() = 0;
 
+        inline PassStatistics GetStatistics() { return GetCommandBuffer()->GetStatistics(); }
+
         static Ref<Renderpass> Create(const RenderpassSpecification& specs, Ref<CommandBuffer> commandBuffer = nullptr);
     };
 
@@ -0,0 +1,30 @@
+#include "hzpch.h"
+#include "StreamedImage.hpp"
+
+#include "Horizon/Core/Logging.hpp"
+
+#include "Horizon/Vulkan/VulkanStreamedImage.hpp"
+
+namespace Hz
+{
+
+	///////////////////////////////////////////////////////////
+	// Specifications
+	///////////////////////////////////////////////////////////
+    StreamedImageSpecification::StreamedImageSpecification(const std::filesystem::path& path, uint32_t tailSize)
+        : Path(path), TailSize(tailSize)
+    {
+    }
+
+	///////////////////////////////////////////////////////////
+	// Core class
+	///////////////////////////////////////////////////////////
+    Ref<StreamedImage> StreamedImage::Create(const StreamedImageSpecification& specs, const SamplerSpecification& samplerSpecs)
+    {
+        if constexpr (RendererSpecification::API == RenderingAPI::Vulkan)
+            return Ref<VulkanStreamedImage>::Create(specs, samplerSpecs);
+
+        return nullptr;
+    }
+
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Horizon/Core/Core.hpp"
+
+#include "Horizon/Renderer/RendererSpecification.hpp"
+#include "Horizon/Renderer/Image.hpp"
+
+#include <cstdint>
+#include <filesystem>
+
+namespace Hz
+{
+
+    ///////////////////////////////////////////////////////////
+	// Specifications
+	///////////////////////////////////////////////////////////
+    struct StreamedImageSpecification
+    {
+    public:
+        std::filesystem::path Path = {};
+
+        ImageUsageFlags Flags = ImageUsageFlags::Colour | ImageUsageFlags::Sampled;
+        ImageLayout Layout = ImageLayout::ShaderRead;
+
+        uint32_t TailSize = 64; // Mips with a largest side <= TailSize are always resident
+
+    public:
+        StreamedImageSpecification() = default;
+        StreamedImageSpecification(const std::filesystem::path& path, uint32_t tailSize = 64);
+        ~StreamedImageSpecification() = default;
+    };
+
+	///////////////////////////////////////////////////////////
+    // Core class
+	///////////////////////////////////////////////////////////
+    // Note: A file image of which only the lower mips are resident, higher mips get paged in asynchronously
+    // when requested and evicted again when the streaming budget (Renderer::SetStreamingBudget) is exceeded.
+    class StreamedImage : public RefCounted
+    {
+    public:
+        StreamedImage() = default;
+        virtual ~StreamedImage() = default;
+
+        virtual void RequestMip(uint32_t mip) = 0;          // Most detailed mip needed, 0 is full resolution
+        virtual void RequestCoverage(uint32_t pixels) = 0;  // On-screen size (in pixels) of the image's largest side
+
+        virtual uint32_t GetResidentMip() const = 0;        // Most detailed mip currently resident, GetMipLevels() while the file is still being decoded
+        virtual uint32_t GetMipLevels() const = 0;          // Mips of the full resolution image
+
+        virtual uint32_t GetWidth() const = 0;              // Full resolution width
+        virtual uint32_t GetHeight() const = 0;             // Full resolution height
+
+        // Note: The returned image always contains the resident mips (mip 0 of the image is GetResidentMip()),
+        // upload it to descriptor sets as usual, they get patched when the residency changes.
+        virtual Ref<Image> GetImage() const = 0;
+
+        static Ref<StreamedImage> Create(const StreamedImageSpecification& specs, const SamplerSpecification& samplerSpecs = {});
+    };
+
+}
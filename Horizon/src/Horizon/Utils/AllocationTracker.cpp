@@ -0,0 +1,351 @@
+#include "hzpch.h"
+#include "AllocationTracker.hpp"
+
+#include "Horizon/Core/Logging.hpp"
+
+#include <new>
+#include <cstdlib>
+#include <cstddef>
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+    #define HZ_RETURN_ADDRESS() _ReturnAddress()
+#else
+    #define HZ_RETURN_ADDRESS() __builtin_return_address(0)
+#endif
+
+// Note: Tracy may only be used when it's actually compiled in
+#if defined(TRACY_ENABLE) && !defined(HZ_DIST) && HZ_ENABLE_PROFILING
+    #define HZ_TRACY_MEMORY 1
+#else
+    #define HZ_TRACY_MEMORY 0
+#endif
+
+namespace
+{
+
+    // Note: Sits right in front of every allocation
+    struct alignas(std::max_align_t) Header
+    {
+    public:
+        size_t Size;
+        uint32_t Offset;    // From the start of the malloc'd block to the user pointer
+        Hz::AllocationTag Tag;
+        bool Reported;      // Whether Tracy knows about this allocation
+    };
+
+    thread_local bool t_InTracy = false; // Note: Guards against Tracy allocating from within our operator new
+
+}
+
+namespace Hz
+{
+
+    ///////////////////////////////////////////////////////////
+    // Scope
+    ///////////////////////////////////////////////////////////
+    AllocationTracker::Scope::Scope(AllocationTag tag)
+        : m_Previous(s_Tag)
+    {
+        s_Tag = tag;
+    }
+
+    AllocationTracker::Scope::~Scope()
+    {
+        s_Tag = m_Previous;
+    }
+
+    ///////////////////////////////////////////////////////////
+    // Core class
+    ///////////////////////////////////////////////////////////
+    void AllocationTracker::NewFrame()
+    {
+        std::scoped_lock<std::mutex> lock(s_Data.FrameMutex);
+
+        // Note: Tracy is guaranteed to be initialized once the frame loop runs
+        if (!s_Data.ShutDown)
+            s_Data.ReportToTracy.store(true, std::memory_order_relaxed);
+
+        AllocationStatistics statistics = {};
+        statistics.Frame = s_Data.LastFrame.Frame + 1;
+
+        for (size_t i = 0; i < statistics.Tags.size(); i++)
+        {
+            TagCounters& counters = s_Data.Tags[i];
+            AllocationTagStatistics& tag = statistics.Tags[i];
+
+            tag.FrameAllocations = counters.FrameAllocations.exchange(0, std::memory_order_relaxed);
+            tag.FrameBytes = counters.FrameBytes.exchange(0, std::memory_order_relaxed);
+            tag.LiveAllocations = counters.LiveAllocations.load(std::memory_order_relaxed);
+            tag.LiveBytes = counters.LiveBytes.load(std::memory_order_relaxed);
+            tag.TotalAllocations = counters.TotalAllocations.load(std::memory_order_relaxed);
+
+            statistics.FrameAllocations += tag.FrameAllocations;
+            statistics.FrameBytes += tag.FrameBytes;
+        }
+
+        s_Data.LastFrame = statistics;
+
+        HZ_PROFILE_PLOT("Allocations", (int64_t)statistics.FrameAllocations);
+
+        if (!s_Data.SteadyStateCheck || statistics.Frame <= s_Data.SteadyStateStart + s_Data.SteadyState.WarmupFrames || statistics.FrameAllocations == 0)
+            return;
+
+        s_Data.SteadyStateViolated.store(true, std::memory_order_relaxed);
+
+        HZ_LOG_ERROR("Steady state frame {0} made {1} heap allocation(s) ({2} bytes):", statistics.Frame, statistics.FrameAllocations, statistics.FrameBytes);
+        for (size_t i = 0; i < statistics.Tags.size(); i++)
+        {
+            if (statistics.Tags[i].FrameAllocations > 0)
+                HZ_LOG_ERROR("    {0}: {1} allocation(s), {2} bytes", GetTagName((AllocationTag)i), statistics.Tags[i].FrameAllocations, statistics.Tags[i].FrameBytes);
+        }
+
+        auto callSites = GetCallSites();
+        for (size_t i = 0; i < std::min<size_t>(callSites.size(), 8); i++)
+            HZ_LOG_ERROR("    Call site {0}: {1} sample(s), {2} bytes ({3})", callSites[i].Address, callSites[i].Samples, callSites[i].Bytes, GetTagName(callSites[i].Tag));
+
+        if (s_Data.SteadyState.Abort)
+            std::abort();
+
+        // Note: Our own logging shouldn't count towards the next frame
+        for (auto& counters : s_Data.Tags)
+        {
+            counters.FrameAllocations.store(0, std::memory_order_relaxed);
+            counters.FrameBytes.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void AllocationTracker::Shutdown()
+    {
+        std::scoped_lock<std::mutex> lock(s_Data.FrameMutex);
+
+        s_Data.ShutDown = true;
+        s_Data.ReportToTracy.store(false, std::memory_order_relaxed);
+    }
+
+    AllocationStatistics AllocationTracker::GetStatistics()
+    {
+        std::scoped_lock<std::mutex> lock(s_Data.FrameMutex);
+        return s_Data.LastFrame;
+    }
+
+    std::vector<AllocationCallSite> AllocationTracker::GetCallSites()
+    {
+        std::vector<AllocationCallSite> callSites = { };
+
+        for (const auto& site : s_Data.CallSites)
+        {
+            uintptr_t address = site.Address.load(std::memory_order_acquire);
+            if (address == 0)
+                continue;
+
+            AllocationCallSite& callSite = callSites.emplace_back();
+            callSite.Address = reinterpret_cast<void*>(address);
+            callSite.Tag = (AllocationTag)site.Tag.load(std::memory_order_relaxed);
+            callSite.Samples = site.Samples.load(std::memory_order_relaxed);
+            callSite.Bytes = site.Bytes.load(std::memory_order_relaxed);
+        }
+
+        std::sort(callSites.begin(), callSites.end(), [](const AllocationCallSite& a, const AllocationCallSite& b) { return a.Bytes > b.Bytes; });
+        return callSites;
+    }
+
+    void AllocationTracker::EnableSteadyStateCheck(const SteadyStateSpecification& specs)
+    {
+        if constexpr (!Enabled())
+            HZ_LOG_WARN("The steady state check requires HZ_MEM_PROFILING, no allocations will be tracked.");
+
+        std::scoped_lock<std::mutex> lock(s_Data.FrameMutex);
+
+        s_Data.SteadyStateCheck = true;
+        s_Data.SteadyState = specs;
+        s_Data.SteadyStateStart = s_Data.LastFrame.Frame;
+        s_Data.SteadyStateViolated.store(false, std::memory_order_relaxed);
+    }
+
+    void AllocationTracker::DisableSteadyStateCheck()
+    {
+        std::scoped_lock<std::mutex> lock(s_Data.FrameMutex);
+        s_Data.SteadyStateCheck = false;
+    }
+
+    bool AllocationTracker::SteadyStateViolated()
+    {
+        return s_Data.SteadyStateViolated.load(std::memory_order_relaxed);
+    }
+
+    const char* AllocationTracker::GetTagName(AllocationTag tag)
+    {
+        switch (tag)
+        {
+        case AllocationTag::User:       return "User";
+        case AllocationTag::Core:       return "Core";
+        case AllocationTag::Renderer:   return "Renderer";
+        case AllocationTag::Vulkan:     return "Vulkan";
+
+        default:
+            break;
+        }
+
+        return "Unknown";
+    }
+
+    void* AllocationTracker::Allocate(size_t size, size_t alignment, void* callSite)
+    {
+        // Note: Over-aligned allocations need some room to shift the user pointer forward
+        size_t padding = (alignment > alignof(std::max_align_t) ? alignment : 0);
+
+        void* block = std::malloc(sizeof(Header) + padding + size);
+        if (!block)
+            return nullptr;
+
+        uintptr_t user = reinterpret_cast<uintptr_t>(block) + sizeof(Header);
+        if (padding > 0)
+            user = (user + alignment - 1) & ~(uintptr_t)(alignment - 1);
+
+        AllocationTag tag = s_Tag;
+
+        Header* header = reinterpret_cast<Header*>(user) - 1;
+        header->Size = size;
+        header->Offset = (uint32_t)(user - reinterpret_cast<uintptr_t>(block));
+        header->Tag = tag;
+        header->Reported = false;
+
+        TagCounters& counters = s_Data.Tags[(size_t)tag];
+        counters.FrameAllocations.fetch_add(1, std::memory_order_relaxed);
+        counters.FrameBytes.fetch_add(size, std::memory_order_relaxed);
+        counters.LiveAllocations.fetch_add(1, std::memory_order_relaxed);
+        counters.LiveBytes.fetch_add(size, std::memory_order_relaxed);
+        counters.TotalAllocations.fetch_add(1, std::memory_order_relaxed);
+
+        Sample(callSite, tag, size);
+
+        #if HZ_TRACY_MEMORY
+        if (!t_InTracy && s_Data.ReportToTracy.load(std::memory_order_relaxed) && TracyIsConnected)
+        {
+            t_InTracy = true;
+            TracyAllocN(reinterpret_cast<void*>(user), size, GetTagName(tag));
+            t_InTracy = false;
+
+            header->Reported = true;
+        }
+        #endif
+
+        return reinterpret_cast<void*>(user);
+    }
+
+    void AllocationTracker::Free(void* ptr) noexcept
+    {
+        if (!ptr)
+            return;
+
+        Header* header = reinterpret_cast<Header*>(ptr) - 1;
+
+        TagCounters& counters = s_Data.Tags[(size_t)header->Tag];
+        counters.LiveAllocations.fetch_sub(1, std::memory_order_relaxed);
+        counters.LiveBytes.fetch_sub(header->Size, std::memory_order_relaxed);
+
+        #if HZ_TRACY_MEMORY
+        // Note: Only frees of allocations Tracy knows about are reported, and never after shutdown
+        if (header->Reported && !t_InTracy && s_Data.ReportToTracy.load(std::memory_order_relaxed))
+        {
+            t_InTracy = true;
+            TracyFreeN(ptr, GetTagName(header->Tag));
+            t_InTracy = false;
+        }
+        #endif
+
+        std::free(reinterpret_cast<char*>(ptr) - header->Offset);
+    }
+
+    void AllocationTracker::Sample(void* callSite, AllocationTag tag, size_t size)
+    {
+        if (s_Data.Counter.fetch_add(1, std::memory_order_relaxed) % SampleRate != 0)
+            return;
+
+        uintptr_t address = reinterpret_cast<uintptr_t>(callSite);
+        size_t start = (size_t)((address >> 4) * 0x9e3779b97f4a7c15ull);
+
+        // Note: Open addressing with a short probe, when the table is full the sample is dropped
+        for (size_t i = 0; i < 16; i++)
+        {
+            CallSite& site = s_Data.CallSites[(start + i) % MaxCallSites];
+
+            uintptr_t current = site.Address.load(std::memory_order_acquire);
+            if (current == 0)
+            {
+                if (site.Address.compare_exchange_strong(current, address, std::memory_order_acq_rel))
+                {
+                    site.Tag.store((uint8_t)tag, std::memory_order_relaxed);
+                    current = address;
+                }
+            }
+
+            if (current != address)
+                continue;
+
+            site.Samples.fetch_add(1, std::memory_order_relaxed);
+            site.Bytes.fetch_add(size, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+}
+
+///////////////////////////////////////////////////////////
+// Global operators
+///////////////////////////////////////////////////////////
+#if HZ_MEM_PROFILING
+void* operator new(size_t size)
+{
+    void* ptr = Hz::AllocationTracker::Allocate(size, alignof(std::max_align_t), HZ_RETURN_ADDRESS());
+    if (!ptr)
+        throw std::bad_alloc();
+
+    return ptr;
+}
+
+void* operator new[](size_t size)
+{
+    void* ptr = Hz::AllocationTracker::Allocate(size, alignof(std::max_align_t), HZ_RETURN_ADDRESS());
+    if (!ptr)
+        throw std::bad_alloc();
+
+    return ptr;
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    void* ptr = Hz::AllocationTracker::Allocate(size, (size_t)alignment, HZ_RETURN_ADDRESS());
+    if (!ptr)
+        throw std::bad_alloc();
+
+    return ptr;
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+    void* ptr = Hz::AllocationTracker::Allocate(size, (size_t)alignment, HZ_RETURN_ADDRESS());
+    if (!ptr)
+        throw std::bad_alloc();
+
+    return ptr;
+}
+
+// Note: The nothrow versions must use our header as well, since they're freed by our delete
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return Hz::AllocationTracker::Allocate(size, alignof(std::max_align_t), HZ_RETURN_ADDRESS()); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return Hz::AllocationTracker::Allocate(size, alignof(std::max_align_t), HZ_RETURN_ADDRESS()); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return Hz::AllocationTracker::Allocate(size, (size_t)alignment, HZ_RETURN_ADDRESS()); }
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return Hz::AllocationTracker::Allocate(size, (size_t)alignment, HZ_RETURN_ADDRESS()); }
+
+void operator delete(void* ptr) noexcept { Hz::AllocationTracker::Free(ptr); }
+void operator delete[](void* ptr) noexcept { Hz::AllocationTracker::Free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { Hz::AllocationTracker::Free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { Hz::AllocationTracker::Free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { Hz::AllocationTracker::Free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { Hz::AllocationTracker::Free(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { Hz::AllocationTracker::Free(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { Hz::AllocationTracker::Free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { Hz::AllocationTracker::Free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { Hz::AllocationTracker::Free(ptr); }
+#endif
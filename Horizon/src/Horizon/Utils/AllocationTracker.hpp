@@ -0,0 +1,158 @@
+#pragma once
+
+#include "Horizon/Core/Core.hpp"
+
+#include "Horizon/Utils/Profiler.hpp"
+
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <vector>
+
+namespace Hz
+{
+
+    ///////////////////////////////////////////////////////////
+    // Specifications
+    ///////////////////////////////////////////////////////////
+    enum class AllocationTag : uint8_t { User = 0, Core, Renderer, Vulkan, Count };
+
+    struct AllocationTagStatistics
+    {
+    public:
+        uint64_t FrameAllocations = 0;  // Allocations made during the last frame
+        uint64_t FrameBytes = 0;        // Bytes allocated during the last frame
+
+        uint64_t LiveAllocations = 0;
+        uint64_t LiveBytes = 0;
+        uint64_t TotalAllocations = 0;
+    };
+
+    struct AllocationStatistics
+    {
+    public:
+        std::array<AllocationTagStatistics, (size_t)AllocationTag::Count> Tags = { };
+
+        uint64_t Frame = 0;
+        uint64_t FrameAllocations = 0;  // Of all tags combined
+        uint64_t FrameBytes = 0;
+    };
+
+    struct AllocationCallSite
+    {
+    public:
+        void* Address = nullptr;        // Return address of the allocation, symbolize with your debugger/addr2line
+        AllocationTag Tag = AllocationTag::User;
+
+        uint64_t Samples = 0;
+        uint64_t Bytes = 0;             // Bytes of the sampled allocations
+    };
+
+    // Fails (logs & aborts) when a frame after the warmup allocates from the general purpose heap
+    struct SteadyStateSpecification
+    {
+    public:
+        uint32_t WarmupFrames = 120;
+        bool Abort = true;              // When false the violation is only logged & reported by SteadyStateViolated()
+    };
+
+    ///////////////////////////////////////////////////////////
+    // Core class
+    ///////////////////////////////////////////////////////////
+    // Tracks every allocation made through the global operator new (when HZ_MEM_PROFILING is enabled).
+    // Allocations are tagged by the subsystem active on the calling thread, counted per frame and
+    // every SampleRate'th allocation records its call site. When profiling is enabled, allocations are
+    // also sent to Tracy as a memory pool per tag, but only while a Tracy server is connected.
+    // Note: Every allocation carries a small header with its size & tag, so no bookkeeping (or lock) is needed on free.
+    class AllocationTracker
+    {
+    public:
+        // Sets the tag of the calling thread for its lifetime
+        class Scope
+        {
+        public:
+            Scope(AllocationTag tag);
+            ~Scope();
+
+        private:
+            AllocationTag m_Previous;
+        };
+
+    public:
+        static void NewFrame(); // Note: Gets called by the renderer every BeginFrame()
+        static void Shutdown(); // Stops reporting to Tracy, so frees during static destruction don't touch Tracy
+
+        static AllocationStatistics GetStatistics();
+        static std::vector<AllocationCallSite> GetCallSites(); // Sorted by sampled bytes, largest first
+
+        static void EnableSteadyStateCheck(const SteadyStateSpecification& specs = {});
+        static void DisableSteadyStateCheck();
+        static bool SteadyStateViolated();
+
+        static const char* GetTagName(AllocationTag tag);
+        inline static constexpr bool Enabled() { return HZ_MEM_PROFILING; }
+
+        // Note: Used by the global operator new/delete
+        static void* Allocate(size_t size, size_t alignment, void* callSite);
+        static void Free(void* ptr) noexcept;
+
+    private:
+        static void Sample(void* callSite, AllocationTag tag, size_t size);
+
+        struct TagCounters
+        {
+        public:
+            std::atomic<uint64_t> FrameAllocations = 0;
+            std::atomic<uint64_t> FrameBytes = 0;
+
+            std::atomic<uint64_t> LiveAllocations = 0;
+            std::atomic<uint64_t> LiveBytes = 0;
+            std::atomic<uint64_t> TotalAllocations = 0;
+        };
+
+        struct CallSite
+        {
+        public:
+            std::atomic<uintptr_t> Address = 0;
+            std::atomic<uint8_t> Tag = 0;
+
+            std::atomic<uint64_t> Samples = 0;
+            std::atomic<uint64_t> Bytes = 0;
+        };
+
+    public:
+        inline static constexpr const uint64_t SampleRate = 64;       // Every n'th allocation gets its call site recorded
+        inline static constexpr const size_t MaxCallSites = 1024;
+
+    private:
+        // Note: We store our info in a struct, so we can ensure lifetime
+        // of all objects easily while the class remains static.
+        // Nothing in here may allocate, since it's used from within operator new.
+        struct Info
+        {
+        public:
+            std::array<TagCounters, (size_t)AllocationTag::Count> Tags = { };
+            std::array<CallSite, MaxCallSites> CallSites = { };
+            std::atomic<uint64_t> Counter = 0;
+
+            // Note: Only enabled from the first frame onwards, Tracy might not be initialized before
+            std::atomic<bool> ReportToTracy = false;
+            bool ShutDown = false;
+
+            std::mutex FrameMutex = {};
+            AllocationStatistics LastFrame = { };
+
+            bool SteadyStateCheck = false;
+            uint64_t SteadyStateStart = 0;
+            SteadyStateSpecification SteadyState = { };
+            std::atomic<bool> SteadyStateViolated = false;
+        };
+
+        inline static Info s_Data = {};
+        inline static thread_local AllocationTag s_Tag = AllocationTag::User;
+    };
+
+}
+
+// Tags all allocations of the current thread until the end of the scope
+#define HZ_ALLOCATION_TAG(tag) ::Hz::AllocationTracker::Scope hzAllocationTag(tag)
@@ -0,0 +1,246 @@
+#include "hzpch.h"
+#include "FrameTimer.hpp"
+
+#include "Horizon/Core/Logging.hpp"
+
+#include "Horizon/Utils/Profiler.hpp"
+
+#include <cmath>
+#include <iomanip>
+
+namespace Hz
+{
+
+    ///////////////////////////////////////////////////////////
+    // Scope
+    ///////////////////////////////////////////////////////////
+    FrameTimer::Scope::Scope(FramePhase phase)
+        : m_Phase(phase), m_Start(FrameTimer::Now())
+    {
+    }
+
+    FrameTimer::Scope::~Scope()
+    {
+        FrameTimer::Add(m_Phase, FrameTimer::Now() - m_Start);
+    }
+
+    ///////////////////////////////////////////////////////////
+    // Core class
+    ///////////////////////////////////////////////////////////
+    void FrameTimer::BeginFrame()
+    {
+        s_Data.FrameStart = Now();
+    }
+
+    void FrameTimer::EndFrame()
+    {
+        if (s_Data.FrameStart == 0) // Note: BeginFrame was skipped (minimized)
+            return;
+
+        uint64_t total = Now() - s_Data.FrameStart;
+        s_Data.FrameStart = 0;
+
+        std::array<uint64_t, (size_t)FramePhase::Count> phases = { };
+        uint64_t measured = 0;
+        for (size_t i = 0; i < phases.size(); i++)
+        {
+            phases[i] = s_Data.Current[i].exchange(0, std::memory_order_relaxed);
+            if (i != (size_t)FramePhase::Record)
+                measured += phases[i];
+        }
+
+        // Note: Record is whatever isn't covered by the other phases
+        phases[(size_t)FramePhase::Record] += (total > measured ? total - measured : 0);
+
+        uint64_t index = s_Data.Written.load(std::memory_order_relaxed);
+        Slot& slot = s_Data.Slots[index % Capacity];
+
+        slot.Sequence.store(index * 2 + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (size_t i = 0; i < phases.size(); i++)
+            slot.Phases[i].store(phases[i], std::memory_order_relaxed);
+        slot.Total.store(total, std::memory_order_relaxed);
+
+        slot.Sequence.store(index * 2 + 2, std::memory_order_release);
+        s_Data.Written.store(index + 1, std::memory_order_release);
+
+        HZ_PROFILE_PLOT("FenceWait (ms)", (double)phases[(size_t)FramePhase::FenceWait] / 1'000'000.0);
+        HZ_PROFILE_PLOT("Present (ms)", (double)phases[(size_t)FramePhase::Present] / 1'000'000.0);
+    }
+
+    void FrameTimer::Add(FramePhase phase, uint64_t nanoseconds)
+    {
+        s_Data.Current[(size_t)phase].fetch_add(nanoseconds, std::memory_order_relaxed);
+    }
+
+    std::vector<FrameTiming> FrameTimer::GetTimings()
+    {
+        uint64_t written = s_Data.Written.load(std::memory_order_acquire);
+        uint64_t first = (written > Capacity ? written - Capacity : 0);
+
+        std::vector<FrameTiming> timings = { };
+        timings.reserve(written - first);
+
+        for (uint64_t index = first; index < written; index++)
+        {
+            const Slot& slot = s_Data.Slots[index % Capacity];
+
+            uint64_t sequence = slot.Sequence.load(std::memory_order_acquire);
+            if (sequence != index * 2 + 2) // Note: Already being overwritten by a newer frame
+                continue;
+
+            FrameTiming timing = {};
+            timing.Frame = index;
+            for (size_t i = 0; i < timing.Phases.size(); i++)
+                timing.Phases[i] = (double)slot.Phases[i].load(std::memory_order_relaxed) / 1'000'000.0;
+            timing.Total = (double)slot.Total.load(std::memory_order_relaxed) / 1'000'000.0;
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.Sequence.load(std::memory_order_relaxed) != sequence)
+                continue;
+
+            timings.push_back(timing);
+        }
+
+        return timings;
+    }
+
+    FrameTimingSummary FrameTimer::GetSummary()
+    {
+        std::vector<FrameTiming> timings = GetTimings();
+
+        FrameTimingSummary summary = {};
+        summary.FrameCount = (uint32_t)timings.size();
+        if (timings.empty())
+            return summary;
+
+        auto summarize = [&timings](auto&& value) -> FramePhaseSummary
+        {
+            std::vector<double> values(timings.size());
+            std::transform(timings.begin(), timings.end(), values.begin(), value);
+            std::sort(values.begin(), values.end());
+
+            // Note: Nearest-rank percentiles
+            auto percentile = [&values](double p) { return values[(size_t)std::max(std::ceil(p * (double)values.size()), 1.0) - 1]; };
+
+            FramePhaseSummary phase = {};
+            phase.P50 = percentile(0.50);
+            phase.P95 = percentile(0.95);
+            phase.P99 = percentile(0.99);
+            phase.Max = values.back();
+            phase.Average = std::accumulate(values.begin(), values.end(), 0.0) / (double)values.size();
+            return phase;
+        };
+
+        for (size_t i = 0; i < summary.Phases.size(); i++)
+            summary.Phases[i] = summarize([i](const FrameTiming& timing) { return timing.Phases[i]; });
+        summary.Total = summarize([](const FrameTiming& timing) { return timing.Total; });
+
+        return summary;
+    }
+
+    std::string FrameTimer::ToCSV()
+    {
+        std::ostringstream stream;
+        stream << std::fixed << std::setprecision(4);
+
+        stream << "Frame";
+        for (size_t i = 0; i < (size_t)FramePhase::Count; i++)
+            stream << ',' << GetPhaseName((FramePhase)i);
+        stream << ",Total\n";
+
+        for (const auto& timing : GetTimings())
+        {
+            stream << timing.Frame;
+            for (double phase : timing.Phases)
+                stream << ',' << phase;
+            stream << ',' << timing.Total << '\n';
+        }
+
+        return stream.str();
+    }
+
+    std::string FrameTimer::ToJSON()
+    {
+        std::vector<FrameTiming> timings = GetTimings();
+        FrameTimingSummary summary = GetSummary();
+
+        std::ostringstream stream;
+        stream << std::fixed << std::setprecision(4);
+
+        auto writeSummary = [&stream](const FramePhaseSummary& phase)
+        {
+            stream << "{ \"p50\": " << phase.P50 << ", \"p95\": " << phase.P95 << ", \"p99\": " << phase.P99 << ", \"max\": " << phase.Max << ", \"average\": " << phase.Average << " }";
+        };
+
+        stream << "{\n  \"unit\": \"ms\",\n  \"frameCount\": " << summary.FrameCount << ",\n  \"summary\": {\n";
+        for (size_t i = 0; i < summary.Phases.size(); i++)
+        {
+            stream << "    \"" << GetPhaseName((FramePhase)i) << "\": ";
+            writeSummary(summary.Phases[i]);
+            stream << ",\n";
+        }
+        stream << "    \"Total\": ";
+        writeSummary(summary.Total);
+        stream << "\n  },\n  \"frames\": [\n";
+
+        for (size_t f = 0; f < timings.size(); f++)
+        {
+            stream << "    { \"frame\": " << timings[f].Frame;
+            for (size_t i = 0; i < timings[f].Phases.size(); i++)
+                stream << ", \"" << GetPhaseName((FramePhase)i) << "\": " << timings[f].Phases[i];
+            stream << ", \"Total\": " << timings[f].Total << " }" << (f + 1 < timings.size() ? ",\n" : "\n");
+        }
+        stream << "  ]\n}\n";
+
+        return stream.str();
+    }
+
+    bool FrameTimer::WriteCSV(const std::filesystem::path& path)
+    {
+        return WriteFile(path, ToCSV());
+    }
+
+    bool FrameTimer::WriteJSON(const std::filesystem::path& path)
+    {
+        return WriteFile(path, ToJSON());
+    }
+
+    const char* FrameTimer::GetPhaseName(FramePhase phase)
+    {
+        switch (phase)
+        {
+        case FramePhase::FenceWait:     return "FenceWait";
+        case FramePhase::Update:        return "Update";
+        case FramePhase::Acquire:       return "Acquire";
+        case FramePhase::Record:        return "Record";
+        case FramePhase::Submit:        return "Submit";
+        case FramePhase::Present:       return "Present";
+
+        default:
+            break;
+        }
+
+        return "Unknown";
+    }
+
+    uint64_t FrameTimer::Now()
+    {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    bool FrameTimer::WriteFile(const std::filesystem::path& path, const std::string& contents)
+    {
+        std::ofstream file(path);
+        if (!file.is_open())
+        {
+            HZ_LOG_ERROR("Failed to open '{0}' for writing.", path.string());
+            return false;
+        }
+
+        file << contents;
+        return true;
+    }
+
+}
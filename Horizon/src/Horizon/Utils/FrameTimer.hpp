@@ -0,0 +1,125 @@
+#pragma once
+
+#include "Horizon/Core/Core.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <filesystem>
+
+namespace Hz
+{
+
+    ///////////////////////////////////////////////////////////
+    // Specifications
+    ///////////////////////////////////////////////////////////
+    enum class FramePhase : uint8_t
+    {
+        FenceWait = 0,  // Waiting on the GPU to finish the frame in flight we're reusing
+        Update,         // Deferred frees and per-frame renderer updates (streaming, defragmentation, ...)
+        Acquire,        // Acquiring the next swapchain image
+        Record,         // Everything else between BeginFrame & Present, mostly the application recording commands
+        Submit,         // Time spent in queue submissions
+        Present,        // Presenting the swapchain image
+        Count
+    };
+
+    struct FrameTiming
+    {
+    public:
+        uint64_t Frame = 0;
+        std::array<double, (size_t)FramePhase::Count> Phases = { }; // In milliseconds
+        double Total = 0.0;                                          // In milliseconds, from BeginFrame to the end of Present
+    };
+
+    struct FramePhaseSummary
+    {
+    public:
+        double P50 = 0.0;
+        double P95 = 0.0;
+        double P99 = 0.0;
+        double Max = 0.0;
+        double Average = 0.0;
+    };
+
+    struct FrameTimingSummary
+    {
+    public:
+        uint32_t FrameCount = 0;
+        std::array<FramePhaseSummary, (size_t)FramePhase::Count> Phases = { };
+        FramePhaseSummary Total = { };
+    };
+
+    ///////////////////////////////////////////////////////////
+    // Core class
+    ///////////////////////////////////////////////////////////
+    // Records how long every frame spends in each FramePhase, so CPU stalls on the GPU (fence wait, acquire, present)
+    // can be told apart from our own CPU work. The last Capacity frames are kept in a lock-free ring buffer,
+    // it can be read (summarized/exported) from any thread while the renderer keeps writing to it.
+    class FrameTimer
+    {
+    public:
+        // Adds the duration of its lifetime to the phase of the current frame
+        class Scope
+        {
+        public:
+            Scope(FramePhase phase);
+            ~Scope();
+
+        private:
+            FramePhase m_Phase;
+            uint64_t m_Start;
+        };
+
+    public:
+        // Note: Called by the renderer, BeginFrame & EndFrame must be called from the same thread
+        static void BeginFrame();
+        static void EndFrame();
+        static void Add(FramePhase phase, uint64_t nanoseconds); // Can be called from any thread
+
+        static std::vector<FrameTiming> GetTimings(); // Oldest frame first
+        static FrameTimingSummary GetSummary();
+
+        static std::string ToCSV();
+        static std::string ToJSON(); // Contains the summary & all frames
+        static bool WriteCSV(const std::filesystem::path& path);
+        static bool WriteJSON(const std::filesystem::path& path);
+
+        static const char* GetPhaseName(FramePhase phase);
+
+    private:
+        static uint64_t Now();
+        static bool WriteFile(const std::filesystem::path& path, const std::string& contents);
+
+        // Note: Every value is atomic and the sequence tells whether the slot was
+        // overwritten while reading (a seqlock), so readers never block the renderer.
+        struct Slot
+        {
+        public:
+            std::atomic<uint64_t> Sequence = 0; // Odd while being written
+            std::array<std::atomic<uint64_t>, (size_t)FramePhase::Count> Phases = { };
+            std::atomic<uint64_t> Total = 0;
+        };
+
+    public:
+        inline static constexpr const uint64_t Capacity = 1024; // Frames kept around
+
+    private:
+        // Note: We store our info in a struct, so we can ensure lifetime
+        // of all objects easily while the class remains static.
+        struct Info
+        {
+        public:
+            std::array<Slot, Capacity> Slots = { };
+            std::atomic<uint64_t> Written = 0;
+
+            std::array<std::atomic<uint64_t>, (size_t)FramePhase::Count> Current = { }; // In nanoseconds
+            uint64_t FrameStart = 0;
+        };
+
+        inline static Info s_Data = {};
+    };
+
+}
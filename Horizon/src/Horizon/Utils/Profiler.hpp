@@ -6,24 +6,25 @@
 #include <new>
 #include <cstdlib>
 
-// Note: Profiling leaks memory, so don't keep on during any real tests. // TODO: Fix
 #define HZ_ENABLE_PROFILING 1
+// Note: Replaces the global operator new/delete with the AllocationTracker (Utils/AllocationTracker.hpp),
+// allocations are only sent to Tracy while a server is connected.
 #define HZ_MEM_PROFILING 0
 
 #if !defined(HZ_DIST) && HZ_ENABLE_PROFILING
 
 #define HZ_MARK_FRAME() FrameMark
 #define HZ_PROFILE_SCOPE(name) ZoneScopedN(name)
-
-#if HZ_MEM_PROFILING
-void* operator new(size_t size);
-void operator delete(void* ptr) noexcept;
-void operator delete(void* ptr, size_t size) noexcept;
-#endif
+#define HZ_PROFILE_SCOPE_DYNAMIC(name) ZoneTransientN(hzTransientZone, name, true) // Note: name may be any string, it gets copied
+#define HZ_PROFILE_THREAD(name) TracyCSetThreadName(name)
+#define HZ_PROFILE_PLOT(name, value) TracyPlot(name, value) // Note: name needs to be a string literal (or have a static lifetime)
 
 #else
 
 #define HZ_MARK_FRAME()
 #define HZ_PROFILE_SCOPE(name)
+#define HZ_PROFILE_SCOPE_DYNAMIC(name)
+#define HZ_PROFILE_THREAD(name)
+#define HZ_PROFILE_PLOT(name, value)
 
 #endif
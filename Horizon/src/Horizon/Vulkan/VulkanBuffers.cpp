@@ -2,6 +2,7 @@
 #include "VulkanBuffers.hpp"
 
 #include "Horizon/Core/Logging.hpp"
+#include "Horizon/Core/FrameAllocator.hpp"
 
 #include "Horizon/Renderer/Renderer.hpp"
 #include "Horizon/Renderer/Descriptors.hpp"
@@ -37,10 +38,44 @@ namespace Hz
 		return VK_FORMAT_UNDEFINED;
 	}
 
+    static VkBufferUsageFlags GetVertexPullingUsageFlags(const BufferSpecification& specs)
+    {
+        VkBufferUsageFlags flags = 0;
+
+        if (specs.StorageAccess)
+            flags |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+        if (specs.DeviceAddress)
+        {
+            HZ_ASSERT(VulkanContext::GetPhysicalDevice()->SupportsBufferDeviceAddress(), "Requested a buffer device address, but the device doesn't support bufferDeviceAddress.");
+            flags |= VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+        }
+
+        return flags;
+    }
+
+    // Note: Creates a new buffer in dstAllocation, copies the contents and swaps it with buffer.
+    static FreeFunction MoveBuffer(VkCommandBuffer cmdBuf, VmaAllocation dstAllocation, VkBuffer& buffer, VkDeviceSize size, VkBufferUsageFlags usage)
+    {
+        VkBuffer newBuffer = VkUtils::Allocator::CreateBoundBuffer(size, usage, dstAllocation);
+
+        VkBufferCopy copyRegion = {};
+        copyRegion.size = size;
+        vkCmdCopyBuffer(cmdBuf, buffer, newBuffer, 1, &copyRegion);
+
+        VkBuffer oldBuffer = buffer;
+        buffer = newBuffer;
+
+        // Note: The memory is owned by the defragmenter, so we only destroy the handle
+        return [oldBuffer]() { vkDestroyBuffer(VulkanContext::GetDevice()->GetVkDevice(), oldBuffer, nullptr); };
+    }
+
     VulkanVertexBuffer::VulkanVertexBuffer(const BufferSpecification &specs, void *data, size_t size)
         : m_BufferSize(size)
     {
-        m_Allocation = VkUtils::Allocator::AllocateBuffer(m_BufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, (VmaMemoryUsage)specs.Usage, m_Buffer);
+        m_Usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | GetVertexPullingUsageFlags(specs);
+        m_Allocation = VkUtils::Allocator::AllocateBuffer(m_BufferSize, m_Usage, (VmaMemoryUsage)specs.Usage, m_Buffer);
+        if (specs.DeviceAddress)
+            m_DeviceAddress = VkUtils::Allocator::GetBufferDeviceAddress(m_Buffer);
 
 		VkBuffer stagingBuffer = VK_NULL_HANDLE;
 		VmaAllocation stagingBufferAllocation = VK_NULL_HANDLE;
@@ -53,10 +88,15 @@ namespace Hz
 
 		VkUtils::Allocator::CopyBuffer(stagingBuffer, m_Buffer, m_BufferSize);
 		VkUtils::Allocator::DestroyBuffer(stagingBuffer, stagingBufferAllocation);
+
+        if (specs.Usage == BufferMemoryUsage::GPU)
+            VulkanDefragmenter::Register(m_Allocation, this);
     }
 
     VulkanVertexBuffer::~VulkanVertexBuffer()
     {
+        VulkanDefragmenter::Unregister(m_Allocation, this);
+
         Renderer::Free([buffer = m_Buffer, allocation = m_Allocation]()
         {
             if (buffer != VK_NULL_HANDLE)
@@ -69,17 +109,17 @@ namespace Hz
         Ref<VulkanCommandBuffer> vkCmdBuf = commandBuffer.As<VulkanCommandBuffer>();
 
         VkDeviceSize offsets[] = { 0 };
-		vkCmdBindVertexBuffers(vkCmdBuf->GetVkCommandBuffer(Renderer::GetCurrentFrame()), 0, 1, &m_Buffer, offsets);
+        vkCmdBuf->BindVertexBuffers({ &m_Buffer, 1 }, offsets);
     }
 
     void VulkanVertexBuffer::Bind(Ref<CommandBuffer> commandBuffer, std::vector<Ref<VertexBuffer>>&& buffers)
     {
         Ref<VulkanCommandBuffer> vkCmdBuf = commandBuffer.As<VulkanCommandBuffer>();
 
-        std::vector<VkBuffer> vkBuffers;
+        InlineVector<VkBuffer, 8> vkBuffers = { };
         vkBuffers.reserve(buffers.size());
 
-        std::vector<VkDeviceSize> offsets(buffers.size(), 0);
+        InlineVector<VkDeviceSize, 8> offsets(buffers.size(), 0);
 
         for (auto& buffer : buffers)
         {
@@ -87,14 +127,28 @@ namespace Hz
             vkBuffers.push_back(vkVertexBuffer->m_Buffer);
         }
 
-        vkCmdBindVertexBuffers(vkCmdBuf->GetVkCommandBuffer(Renderer::GetCurrentFrame()), 0, static_cast<uint32_t>(vkBuffers.size()), vkBuffers.data(), offsets.data());
+        vkCmdBuf->BindVertexBuffers({ vkBuffers.data(), vkBuffers.size() }, { offsets.data(), offsets.size() });
+    }
+
+    uint64_t VulkanVertexBuffer::GetDeviceAddress() const
+    {
+        HZ_ASSERT((m_DeviceAddress != 0), "Tried to retrieve device address of a VertexBuffer created without BufferSpecification::DeviceAddress.");
+        return (uint64_t)m_DeviceAddress;
+    }
+
+    FreeFunction VulkanVertexBuffer::Move(VkCommandBuffer cmdBuf, VmaAllocation dstAllocation)
+    {
+        return MoveBuffer(cmdBuf, dstAllocation, m_Buffer, (VkDeviceSize)m_BufferSize, m_Usage);
     }
 
     VulkanIndexBuffer::VulkanIndexBuffer(const BufferSpecification& specs, uint32_t* indices, uint32_t count)
         : m_Count(count)
     {
 		VkDeviceSize bufferSize = sizeof(uint32_t) * count;
-		m_Allocation = VkUtils::Allocator::AllocateBuffer(bufferSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, (VmaMemoryUsage)specs.Usage, m_Buffer);
+        m_Usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | GetVertexPullingUsageFlags(specs);
+		m_Allocation = VkUtils::Allocator::AllocateBuffer(bufferSize, m_Usage, (VmaMemoryUsage)specs.Usage, m_Buffer);
+        if (specs.DeviceAddress)
+            m_DeviceAddress = VkUtils::Allocator::GetBufferDeviceAddress(m_Buffer);
 
 		VkBuffer stagingBuffer = VK_NULL_HANDLE;
 		VmaAllocation stagingBufferAllocation = VK_NULL_HANDLE;
@@ -107,10 +161,15 @@ namespace Hz
 
 		VkUtils::Allocator::CopyBuffer(stagingBuffer, m_Buffer, bufferSize);
 		VkUtils::Allocator::DestroyBuffer(stagingBuffer, stagingBufferAllocation);
+
+        if (specs.Usage == BufferMemoryUsage::GPU)
+            VulkanDefragmenter::Register(m_Allocation, this);
     }
 
     VulkanIndexBuffer::~VulkanIndexBuffer()
     {
+        VulkanDefragmenter::Unregister(m_Allocation, this);
+
         Renderer::Free([buffer = m_Buffer, allocation = m_Allocation]()
         {
             if (buffer != VK_NULL_HANDLE)
@@ -122,10 +181,22 @@ namespace Hz
     {
         Ref<VulkanCommandBuffer> vkCmdBuf = commandBuffer.As<VulkanCommandBuffer>();
 
-		vkCmdBindIndexBuffer(vkCmdBuf->GetVkCommandBuffer(Renderer::GetCurrentFrame()), m_Buffer, 0, VK_INDEX_TYPE_UINT32);
+        vkCmdBuf->BindIndexBuffer(m_Buffer, VK_INDEX_TYPE_UINT32);
+    }
+
+    uint64_t VulkanIndexBuffer::GetDeviceAddress() const
+    {
+        HZ_ASSERT((m_DeviceAddress != 0), "Tried to retrieve device address of an IndexBuffer created without BufferSpecification::DeviceAddress.");
+        return (uint64_t)m_DeviceAddress;
+    }
+
+    FreeFunction VulkanIndexBuffer::Move(VkCommandBuffer cmdBuf, VmaAllocation dstAllocation)
+    {
+        return MoveBuffer(cmdBuf, dstAllocation, m_Buffer, (VkDeviceSize)(sizeof(uint32_t) * m_Count), m_Usage);
     }
 
     VulkanUniformBuffer::VulkanUniformBuffer(const BufferSpecification& specs, size_t dataSize)
+        : m_Size(dataSize)
     {
         const size_t framesInFlight = (size_t)Renderer::GetSpecification().Buffers;
 		m_Buffers.resize(framesInFlight);
@@ -163,13 +234,20 @@ namespace Hz
     }
 
     VulkanStorageBuffer::VulkanStorageBuffer(const BufferSpecification& specs, size_t dataSize)
+        : m_Size(dataSize)
     {
         const size_t framesInFlight = (size_t)Renderer::GetSpecification().Buffers;
 		m_Buffers.resize(framesInFlight);
 		m_Allocations.resize(framesInFlight);
+		m_DeviceAddresses.resize(framesInFlight, 0);
 
 		for (size_t i = 0; i < framesInFlight; i++)
-			m_Allocations[i] = VkUtils::Allocator::AllocateBuffer((VkDeviceSize)dataSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, (VmaMemoryUsage)specs.Usage, m_Buffers[i], VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+        {
+			m_Allocations[i] = VkUtils::Allocator::AllocateBuffer((VkDeviceSize)dataSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | GetVertexPullingUsageFlags(specs), (VmaMemoryUsage)specs.Usage, m_Buffers[i], VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+
+            if (specs.DeviceAddress)
+                m_DeviceAddresses[i] = VkUtils::Allocator::GetBufferDeviceAddress(m_Buffers[i]);
+        }
 	}
 
     VulkanStorageBuffer::~VulkanStorageBuffer()
@@ -199,4 +277,11 @@ namespace Hz
 		}
     }
 
+    uint64_t VulkanStorageBuffer::GetDeviceAddress() const
+    {
+        VkDeviceAddress address = m_DeviceAddresses[Renderer::GetCurrentFrame()];
+        HZ_ASSERT((address != 0), "Tried to retrieve device address of a StorageBuffer created without BufferSpecification::DeviceAddress.");
+        return (uint64_t)address;
+    }
+
 }
@@ -5,6 +5,8 @@
 #include "Horizon/Renderer/RendererSpecification.hpp"
 #include "Horizon/Renderer/Buffers.hpp"
 
+#include "Horizon/Vulkan/VulkanDefragmenter.hpp"
+
 #include <vulkan/vulkan.h>
 #include <vma/vk_mem_alloc.h>
 
@@ -15,7 +17,7 @@ namespace Hz
 
     VkFormat DataTypeToVkFormat(DataType type);
 
-	class VulkanVertexBuffer : public VertexBuffer
+	class VulkanVertexBuffer : public VertexBuffer, public VulkanMovable
 	{
 	public:
 		VulkanVertexBuffer(const BufferSpecification& specs, void* data, size_t size);
@@ -24,14 +26,25 @@ namespace Hz
 		void Bind(Ref<CommandBuffer> commandBuffer) const override;
 		static void Bind(Ref<CommandBuffer> commandBuffer, std::vector<Ref<VertexBuffer>>&& buffers);
 
+        inline size_t GetSize() const override { return m_BufferSize; }
+        uint64_t GetDeviceAddress() const override;
+
+        inline const VkBuffer GetVkBuffer() const { return m_Buffer; }
+
+        // Defragmentation
+        FreeFunction Move(VkCommandBuffer cmdBuf, VmaAllocation dstAllocation) override;
+        inline bool CanMove() const override { return m_DeviceAddress == 0; } // Note: Device addresses might have been stored by the user
+
 	private:
 		VkBuffer m_Buffer = VK_NULL_HANDLE;
 		VmaAllocation m_Allocation = VK_NULL_HANDLE;
+        VkBufferUsageFlags m_Usage = 0;
+        VkDeviceAddress m_DeviceAddress = 0;
 
 		size_t m_BufferSize;
 	};
 
-	class VulkanIndexBuffer : public IndexBuffer
+	class VulkanIndexBuffer : public IndexBuffer, public VulkanMovable
 	{
 	public:
 		VulkanIndexBuffer(const BufferSpecification& specs, uint32_t* indices, uint32_t count);
@@ -40,10 +53,19 @@ namespace Hz
 		void Bind(Ref<CommandBuffer> commandBuffer) const override;
 
 		inline uint32_t GetCount() const override { return m_Count; }
+        uint64_t GetDeviceAddress() const override;
+
+        inline const VkBuffer GetVkBuffer() const { return m_Buffer; }
+
+        // Defragmentation
+        FreeFunction Move(VkCommandBuffer cmdBuf, VmaAllocation dstAllocation) override;
+        inline bool CanMove() const override { return m_DeviceAddress == 0; } // Note: Device addresses might have been stored by the user
 
 	private:
 		VkBuffer m_Buffer = VK_NULL_HANDLE;
 		VmaAllocation m_Allocation = VK_NULL_HANDLE;
+        VkBufferUsageFlags m_Usage = 0;
+        VkDeviceAddress m_DeviceAddress = 0;
 
 		uint32_t m_Count;
 	};
@@ -108,10 +130,12 @@ namespace Hz
 		void SetData(void* data, size_t size, size_t offset) override;
 
 		inline size_t GetSize() const override { return m_Size; }
+        uint64_t GetDeviceAddress() const override;
 
 	private:
 		std::vector<VkBuffer> m_Buffers = { };
 		std::vector<VmaAllocation> m_Allocations = { };
+        std::vector<VkDeviceAddress> m_DeviceAddresses = { };
 
 		size_t m_Size;
 
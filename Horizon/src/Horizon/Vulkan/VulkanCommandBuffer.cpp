@@ -10,11 +10,25 @@
 #include "Horizon/Vulkan/VulkanUtils.hpp"
 #include "Horizon/Vulkan/VulkanContext.hpp"
 #include "Horizon/Vulkan/VulkanRenderer.hpp"
+#include "Horizon/Vulkan/VulkanGpuProfiler.hpp"
 
 namespace Hz
 {
 
+	static VkCommandPool CreateCommandPool(VkCommandPoolCreateFlags flags)
+	{
+		VkCommandPoolCreateInfo poolInfo = {};
+		poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		poolInfo.flags = flags;
+		poolInfo.queueFamilyIndex = VulkanContext::GetDevice()->GetGraphicsFamily();
+
+		VkCommandPool commandPool = VK_NULL_HANDLE;
+		VK_CHECK_RESULT(vkCreateCommandPool(VulkanContext::GetDevice()->GetVkDevice(), &poolInfo, nullptr, &commandPool));
+		return commandPool;
+	}
+
 	VulkanCommandBuffer::VulkanCommandBuffer()
+		: m_CommandPool(CreateCommandPool(VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT))
 	{
 		auto device = VulkanContext::GetDevice()->GetVkDevice();
 		const uint32_t framesInFlight = (uint32_t)Renderer::GetSpecification().Buffers;
@@ -22,7 +36,7 @@ namespace Hz
 
 		VkCommandBufferAllocateInfo allocInfo = {};
 		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-		allocInfo.commandPool = VulkanContext::GetSwapChain()->GetVkCommandPool();
+		allocInfo.commandPool = m_CommandPool;
 		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
 		allocInfo.commandBufferCount = (uint32_t)m_CommandBuffers.size();
 
@@ -47,11 +61,13 @@ namespace Hz
 
 	VulkanCommandBuffer::~VulkanCommandBuffer()
     {
-        Renderer::Free([commandBuffers = m_CommandBuffers, renderFinishedSemaphores = m_RenderFinishedSemaphores, inFlightFences = m_InFlightFences]()
+        Renderer::Free([commandPool = m_CommandPool, commandBuffers = m_CommandBuffers, renderFinishedSemaphores = m_RenderFinishedSemaphores, inFlightFences = m_InFlightFences]()
         {
             auto device = VulkanContext::GetDevice()->GetVkDevice();
 
-            vkFreeCommandBuffers(VulkanContext::GetDevice()->GetVkDevice(), VulkanContext::GetSwapChain()->GetVkCommandPool(), static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
+            // Note: Destroying the pool frees its command buffers
+            VulkanGpuProfiler::Forget(commandBuffers);
+            vkDestroyCommandPool(device, commandPool, nullptr);
 
             for (size_t i = 0; i < renderFinishedSemaphores.size(); i++)
             {
@@ -69,14 +85,143 @@ namespace Hz
         });
 	}
 
+	PassStatistics VulkanCommandBuffer::GetStatistics() const
+	{
+		return VulkanGpuProfiler::GetPassStatistics(m_CommandBuffers);
+	}
+
+	void VulkanCommandBuffer::BindPipeline(VkPipelineBindPoint bindPoint, VkPipeline pipeline)
+	{
+		bool tracked = ((uint32_t)bindPoint < m_Bound.Pipelines.size());
+		if (tracked && m_Bound.Pipelines[bindPoint] == pipeline)
+		{
+			m_Counters.ElidedPipelineBinds++;
+			return;
+		}
+
+		vkCmdBindPipeline(m_CommandBuffers[m_RecordingFrame], bindPoint, pipeline);
+		m_Counters.PipelineBinds++;
+
+		if (tracked)
+			m_Bound.Pipelines[bindPoint] = pipeline;
+	}
+
+	void VulkanCommandBuffer::BindDescriptorSet(VkPipelineBindPoint bindPoint, VkPipelineLayout layout, uint32_t setID, VkDescriptorSet set, std::span<const uint32_t> dynamicOffsets)
+	{
+		bool tracked = ((uint32_t)bindPoint < m_Bound.Sets.size() && setID < BoundState::MaxDescriptorSets && dynamicOffsets.size() <= BoundState::MaxDynamicOffsets);
+		if (tracked)
+		{
+			BoundState::Set& bound = m_Bound.Sets[bindPoint][setID];
+			if (bound.Handle == set && bound.Layout == layout && bound.DynamicOffsetCount == dynamicOffsets.size() &&
+				std::equal(dynamicOffsets.begin(), dynamicOffsets.end(), bound.DynamicOffsets.begin()))
+			{
+				m_Counters.ElidedDescriptorBinds++;
+				return;
+			}
+		}
+
+		vkCmdBindDescriptorSets(m_CommandBuffers[m_RecordingFrame], bindPoint, layout, setID, 1, &set, (uint32_t)dynamicOffsets.size(), dynamicOffsets.data());
+		m_Counters.DescriptorBinds++;
+
+		if ((uint32_t)bindPoint >= m_Bound.Sets.size() || setID >= BoundState::MaxDescriptorSets)
+			return;
+
+		// Note: Binding with a different layout may disturb the other sets, so we stop trusting those
+		auto& sets = m_Bound.Sets[bindPoint];
+		for (uint32_t i = 0; i < BoundState::MaxDescriptorSets; i++)
+		{
+			if (i != setID && sets[i].Layout != layout)
+				sets[i] = {};
+		}
+
+		BoundState::Set& bound = sets[setID];
+		bound = {};
+		if (tracked)
+		{
+			bound.Handle = set;
+			bound.Layout = layout;
+			bound.DynamicOffsetCount = (uint32_t)dynamicOffsets.size();
+			std::copy(dynamicOffsets.begin(), dynamicOffsets.end(), bound.DynamicOffsets.begin());
+		}
+	}
+
+	void VulkanCommandBuffer::BindVertexBuffers(std::span<const VkBuffer> buffers, std::span<const VkDeviceSize> offsets)
+	{
+		bool tracked = (buffers.size() <= BoundState::MaxVertexBuffers);
+		if (tracked && std::equal(buffers.begin(), buffers.end(), m_Bound.VertexBuffers.begin()) && std::equal(offsets.begin(), offsets.end(), m_Bound.VertexOffsets.begin()))
+		{
+			m_Counters.ElidedVertexBufferBinds++;
+			return;
+		}
+
+		vkCmdBindVertexBuffers(m_CommandBuffers[m_RecordingFrame], 0, (uint32_t)buffers.size(), buffers.data(), offsets.data());
+		m_Counters.VertexBufferBinds++;
+
+		if (tracked)
+		{
+			std::copy(buffers.begin(), buffers.end(), m_Bound.VertexBuffers.begin());
+			std::copy(offsets.begin(), offsets.end(), m_Bound.VertexOffsets.begin());
+		}
+		else
+		{
+			m_Bound.VertexBuffers = {};
+		}
+	}
+
+	void VulkanCommandBuffer::BindIndexBuffer(VkBuffer buffer, VkIndexType indexType)
+	{
+		if (m_Bound.IndexBuffer == buffer && m_Bound.IndexType == indexType)
+		{
+			m_Counters.ElidedIndexBufferBinds++;
+			return;
+		}
+
+		vkCmdBindIndexBuffer(m_CommandBuffers[m_RecordingFrame], buffer, 0, indexType);
+		m_Counters.IndexBufferBinds++;
+
+		m_Bound.IndexBuffer = buffer;
+		m_Bound.IndexType = indexType;
+	}
+
+	void VulkanCommandBuffer::SetViewport(const VkViewport& viewport)
+	{
+		const VkViewport& bound = m_Bound.Viewport;
+		if (m_Bound.HasViewport && bound.x == viewport.x && bound.y == viewport.y && bound.width == viewport.width &&
+			bound.height == viewport.height && bound.minDepth == viewport.minDepth && bound.maxDepth == viewport.maxDepth)
+		{
+			m_Counters.ElidedViewports++;
+			return;
+		}
+
+		vkCmdSetViewport(m_CommandBuffers[m_RecordingFrame], 0, 1, &viewport);
+		m_Bound.Viewport = viewport;
+		m_Bound.HasViewport = true;
+	}
+
+	void VulkanCommandBuffer::SetScissor(const VkRect2D& scissor)
+	{
+		const VkRect2D& bound = m_Bound.Scissor;
+		if (m_Bound.HasScissor && bound.offset.x == scissor.offset.x && bound.offset.y == scissor.offset.y &&
+			bound.extent.width == scissor.extent.width && bound.extent.height == scissor.extent.height)
+		{
+			m_Counters.ElidedScissors++;
+			return;
+		}
+
+		vkCmdSetScissor(m_CommandBuffers[m_RecordingFrame], 0, 1, &scissor);
+		m_Bound.Scissor = scissor;
+		m_Bound.HasScissor = true;
+	}
+
 
 
 	VulkanCommand::VulkanCommand(bool start)
+		: m_CommandPool(GetThreadPool())
 	{
 		VkCommandBufferAllocateInfo allocInfo = {};
 		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
 		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-		allocInfo.commandPool = VulkanContext::GetSwapChain()->GetVkCommandPool();
+		allocInfo.commandPool = m_CommandPool;
 		allocInfo.commandBufferCount = 1;
 
 		VK_CHECK_RESULT(vkAllocateCommandBuffers(VulkanContext::GetDevice()->GetVkDevice(), &allocInfo, &m_CommandBuffer));
@@ -87,7 +232,8 @@ namespace Hz
 
 	VulkanCommand::~VulkanCommand()
 	{
-		vkFreeCommandBuffers(VulkanContext::GetDevice()->GetVkDevice(), VulkanContext::GetSwapChain()->GetVkCommandPool(), 1, &m_CommandBuffer);
+		// Note: Submit() waits till the queue is idle, so the command buffer can go right away
+		vkFreeCommandBuffers(VulkanContext::GetDevice()->GetVkDevice(), m_CommandPool, 1, &m_CommandBuffer);
 	}
 
 	void VulkanCommand::Begin()
@@ -112,6 +258,7 @@ namespace Hz
 		submitInfo.pCommandBuffers = &m_CommandBuffer;
 
         auto queue = VulkanContext::GetDevice()->GetGraphicsQueue();
+        auto queueLock = RenderThread::Lock(); // Note: The queue is shared with the render thread
 		vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
 		vkQueueWaitIdle(queue);
 	}
@@ -122,4 +269,38 @@ namespace Hz
 		Submit();
 	}
 
+	void VulkanCommand::DestroyPools()
+	{
+		std::scoped_lock<std::mutex> lock(s_Mutex);
+
+		for (auto& pool : s_Data.Pools)
+			vkDestroyCommandPool(VulkanContext::GetDevice()->GetVkDevice(), pool, nullptr);
+
+		s_Data.Pools.clear();
+		s_Data.Generation++;
+	}
+
+	VkCommandPool VulkanCommand::GetThreadPool()
+	{
+		// Note: Only the owning thread allocates from & frees to its pool, so the pool itself needs no lock
+		struct ThreadPool
+		{
+		public:
+			VkCommandPool Pool = VK_NULL_HANDLE;
+			uint64_t Generation = 0;
+		};
+		thread_local ThreadPool threadPool = {};
+
+		std::scoped_lock<std::mutex> lock(s_Mutex);
+		if (threadPool.Generation != s_Data.Generation)
+		{
+			threadPool.Pool = CreateCommandPool(VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+			threadPool.Generation = s_Data.Generation;
+
+			s_Data.Pools.push_back(threadPool.Pool);
+		}
+
+		return threadPool.Pool;
+	}
+
 }
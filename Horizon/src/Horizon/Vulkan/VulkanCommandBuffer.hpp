@@ -4,9 +4,13 @@
 
 #include "Horizon/Renderer/RendererSpecification.hpp"
 #include "Horizon/Renderer/CommandBuffer.hpp"
+#include "Horizon/Renderer/RenderThread.hpp"
 
 #include <vulkan/vulkan.h>
 
+#include <span>
+#include <array>
+#include <mutex>
 #include <vector>
 
 namespace Hz
@@ -26,8 +30,57 @@ namespace Hz
 		inline const VkFence GetVkInFlightFence(uint32_t index) const { return m_InFlightFences[index]; }
 		inline const VkCommandBuffer GetVkCommandBuffer(uint32_t index) const { return m_CommandBuffers[index]; }
 
+		PassStatistics GetStatistics() const override;
+
+		inline RenderCounters& GetCounters() { return m_Counters; } // Note: Counters of the recording in progress
+
+		// Recording which skips binds of what's already bound, Note: The tracked state is reset every Begin()
+		void BindPipeline(VkPipelineBindPoint bindPoint, VkPipeline pipeline);
+		void BindDescriptorSet(VkPipelineBindPoint bindPoint, VkPipelineLayout layout, uint32_t setID, VkDescriptorSet set, std::span<const uint32_t> dynamicOffsets = { });
+		void BindVertexBuffers(std::span<const VkBuffer> buffers, std::span<const VkDeviceSize> offsets);
+		void BindIndexBuffer(VkBuffer buffer, VkIndexType indexType);
+		void SetViewport(const VkViewport& viewport);
+		void SetScissor(const VkRect2D& scissor);
+
+	private:
+		struct BoundState
+		{
+		public:
+			inline static constexpr const uint32_t MaxDescriptorSets = 8;
+			inline static constexpr const uint32_t MaxDynamicOffsets = 4;
+			inline static constexpr const uint32_t MaxVertexBuffers = 8;
+
+			struct Set
+			{
+			public:
+				VkDescriptorSet Handle = VK_NULL_HANDLE;
+				VkPipelineLayout Layout = VK_NULL_HANDLE;
+				std::array<uint32_t, MaxDynamicOffsets> DynamicOffsets = { };
+				uint32_t DynamicOffsetCount = 0;
+			};
+
+			// Note: Graphics & compute have separate bindings, other bind points aren't tracked
+			std::array<VkPipeline, 2> Pipelines = { };
+			std::array<std::array<Set, MaxDescriptorSets>, 2> Sets = { };
+
+			std::array<VkBuffer, MaxVertexBuffers> VertexBuffers = { };
+			std::array<VkDeviceSize, MaxVertexBuffers> VertexOffsets = { };
+			VkBuffer IndexBuffer = VK_NULL_HANDLE;
+			VkIndexType IndexType = VK_INDEX_TYPE_UINT32;
+
+			VkViewport Viewport = {};
+			VkRect2D Scissor = {};
+			bool HasViewport = false;
+			bool HasScissor = false;
+		};
+
 	private:
+		// Note: Every command buffer has its own pool, so allocating on one thread while recording on the render thread is fine
+		VkCommandPool m_CommandPool = VK_NULL_HANDLE;
 		std::vector<VkCommandBuffer> m_CommandBuffers = { };
+		RenderCounters m_Counters = { };
+		BoundState m_Bound = { };
+		uint32_t m_RecordingFrame = 0; // Set by Begin(), the binds record into this frame's command buffer, so they work from any thread
 
 		// Synchronization objects
 		std::vector<VkSemaphore> m_RenderFinishedSemaphores = { };
@@ -51,8 +104,28 @@ namespace Hz
 
 		inline const VkCommandBuffer GetVkCommandBuffer() const { return m_CommandBuffer; }
 
+		static void DestroyPools(); // Note: Gets called by the context, before the device is destroyed
+
+	private:
+		static VkCommandPool GetThreadPool(); // Creates the calling thread's pool on first use
+
 	private:
+		// Note: The command buffer comes from a transient pool of the creating thread, so commands can be recorded on
+		// any thread without creating a pool every time. A command has to be destroyed on the thread that created it.
+		VkCommandPool m_CommandPool = VK_NULL_HANDLE;
 		VkCommandBuffer m_CommandBuffer = VK_NULL_HANDLE;
+
+		// Note: We store our info in a struct, so we can ensure lifetime
+		// of all objects easily while the class remains static.
+		struct Info
+		{
+		public:
+			std::vector<VkCommandPool> Pools = { }; // Every thread's pool, so they can be destroyed before the device
+			uint64_t Generation = 1; // Incremented by DestroyPools(), threads holding an older pool create a new one
+		};
+
+		inline static std::mutex s_Mutex = {};
+		inline static Info s_Data = {};
 	};
 
 }
@@ -4,11 +4,22 @@
 #include "Horizon/Core/Logging.hpp"
 #include "Horizon/Core/Window.hpp"
 
+#include "Horizon/Utils/AllocationTracker.hpp"
+
 #include "Horizon/Renderer/Renderer.hpp"
 #include "Horizon/Renderer/GraphicsContext.hpp"
 
 #include "Horizon/Vulkan/VulkanUtils.hpp"
 #include "Horizon/Vulkan/VulkanContext.hpp"
+#include "Horizon/Vulkan/VulkanDefragmenter.hpp"
+#include "Horizon/Vulkan/VulkanImageLoader.hpp"
+#include "Horizon/Vulkan/VulkanStreamedImage.hpp"
+#include "Horizon/Vulkan/VulkanMipGenerator.hpp"
+#include "Horizon/Vulkan/VulkanSampler.hpp"
+#include "Horizon/Vulkan/VulkanRenderTargetPool.hpp"
+#include "Horizon/Vulkan/VulkanRenderpassCache.hpp"
+#include "Horizon/Vulkan/VulkanGpuProfiler.hpp"
+#include "Horizon/Vulkan/VulkanCommandBuffer.hpp"
 
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
@@ -83,6 +94,8 @@ namespace Hz
 
     void VulkanContext::Init(void* window, uint32_t width, uint32_t height, const bool vsync, const uint8_t framesInFlight)
     {
+        HZ_ALLOCATION_TAG(AllocationTag::Vulkan);
+
         s_Data = new Info();
         s_Data->Window = window;
 
@@ -92,11 +105,20 @@ namespace Hz
 
     void VulkanContext::Destroy()
     {
+        VulkanImageLoader::Destroy();
+        VulkanTextureStreamer::Destroy();
+        VulkanDefragmenter::Destroy();
         Renderer::FreeObjects();
 
         s_Data->SwapChain.Reset();
 
         Renderer::FreeObjects();
+        VulkanMipGenerator::Destroy();
+        VulkanSamplerCache::Destroy();
+        VulkanRenderpassCache::Destroy();
+        VulkanGpuProfiler::Destroy();
+        VulkanRenderTargetPool::Destroy();
+        VulkanCommand::DestroyPools();
         VkUtils::Allocator::Destroy();
 
         s_Data->PhysicalDevice.Reset();
@@ -0,0 +1,413 @@
+#include "hzpch.h"
+#include "VulkanDefragmenter.hpp"
+
+#include "Horizon/Core/Logging.hpp"
+
+#include "Horizon/Renderer/Renderer.hpp"
+
+#include "Horizon/Vulkan/VulkanUtils.hpp"
+#include "Horizon/Vulkan/VulkanContext.hpp"
+#include "Horizon/Vulkan/VulkanGpuProfiler.hpp"
+#include "Horizon/Vulkan/VulkanDescriptors.hpp"
+
+#include "Horizon/Utils/Profiler.hpp"
+
+#include <Pulse/Core/Defines.hpp>
+
+namespace Hz
+{
+
+    // Note: After this many passes in a row without a single move we stop, since
+    // everything VMA wants to move is something we can't move.
+    static constexpr const uint32_t s_MaxIgnoredPasses = 4;
+
+    ///////////////////////////////////////////////////////////
+    // Movable
+    ///////////////////////////////////////////////////////////
+    VulkanMovable::~VulkanMovable()
+    {
+        std::scoped_lock<std::mutex> lock(VulkanDefragmenter::s_Mutex);
+        auto& data = VulkanDefragmenter::s_Data;
+
+        auto it = data.Dependents.find(this);
+        if (it == data.Dependents.end())
+            return;
+
+        for (auto& [set, binding] : it->second)
+            data.Bindings[set].erase(binding);
+
+        data.Dependents.erase(it);
+    }
+
+    ///////////////////////////////////////////////////////////
+    // Defragmenter
+    ///////////////////////////////////////////////////////////
+    void VulkanDefragmenter::Begin(const DefragmentationSpecification& specs)
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+
+        if (s_Data.Context)
+        {
+            HZ_LOG_WARN("Tried to start defragmentation while a defragmentation is already in progress.");
+            return;
+        }
+
+        VmaDefragmentationInfo info = {};
+        info.maxBytesPerPass = (VkDeviceSize)specs.MaxBytesPerPass;
+        info.maxAllocationsPerPass = specs.MaxMovesPerPass;
+
+        switch (specs.Algorithm)
+        {
+        case DefragmentationAlgorithm::Fast:
+            info.flags = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_FAST_BIT;
+            break;
+        case DefragmentationAlgorithm::Balanced:
+            info.flags = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_BALANCED_BIT;
+            break;
+        case DefragmentationAlgorithm::Full:
+            info.flags = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_FULL_BIT;
+            break;
+
+        default:
+            HZ_LOG_ERROR("Invalid defragmentation algorithm selected.");
+            break;
+        }
+
+        VK_CHECK_RESULT(vmaBeginDefragmentation(VkUtils::Allocator::GetVmaAllocator(), &info, &s_Data.Context));
+
+        auto device = VulkanContext::GetDevice()->GetVkDevice();
+
+        VkCommandBufferAllocateInfo allocInfo = {};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandPool = VulkanContext::GetSwapChain()->GetVkCommandPool();
+        allocInfo.commandBufferCount = 1;
+
+        VK_CHECK_RESULT(vkAllocateCommandBuffers(device, &allocInfo, &s_Data.CommandBuffer));
+
+        VkFenceCreateInfo fenceInfo = {};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+        VK_CHECK_RESULT(vkCreateFence(device, &fenceInfo, nullptr, &s_Data.Fence));
+
+        s_Data.IgnoredPasses = 0;
+    }
+
+    void VulkanDefragmenter::Update()
+    {
+        std::vector<FreeFunction> deferred = { };
+        {
+            std::scoped_lock<std::mutex> lock(s_Mutex);
+            if (!s_Data.Context && s_Data.Patches.empty())
+                return;
+
+            HZ_PROFILE_SCOPE("VulkanDefragmenter::Update");
+
+            // Note: Patches can also come from RefreshDeferred() without a defragmentation in progress
+            if (s_Data.Context)
+            {
+                if (!s_Data.PassActive)
+                    BeginPass();
+                else
+                    s_Data.FramesInPass++;
+            }
+
+            // Note: Descriptor sets are only patched when their frame comes around, since
+            // before that a previous frame might still be using them.
+            ApplyPatches(Renderer::GetCurrentFrame());
+
+            // Note: The old memory can only be released once every frame that could reference it has finished
+            if (s_Data.PassActive && s_Data.FramesInPass + 1 >= (uint32_t)Renderer::GetSpecification().Buffers)
+            {
+                EndPass();
+                deferred.swap(s_Data.DeferredFrees);
+            }
+        }
+
+        for (auto& func : deferred)
+            func();
+    }
+
+    void VulkanDefragmenter::Destroy()
+    {
+        std::vector<FreeFunction> deferred = { };
+        {
+            std::scoped_lock<std::mutex> lock(s_Mutex);
+            if (!s_Data.Context)
+                return;
+
+            VulkanContext::GetDevice()->Wait();
+
+            if (s_Data.PassActive)
+                EndPass();
+            if (s_Data.Context)
+                Finish();
+
+            deferred.swap(s_Data.DeferredFrees);
+            s_Data.Patches.clear();
+        }
+
+        for (auto& func : deferred)
+            func();
+    }
+
+    bool VulkanDefragmenter::Active()
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+        return s_Data.Context != VK_NULL_HANDLE;
+    }
+
+    void VulkanDefragmenter::Register(VmaAllocation allocation, VulkanMovable* movable)
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+        s_Data.Movables[allocation] = movable;
+    }
+
+    void VulkanDefragmenter::Unregister(VmaAllocation allocation, VulkanMovable* movable)
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+
+        auto it = s_Data.Movables.find(allocation);
+        if (it != s_Data.Movables.end() && it->second == movable)
+            s_Data.Movables.erase(it);
+    }
+
+    void VulkanDefragmenter::Track(VulkanDescriptorSet* set, const Descriptor& descriptor, VulkanMovable* movable)
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+
+        // Note: Non-movable resources on an untracked set have nothing to remove, so we don't create an entry
+        if (!movable && !s_Data.Bindings.contains(set))
+            return;
+
+        auto& bindings = s_Data.Bindings[set];
+
+        // Remove the previous resource at this binding
+        if (auto it = bindings.find(descriptor.Binding); it != bindings.end())
+        {
+            // Note: Re-uploading the same resource (every frame) doesn't need to touch the maps
+            if (movable && it->second.first == movable)
+            {
+                it->second.second = descriptor;
+                return;
+            }
+
+            auto& dependents = s_Data.Dependents[it->second.first];
+            std::erase(dependents, std::make_pair(set, descriptor.Binding));
+
+            if (dependents.empty())
+                s_Data.Dependents.erase(it->second.first);
+
+            bindings.erase(it);
+        }
+
+        if (movable)
+        {
+            bindings[descriptor.Binding] = { movable, descriptor };
+            s_Data.Dependents[movable].emplace_back(set, descriptor.Binding);
+        }
+
+        if (bindings.empty())
+            s_Data.Bindings.erase(set);
+    }
+
+    void VulkanDefragmenter::Untrack(VulkanDescriptorSet* set)
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+
+        if (auto it = s_Data.Bindings.find(set); it != s_Data.Bindings.end())
+        {
+            for (auto& [binding, element] : it->second)
+            {
+                auto& dependents = s_Data.Dependents[element.first];
+                std::erase(dependents, std::make_pair(set, binding));
+
+                if (dependents.empty())
+                    s_Data.Dependents.erase(element.first);
+            }
+
+            s_Data.Bindings.erase(it);
+        }
+
+        std::erase_if(s_Data.Patches, [set](const Patch& patch) { return patch.Set == set; });
+    }
+
+    void VulkanDefragmenter::Refresh(VulkanMovable* movable)
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+
+        auto it = s_Data.Dependents.find(movable);
+        if (it == s_Data.Dependents.end())
+            return;
+
+        const uint32_t framesInFlight = (uint32_t)Renderer::GetSpecification().Buffers;
+        for (auto& [set, binding] : it->second)
+        {
+            const Descriptor& descriptor = s_Data.Bindings[set][binding].second;
+
+            for (uint32_t frame = 0; frame < framesInFlight; frame++)
+                set->Patch(movable, descriptor, frame);
+        }
+    }
+
+    void VulkanDefragmenter::RefreshDeferred(VulkanMovable* movable)
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+
+        auto it = s_Data.Dependents.find(movable);
+        if (it == s_Data.Dependents.end())
+            return;
+
+        for (auto& [set, binding] : it->second)
+            s_Data.Patches.push_back({ set, binding, std::vector<bool>((size_t)Renderer::GetSpecification().Buffers, true) });
+
+        // Note: Only called after waiting on the current frame's fences, so its sets can be patched right away
+        ApplyPatches(Renderer::GetCurrentFrame());
+    }
+
+    bool VulkanDefragmenter::DeferDestruction(VmaAllocation allocation, FreeFunction&& func)
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+        if (!s_Data.PassActive)
+            return false;
+
+        for (uint32_t i = 0; i < s_Data.Pass.moveCount; i++)
+        {
+            const VmaDefragmentationMove& move = s_Data.Pass.pMoves[i];
+            if (move.srcAllocation == allocation && move.operation == VMA_DEFRAGMENTATION_MOVE_OPERATION_COPY)
+            {
+                s_Data.DeferredFrees.push_back(std::move(func));
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void VulkanDefragmenter::BeginPass()
+    {
+        VkResult result = vmaBeginDefragmentationPass(VkUtils::Allocator::GetVmaAllocator(), s_Data.Context, &s_Data.Pass);
+        if (result == VK_SUCCESS) // Nothing left to move
+        {
+            Finish();
+            return;
+        }
+
+        VkCommandBufferBeginInfo beginInfo = {};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        VK_CHECK_RESULT(vkBeginCommandBuffer(s_Data.CommandBuffer, &beginInfo));
+
+        VkMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        vkCmdPipelineBarrier(s_Data.CommandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+        VulkanGpuProfiler::CountBarrier();
+
+        uint32_t moved = 0;
+        for (uint32_t i = 0; i < s_Data.Pass.moveCount; i++)
+        {
+            VmaDefragmentationMove& move = s_Data.Pass.pMoves[i];
+
+            auto it = s_Data.Movables.find(move.srcAllocation);
+            if (it == s_Data.Movables.end() || !it->second->CanMove())
+            {
+                move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+                continue;
+            }
+
+            s_Data.OldHandles.push_back(it->second->Move(s_Data.CommandBuffer, move.dstTmpAllocation));
+            moved++;
+
+            // Every descriptor set referencing the resource needs to be patched for all frames in flight
+            if (auto dependents = s_Data.Dependents.find(it->second); dependents != s_Data.Dependents.end())
+            {
+                for (auto& [set, binding] : dependents->second)
+                    s_Data.Patches.push_back({ set, binding, std::vector<bool>((size_t)Renderer::GetSpecification().Buffers, true) });
+            }
+        }
+
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+        vkCmdPipelineBarrier(s_Data.CommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+        VulkanGpuProfiler::CountBarrier();
+
+        VK_CHECK_RESULT(vkEndCommandBuffer(s_Data.CommandBuffer));
+
+        // Note: Submitted before the frame's own work on the same queue, so the barrier above orders it before any use of the new handles.
+        VkSubmitInfo submitInfo = {};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &s_Data.CommandBuffer;
+
+        {
+            auto queueLock = RenderThread::Lock();
+            VK_CHECK_RESULT(vkQueueSubmit(VulkanContext::GetDevice()->GetGraphicsQueue(), 1, &submitInfo, s_Data.Fence));
+        }
+
+        s_Data.IgnoredPasses = (moved == 0 ? s_Data.IgnoredPasses + 1 : 0);
+        s_Data.PassActive = true;
+        s_Data.FramesInPass = 0;
+    }
+
+    void VulkanDefragmenter::EndPass()
+    {
+        auto device = VulkanContext::GetDevice()->GetVkDevice();
+
+        vkWaitForFences(device, 1, &s_Data.Fence, VK_TRUE, Pulse::Numeric::Max<uint64_t>());
+        vkResetFences(device, 1, &s_Data.Fence);
+
+        for (auto& func : s_Data.OldHandles)
+            func();
+        s_Data.OldHandles.clear();
+
+        VkResult result = vmaEndDefragmentationPass(VkUtils::Allocator::GetVmaAllocator(), s_Data.Context, &s_Data.Pass);
+        s_Data.PassActive = false;
+        s_Data.Pass = {};
+
+        if (result == VK_SUCCESS || s_Data.IgnoredPasses >= s_MaxIgnoredPasses)
+            Finish();
+    }
+
+    void VulkanDefragmenter::Finish()
+    {
+        VmaDefragmentationStats stats = {};
+        vmaEndDefragmentation(VkUtils::Allocator::GetVmaAllocator(), s_Data.Context, &stats);
+        s_Data.Context = VK_NULL_HANDLE;
+
+        auto device = VulkanContext::GetDevice()->GetVkDevice();
+        vkFreeCommandBuffers(device, VulkanContext::GetSwapChain()->GetVkCommandPool(), 1, &s_Data.CommandBuffer);
+        vkDestroyFence(device, s_Data.Fence, nullptr);
+        s_Data.CommandBuffer = VK_NULL_HANDLE;
+        s_Data.Fence = VK_NULL_HANDLE;
+
+        HZ_LOG_TRACE("Defragmentation finished, moved {0} allocation(s) ({1} bytes) and freed {2} bytes ({3} memory block(s)).", stats.allocationsMoved, stats.bytesMoved, stats.bytesFreed, stats.deviceMemoryBlocksFreed);
+    }
+
+    void VulkanDefragmenter::ApplyPatches(uint32_t frame)
+    {
+        for (auto& patch : s_Data.Patches)
+        {
+            if (!patch.Frames[frame])
+                continue;
+
+            patch.Frames[frame] = false;
+
+            auto set = s_Data.Bindings.find(patch.Set);
+            if (set == s_Data.Bindings.end())
+                continue;
+
+            // Note: The resource might have been replaced or destroyed since the move, we always write what's currently bound
+            auto binding = set->second.find(patch.Binding);
+            if (binding == set->second.end())
+                continue;
+
+            patch.Set->Patch(binding->second.first, binding->second.second, frame);
+        }
+
+        std::erase_if(s_Data.Patches, [](const Patch& patch) { return std::find(patch.Frames.begin(), patch.Frames.end(), true) == patch.Frames.end(); });
+    }
+
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "Horizon/Core/Core.hpp"
+
+#include "Horizon/Renderer/Renderer.hpp"
+#include "Horizon/Renderer/Descriptors.hpp"
+
+#include <vulkan/vulkan.h>
+#include <vma/vk_mem_alloc.h>
+
+#include <mutex>
+#include <vector>
+#include <utility>
+#include <unordered_map>
+
+namespace Hz
+{
+
+    class VulkanDescriptorSet;
+
+    // Note: Implemented by resources whose memory can be moved by the defragmenter.
+    // They register their VmaAllocation on creation and unregister it on destruction.
+    class VulkanMovable
+    {
+    public:
+        VulkanMovable() = default;
+        virtual ~VulkanMovable();
+
+        // Creates a new handle bound to dstAllocation, records a copy of the contents and starts using the new handle.
+        // Returns a function which destroys the old handle, it gets called once the GPU is done with it.
+        virtual FreeFunction Move(VkCommandBuffer cmdBuf, VmaAllocation dstAllocation) = 0;
+        virtual bool CanMove() const = 0;
+    };
+
+    class VulkanDefragmenter
+    {
+    public:
+        static void Begin(const DefragmentationSpecification& specs);
+        static void Update(); // Note: Gets called by the renderer every frame after waiting on the current frame's fences
+        static void Destroy(); // Finishes the current pass, waits for the device to be idle
+
+        static bool Active();
+
+        // Movables
+        static void Register(VmaAllocation allocation, VulkanMovable* movable);
+        static void Unregister(VmaAllocation allocation, VulkanMovable* movable);
+
+        // Descriptor sets, Note: movable can be nullptr to clear the binding
+        static void Track(VulkanDescriptorSet* set, const Descriptor& descriptor, VulkanMovable* movable);
+        static void Untrack(VulkanDescriptorSet* set);
+        static void Refresh(VulkanMovable* movable); // Re-writes all sets referencing movable for every frame, Note: Only valid when the GPU is not using these sets
+        static void RefreshDeferred(VulkanMovable* movable); // Re-writes all sets referencing movable, every frame's sets once that frame comes around
+
+        // Returns true if the allocation is part of the current pass, the function will then be called after the pass has ended
+        static bool DeferDestruction(VmaAllocation allocation, FreeFunction&& func);
+
+    private:
+        static void BeginPass();
+        static void EndPass();
+        static void Finish();
+        static void ApplyPatches(uint32_t frame);
+
+    private:
+        struct Patch
+        {
+        public:
+            VulkanDescriptorSet* Set = nullptr;
+            uint32_t Binding = 0;
+            std::vector<bool> Frames = { }; // Frames in flight which still have to be patched
+        };
+
+        // Note: We store our info in a struct, so we can ensure lifetime
+        // of all objects easily while the class remains static.
+        struct Info
+        {
+        public:
+            VmaDefragmentationContext Context = VK_NULL_HANDLE;
+            VmaDefragmentationPassMoveInfo Pass = {};
+            bool PassActive = false;
+            uint32_t FramesInPass = 0;
+            uint32_t IgnoredPasses = 0; // Passes in a row in which nothing could be moved
+
+            VkCommandBuffer CommandBuffer = VK_NULL_HANDLE;
+            VkFence Fence = VK_NULL_HANDLE;
+
+            std::vector<FreeFunction> OldHandles = { };     // Destroyed before ending the pass
+            std::vector<FreeFunction> DeferredFrees = { };  // Resources destroyed by their owner while being moved
+
+            std::unordered_map<VmaAllocation, VulkanMovable*> Movables = { };
+            std::unordered_map<VulkanDescriptorSet*, std::unordered_map<uint32_t, std::pair<VulkanMovable*, Descriptor>>> Bindings = { };
+            std::unordered_map<VulkanMovable*, std::vector<std::pair<VulkanDescriptorSet*, uint32_t>>> Dependents = { };
+            std::vector<Patch> Patches = { };
+        };
+
+        // Note: The registry outlives the renderer since resources can be destroyed after Renderer::Destroy
+        inline static std::mutex s_Mutex = {};
+        inline static Info s_Data = {};
+
+        friend class VulkanMovable;
+    };
+
+}
@@ -9,10 +9,12 @@
 
 #include "Horizon/Vulkan/VulkanUtils.hpp"
 #include "Horizon/Vulkan/VulkanImage.hpp"
+#include "Horizon/Vulkan/VulkanSampler.hpp"
 #include "Horizon/Vulkan/VulkanBuffers.hpp"
 #include "Horizon/Vulkan/VulkanContext.hpp"
 #include "Horizon/Vulkan/VulkanPipeline.hpp"
 #include "Horizon/Vulkan/VulkanCommandBuffer.hpp"
+#include "Horizon/Vulkan/VulkanDefragmenter.hpp"
 
 #include <Pulse/Types/TypeUtils.hpp>
 
@@ -24,21 +26,52 @@ namespace Hz
     {
     }
 
+    VulkanDescriptorSet::~VulkanDescriptorSet()
+    {
+        VulkanDefragmenter::Untrack(this);
+    }
+
     void VulkanDescriptorSet::Bind(Ref<Pipeline> pipeline, Ref<CommandBuffer> commandBuffer, PipelineBindPoint bindPoint, const std::vector<uint32_t>& dynamicOffsets)
     {
 		auto vkPipelineLayout = pipeline.As<VulkanPipeline>()->GetVkPipelineLayout();
-		auto vkCmdBuf = commandBuffer.As<VulkanCommandBuffer>()->GetVkCommandBuffer(Renderer::GetCurrentFrame());
 
-		vkCmdBindDescriptorSets(vkCmdBuf, (VkPipelineBindPoint)bindPoint, vkPipelineLayout, m_SetID, 1, &m_DescriptorSets[Renderer::GetCurrentFrame()], static_cast<uint32_t>(dynamicOffsets.size()), dynamicOffsets.data());
+		commandBuffer.As<VulkanCommandBuffer>()->BindDescriptorSet((VkPipelineBindPoint)bindPoint, vkPipelineLayout, m_SetID, m_DescriptorSets[Renderer::GetCurrentFrame()], dynamicOffsets);
 	}
 
     void VulkanDescriptorSet::Upload(const std::initializer_list<Uploadable>& elements)
     {
-        std::vector<VkWriteDescriptorSet> writes;
+        WriteList writes = { };
         writes.reserve(elements.size() * (size_t)Renderer::GetSpecification().Buffers);
 
-        std::vector<VkDescriptorImageInfo> imageInfos = {};
-        std::vector<VkDescriptorBufferInfo> bufferInfos = {};
+        // Note: We reserve up front since the writes point into these vectors.
+        ImageInfoList imageInfos = {};
+        imageInfos.reserve(writes.capacity());
+        BufferInfoList bufferInfos = {};
+        bufferInfos.reserve(writes.capacity());
+
+        // Note: Keeps track of which resource is at which binding, so it can be patched after being moved or replaced.
+        // Tracked before the handles are read, so a swap on the render thread after reading them still patches this set.
+        for (auto& [uploadable, descriptor] : elements)
+        {
+            VulkanMovable* movable = std::visit([](auto&& arg) -> VulkanMovable*
+            {
+                using T = Pulse::Types::Clean<decltype(arg)>;
+
+                if constexpr (std::is_same_v<T, Ref<Image>>)
+                    return arg.As<VulkanImage>().Raw();
+                else if constexpr (std::is_same_v<T, Ref<VertexBuffer>>)
+                    return arg.As<VulkanVertexBuffer>().Raw();
+                else if constexpr (std::is_same_v<T, Ref<IndexBuffer>>)
+                    return arg.As<VulkanIndexBuffer>().Raw();
+
+                return nullptr;
+            }, uploadable);
+
+            VulkanDefragmenter::Track(this, descriptor, movable);
+        }
+
+        // Note: Image handles are read & written under the handle lock, which patches take as well, so a patch with newer handles can't be overwritten
+        std::scoped_lock<std::mutex> lock(VulkanImage::s_HandleMutex);
 
         for (auto& [uploadable, descriptor] : elements)
         {
@@ -46,16 +79,72 @@ namespace Hz
             {
                 using T = Pulse::Types::Clean<decltype(arg)>;
 
-                if (std::is_same_v<T, Ref<Image>>)                  UploadImage(writes, imageInfos, arg, descriptor);
-                else if (std::is_same_v<T, Ref<UniformBuffer>>)     UploadUniformBuffer(writes, bufferInfos, arg, descriptor);
-                else if (std::is_same_v<T, Ref<StorageBuffer>>)     UploadStorageBuffer(writes, bufferInfos, arg, descriptor);
+                if constexpr (std::is_same_v<T, Ref<Image>>)
+                    UploadImage(writes, imageInfos, arg, descriptor);
+                else if constexpr (std::is_same_v<T, Ref<Sampler>>)
+                    UploadSampler(writes, imageInfos, arg, descriptor);
+                else if constexpr (std::is_same_v<T, Ref<UniformBuffer>>)
+                    UploadUniformBuffer(writes, bufferInfos, arg, descriptor);
+                else if constexpr (std::is_same_v<T, Ref<StorageBuffer>>)
+                    UploadStorageBuffer(writes, bufferInfos, arg, descriptor);
+                else if constexpr (std::is_same_v<T, Ref<VertexBuffer>>)
+                    UploadStaticBuffer(writes, bufferInfos, arg.As<VulkanVertexBuffer>()->GetVkBuffer(), (VkDeviceSize)arg->GetSize(), descriptor);
+                else if constexpr (std::is_same_v<T, Ref<IndexBuffer>>)
+                    UploadStaticBuffer(writes, bufferInfos, arg.As<VulkanIndexBuffer>()->GetVkBuffer(), (VkDeviceSize)(sizeof(uint32_t) * arg->GetCount()), descriptor);
             }, uploadable);
         }
 
         vkUpdateDescriptorSets(VulkanContext::GetDevice()->GetVkDevice(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
     }
 
-    void VulkanDescriptorSet::UploadImage(std::vector<VkWriteDescriptorSet>& writes, std::vector<VkDescriptorImageInfo>& imageInfos, Ref<Image> image, Descriptor descriptor)
+    void VulkanDescriptorSet::Patch(VulkanMovable* movable, const Descriptor& descriptor, uint32_t frame)
+    {
+        VkDescriptorImageInfo imageInfo = {};
+        VkDescriptorBufferInfo bufferInfo = {};
+
+        VkWriteDescriptorSet descriptorWrite = {};
+        descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrite.dstSet = m_DescriptorSets[frame];
+        descriptorWrite.dstBinding = descriptor.Binding;
+        descriptorWrite.dstArrayElement = 0;
+        descriptorWrite.descriptorType = (VkDescriptorType)descriptor.Type;
+        descriptorWrite.descriptorCount = descriptor.Count;
+
+        std::unique_lock<std::mutex> handleLock = {};
+        if (auto image = dynamic_cast<VulkanImage*>(movable))
+        {
+            handleLock = std::unique_lock<std::mutex>(VulkanImage::s_HandleMutex);
+
+            imageInfo.imageLayout = (VkImageLayout)image->m_Specification.Layout;
+            imageInfo.imageView = image->m_ImageView;
+            imageInfo.sampler = image->m_Sampler;
+
+            descriptorWrite.pImageInfo = &imageInfo;
+        }
+        else if (auto vertexBuffer = dynamic_cast<VulkanVertexBuffer*>(movable))
+        {
+            bufferInfo.buffer = vertexBuffer->GetVkBuffer();
+            bufferInfo.range = (VkDeviceSize)vertexBuffer->GetSize();
+
+            descriptorWrite.pBufferInfo = &bufferInfo;
+        }
+        else if (auto indexBuffer = dynamic_cast<VulkanIndexBuffer*>(movable))
+        {
+            bufferInfo.buffer = indexBuffer->GetVkBuffer();
+            bufferInfo.range = (VkDeviceSize)(sizeof(uint32_t) * indexBuffer->GetCount());
+
+            descriptorWrite.pBufferInfo = &bufferInfo;
+        }
+        else
+        {
+            HZ_LOG_ERROR("Tried to patch descriptor set with an unknown movable resource.");
+            return;
+        }
+
+        vkUpdateDescriptorSets(VulkanContext::GetDevice()->GetVkDevice(), 1, &descriptorWrite, 0, nullptr);
+    }
+
+    void VulkanDescriptorSet::UploadImage(WriteList& writes, ImageInfoList& imageInfos, Ref<Image> image, Descriptor descriptor)
     {
         Ref<VulkanImage> src = image.As<VulkanImage>();
 
@@ -67,6 +156,13 @@ namespace Hz
 			imageInfo.imageView = src->m_ImageView;
 			imageInfo.sampler = src->m_Sampler;
 
+			// Note: Input attachments are read in the layout the subpass references them with
+			if (descriptor.Type == DescriptorType::InputAttachment)
+			{
+				imageInfo.imageLayout = ((src->m_Specification.Flags & ImageUsageFlags::DepthStencil) ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+				imageInfo.sampler = VK_NULL_HANDLE;
+			}
+
 			VkWriteDescriptorSet& descriptorWrite = writes.emplace_back();
 			descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
 			descriptorWrite.dstSet = m_DescriptorSets[i];
@@ -78,7 +174,28 @@ namespace Hz
 		}
     }
 
-    void VulkanDescriptorSet::UploadUniformBuffer(std::vector<VkWriteDescriptorSet>& writes, std::vector<VkDescriptorBufferInfo>& bufferInfos, Ref<UniformBuffer> buffer, Descriptor descriptor)
+    void VulkanDescriptorSet::UploadSampler(WriteList& writes, ImageInfoList& imageInfos, Ref<Sampler> sampler, Descriptor descriptor)
+    {
+        Ref<VulkanSampler> src = sampler.As<VulkanSampler>();
+
+		const size_t framesInFlight = (size_t)Renderer::GetSpecification().Buffers;
+		for (size_t i = 0; i < framesInFlight; i++)
+		{
+			VkDescriptorImageInfo& imageInfo = imageInfos.emplace_back();
+			imageInfo.sampler = src->GetVkSampler();
+
+			VkWriteDescriptorSet& descriptorWrite = writes.emplace_back();
+			descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrite.dstSet = m_DescriptorSets[i];
+			descriptorWrite.dstBinding = descriptor.Binding;
+			descriptorWrite.dstArrayElement = 0;
+			descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+			descriptorWrite.descriptorCount = descriptor.Count;
+			descriptorWrite.pImageInfo = &imageInfo;
+		}
+    }
+
+    void VulkanDescriptorSet::UploadUniformBuffer(WriteList& writes, BufferInfoList& bufferInfos, Ref<UniformBuffer> buffer, Descriptor descriptor)
     {
         Ref<VulkanUniformBuffer> src = buffer.As<VulkanUniformBuffer>();
 
@@ -101,7 +218,7 @@ namespace Hz
 		}
     }
 
-    void VulkanDescriptorSet::UploadStorageBuffer(std::vector<VkWriteDescriptorSet>& writes, std::vector<VkDescriptorBufferInfo>& bufferInfos, Ref<StorageBuffer> buffer, Descriptor descriptor)
+    void VulkanDescriptorSet::UploadStorageBuffer(WriteList& writes, BufferInfoList& bufferInfos, Ref<StorageBuffer> buffer, Descriptor descriptor)
     {
         Ref<VulkanStorageBuffer> src = buffer.As<VulkanStorageBuffer>();
 
@@ -124,6 +241,30 @@ namespace Hz
 		}
     }
 
+    void VulkanDescriptorSet::UploadStaticBuffer(WriteList& writes, BufferInfoList& bufferInfos, VkBuffer buffer, VkDeviceSize size, Descriptor descriptor)
+    {
+        HZ_ASSERT((descriptor.Type == DescriptorType::StorageBuffer), "Vertex/Index buffers can only be uploaded as a DescriptorType::StorageBuffer.");
+
+        // Note: Vertex & Index buffers are not duplicated per frame, so every frame points to the same buffer.
+		const size_t framesInFlight = (size_t)Renderer::GetSpecification().Buffers;
+		for (size_t i = 0; i < framesInFlight; i++)
+		{
+			VkDescriptorBufferInfo& bufferInfo = bufferInfos.emplace_back();
+			bufferInfo.buffer = buffer;
+			bufferInfo.offset = 0;
+			bufferInfo.range = size;
+
+			VkWriteDescriptorSet& descriptorWrite = writes.emplace_back();
+			descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrite.dstSet = m_DescriptorSets[i];
+			descriptorWrite.dstBinding = descriptor.Binding;
+			descriptorWrite.dstArrayElement = 0;
+			descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			descriptorWrite.descriptorCount = descriptor.Count;
+			descriptorWrite.pBufferInfo = &bufferInfo;
+		}
+    }
+
     VulkanDescriptorSets::VulkanDescriptorSets(const std::initializer_list<DescriptorSetGroup>& specs)
     {
         for (auto& group : specs)
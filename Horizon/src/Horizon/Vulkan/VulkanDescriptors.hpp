@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Horizon/Core/Core.hpp"
+#include "Horizon/Core/FrameAllocator.hpp"
 
 #include "Horizon/Renderer/RendererSpecification.hpp"
 #include "Horizon/Renderer/Descriptors.hpp"
@@ -11,24 +12,33 @@ namespace Hz
 {
 
 	class VulkanPipeline;
+	class VulkanMovable;
 
 	class VulkanDescriptorSet : public DescriptorSet
 	{
 	public:
 		VulkanDescriptorSet(uint32_t setID, const std::vector<VkDescriptorSet>& sets);
-		~VulkanDescriptorSet() = default;
+		~VulkanDescriptorSet();
 
 		void Bind(Ref<Pipeline> pipeline, Ref<CommandBuffer> commandBuffer, PipelineBindPoint bindPoint, const std::vector<uint32_t>& dynamicOffsets) override;
 
-		inline uint32_t GetSetID() const { return m_SetID; }
+		inline uint32_t GetSetID() const override { return m_SetID; }
 		inline const VkDescriptorSet GetVkDescriptorSet(uint32_t index) const { return m_DescriptorSets[index]; }
 
         void Upload(const std::initializer_list<Uploadable>& elements) override;
+        void Patch(VulkanMovable* movable, const Descriptor& descriptor, uint32_t frame); // Rewrites a moved resource, used by defragmentation
 
     private:
-        void UploadImage(std::vector<VkWriteDescriptorSet>& writes, std::vector<VkDescriptorImageInfo>& imageInfos, Ref<Image> image, Descriptor descriptor);
-        void UploadUniformBuffer(std::vector<VkWriteDescriptorSet>& writes, std::vector<VkDescriptorBufferInfo>& bufferInfos, Ref<UniformBuffer> buffer, Descriptor descriptor);
-        void UploadStorageBuffer(std::vector<VkWriteDescriptorSet>& writes, std::vector<VkDescriptorBufferInfo>& bufferInfos, Ref<StorageBuffer> buffer, Descriptor descriptor);
+        // Note: Inline, so uploading a few bindings doesn't touch the heap
+        using WriteList = InlineVector<VkWriteDescriptorSet, 12>;
+        using ImageInfoList = InlineVector<VkDescriptorImageInfo, 12>;
+        using BufferInfoList = InlineVector<VkDescriptorBufferInfo, 12>;
+
+        void UploadImage(WriteList& writes, ImageInfoList& imageInfos, Ref<Image> image, Descriptor descriptor);
+        void UploadSampler(WriteList& writes, ImageInfoList& imageInfos, Ref<Sampler> sampler, Descriptor descriptor);
+        void UploadUniformBuffer(WriteList& writes, BufferInfoList& bufferInfos, Ref<UniformBuffer> buffer, Descriptor descriptor);
+        void UploadStorageBuffer(WriteList& writes, BufferInfoList& bufferInfos, Ref<StorageBuffer> buffer, Descriptor descriptor);
+        void UploadStaticBuffer(WriteList& writes, BufferInfoList& bufferInfos, VkBuffer buffer, VkDeviceSize size, Descriptor descriptor); // For vertex pulling
 
 	private:
 		uint32_t m_SetID = 0;
@@ -4,6 +4,7 @@
 #include "Horizon/Core/Logging.hpp"
 
 #include "Horizon/Renderer/GraphicsContext.hpp"
+#include "Horizon/Renderer/RenderThread.hpp"
 
 #include "Horizon/Vulkan/VulkanUtils.hpp"
 #include "Horizon/Vulkan/VulkanContext.hpp"
@@ -34,14 +35,32 @@ namespace Hz
 		deviceFeatures.samplerAnisotropy = VK_TRUE;
 		deviceFeatures.fillModeNonSolid = VK_TRUE;
 		deviceFeatures.wideLines = VK_TRUE;
+		deviceFeatures.textureCompressionBC = m_PhysicalDevice->SupportsCompressionBC(); // For compressed images
+		deviceFeatures.textureCompressionETC2 = m_PhysicalDevice->SupportsCompressionETC2();
+		deviceFeatures.textureCompressionASTC_LDR = m_PhysicalDevice->SupportsCompressionASTC();
+		deviceFeatures.pipelineStatisticsQuery = m_PhysicalDevice->SupportsPipelineStatistics(); // For pass statistics
+
+		// Optional features
+		VkPhysicalDeviceVulkan12Features features12 = {};
+		features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+		features12.bufferDeviceAddress = m_PhysicalDevice->SupportsBufferDeviceAddress(); // For vertex pulling
+		features12.hostQueryReset = m_PhysicalDevice->SupportsHostQueryReset(); // For GPU timings
+
+		// Optional extensions
+		std::vector<const char*> extensions = VulkanContext::s_RequestedDeviceExtensions;
+		if (m_PhysicalDevice->SupportsMemoryBudget())
+			extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME); // For memory statistics
+		if (m_PhysicalDevice->SupportsCalibratedTimestamps())
+			extensions.push_back(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME); // For aligning GPU zones with the CPU timeline
 
 		VkDeviceCreateInfo createInfo = {};
 		createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+		createInfo.pNext = &features12;
 		createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
 		createInfo.pQueueCreateInfos = queueCreateInfos.data();
 		createInfo.pEnabledFeatures = &deviceFeatures;
-		createInfo.enabledExtensionCount = static_cast<uint32_t>(VulkanContext::s_RequestedDeviceExtensions.size());
-		createInfo.ppEnabledExtensionNames = VulkanContext::s_RequestedDeviceExtensions.data();
+		createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+		createInfo.ppEnabledExtensionNames = extensions.data();
 
 		if constexpr (VulkanContext::s_Validation)
 		{
@@ -59,6 +78,8 @@ namespace Hz
 		vkGetDeviceQueue(m_LogicalDevice, indices.GraphicsFamily.value(), 0, &m_GraphicsQueue);
 		vkGetDeviceQueue(m_LogicalDevice, indices.ComputeFamily.value(), 0, &m_ComputeQueue);
 		vkGetDeviceQueue(m_LogicalDevice, indices.PresentFamily.value(), 0, &m_PresentQueue);
+
+		m_GraphicsFamily = indices.GraphicsFamily.value();
 	}
 
 	VulkanDevice::~VulkanDevice()
@@ -68,6 +89,7 @@ namespace Hz
 
 	void VulkanDevice::Wait() const
 	{
+		auto queueLock = RenderThread::Lock();
 		vkDeviceWaitIdle(m_LogicalDevice);
 	}
 
@@ -15,7 +15,7 @@ namespace Hz
 		VulkanDevice(const VkSurfaceKHR surface, Ref<VulkanPhysicalDevice> physicalDevice);
 		virtual ~VulkanDevice();
 
-		void Wait() const;
+		void Wait() const; // Note: Takes the RenderThread::Lock(), since all queues are used
 
 		inline const VkDevice GetVkDevice() const { return m_LogicalDevice; }
 
@@ -23,6 +23,8 @@ namespace Hz
 		inline const VkQueue GetComputeQueue() const { return m_ComputeQueue; }
 		inline const VkQueue GetPresentQueue() const { return m_PresentQueue; }
 
+		inline uint32_t GetGraphicsFamily() const { return m_GraphicsFamily; }
+
 		inline Ref<VulkanPhysicalDevice> GetPhysicalDevice() const { return m_PhysicalDevice; }
 
 		static Ref<VulkanDevice> Create(const VkSurfaceKHR surface, Ref<VulkanPhysicalDevice> physicalDevice);
@@ -34,6 +36,8 @@ namespace Hz
 		VkQueue m_GraphicsQueue = VK_NULL_HANDLE;
 		VkQueue m_ComputeQueue = VK_NULL_HANDLE;
 		VkQueue m_PresentQueue = VK_NULL_HANDLE;
+
+		uint32_t m_GraphicsFamily = 0;
 	};
 
 }
@@ -0,0 +1,454 @@
+#include "hzpch.h"
+#include "VulkanGpuProfiler.hpp"
+
+#include "Horizon/Core/Logging.hpp"
+#include "Horizon/Core/FrameAllocator.hpp"
+
+#include "Horizon/Vulkan/VulkanUtils.hpp"
+#include "Horizon/Vulkan/VulkanContext.hpp"
+
+#include <cstring>
+#include <algorithm>
+
+namespace Hz
+{
+
+    ///////////////////////////////////////////////////////////
+    // Profiler
+    ///////////////////////////////////////////////////////////
+    void VulkanGpuProfiler::Update()
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+        if (!s_Data.Initialized)
+            Init();
+
+        s_Data.Frame++;
+        s_Data.FrameCounters = s_Data.Counters;
+        s_Data.Counters = {};
+
+        HZ_PROFILE_PLOT("Draws", (int64_t)s_Data.FrameCounters.Draws);
+        HZ_PROFILE_PLOT("Barriers", (int64_t)s_Data.FrameCounters.Barriers);
+        HZ_PROFILE_PLOT("Elided Binds", (int64_t)(s_Data.FrameCounters.ElidedPipelineBinds + s_Data.FrameCounters.ElidedDescriptorBinds + s_Data.FrameCounters.ElidedVertexBufferBinds + s_Data.FrameCounters.ElidedIndexBufferBinds));
+
+        if (s_Data.Frames.empty())
+            return;
+
+        // Note: The frame's fences have been waited on, so its queries are done (or were never submitted)
+        uint32_t frame = Renderer::GetCurrentFrame();
+        ReadResults(frame);
+        ReadStatistics(frame);
+
+        auto device = VulkanContext::GetDevice()->GetVkDevice();
+        FrameData& data = s_Data.Frames[frame];
+        if (data.QueryCount > 0)
+            vkResetQueryPool(device, data.Pool, 0, data.QueryCount);
+        if (data.StatisticsCount > 0)
+            vkResetQueryPool(device, data.StatisticsPool, 0, data.StatisticsCount);
+
+        data.QueryCount = 0;
+        data.StatisticsCount = 0;
+        data.Zones.clear();
+        data.Passes.clear();
+        data.Frame = s_Data.Frame;
+
+        // Note: Zones & passes which were left open belong to a frame that is over.
+        // The entries themselves are kept, so the steady state doesn't reallocate them every frame.
+        for (auto& [commandBuffer, open] : s_Data.OpenZones)
+            open.clear();
+        for (auto& [commandBuffer, pass] : s_Data.OpenPasses)
+            pass = NoPass;
+
+        #if HZ_GPU_PROFILING
+        s_Data.TracyCollected = false;
+        #endif
+    }
+
+    void VulkanGpuProfiler::Destroy()
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+        auto device = VulkanContext::GetDevice()->GetVkDevice();
+
+        #if HZ_GPU_PROFILING
+        s_Data.TracyZones.clear();
+        if (s_Data.TracyContext)
+            TracyVkDestroy(s_Data.TracyContext);
+        #endif
+
+        for (auto& frame : s_Data.Frames)
+        {
+            if (frame.Pool != VK_NULL_HANDLE)
+                vkDestroyQueryPool(device, frame.Pool, nullptr);
+            if (frame.StatisticsPool != VK_NULL_HANDLE)
+                vkDestroyQueryPool(device, frame.StatisticsPool, nullptr);
+        }
+
+        s_Data = {};
+    }
+
+    void VulkanGpuProfiler::BeginCommandBuffer(VkCommandBuffer commandBuffer)
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+
+        #if HZ_GPU_PROFILING
+        // Note: Collecting resets Tracy's queries, which may only happen outside of a render pass
+        if (s_Data.TracyContext && !s_Data.TracyCollected)
+        {
+            TracyVkCollect(s_Data.TracyContext, commandBuffer);
+            s_Data.TracyCollected = true;
+        }
+        #endif
+
+        if (s_Data.Frames.empty())
+            return;
+
+        FrameData& data = s_Data.Frames[Renderer::GetCurrentFrame()];
+
+        Pass pass = { commandBuffer };
+        if (data.StatisticsPool != VK_NULL_HANDLE && data.StatisticsCount < MaxPasses)
+        {
+            pass.Query = data.StatisticsCount++;
+            vkCmdBeginQuery(commandBuffer, data.StatisticsPool, pass.Query, 0);
+        }
+
+        s_Data.OpenPasses[commandBuffer] = data.Passes.size();
+        data.Passes.push_back(pass);
+    }
+
+    void VulkanGpuProfiler::EndCommandBuffer(VkCommandBuffer commandBuffer, const RenderCounters& counters)
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+
+        if (auto it = s_Data.OpenZones.find(commandBuffer); it != s_Data.OpenZones.end())
+        {
+            while (!it->second.empty())
+                EndZoneInternal(commandBuffer);
+        }
+
+        RenderCounters& total = s_Data.Counters;
+        total.Draws += counters.Draws;
+        total.Dispatches += counters.Dispatches;
+        total.PipelineBinds += counters.PipelineBinds;
+        total.DescriptorBinds += counters.DescriptorBinds;
+        total.VertexBufferBinds += counters.VertexBufferBinds;
+        total.IndexBufferBinds += counters.IndexBufferBinds;
+        total.Barriers += counters.Barriers;
+        total.ElidedPipelineBinds += counters.ElidedPipelineBinds;
+        total.ElidedDescriptorBinds += counters.ElidedDescriptorBinds;
+        total.ElidedVertexBufferBinds += counters.ElidedVertexBufferBinds;
+        total.ElidedIndexBufferBinds += counters.ElidedIndexBufferBinds;
+        total.ElidedViewports += counters.ElidedViewports;
+        total.ElidedScissors += counters.ElidedScissors;
+
+        auto it = s_Data.OpenPasses.find(commandBuffer);
+        if (it == s_Data.OpenPasses.end() || it->second == NoPass)
+            return;
+
+        Pass& pass = s_Data.Frames[Renderer::GetCurrentFrame()].Passes[it->second];
+        if (pass.Query != NoQuery)
+            vkCmdEndQuery(commandBuffer, s_Data.Frames[Renderer::GetCurrentFrame()].StatisticsPool, pass.Query);
+
+        pass.Counters = counters;
+        pass.Ended = true;
+
+        it->second = NoPass;
+    }
+
+    void VulkanGpuProfiler::BeginZone(VkCommandBuffer commandBuffer, const char* name)
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+        if (s_Data.Frames.empty() || s_Data.Frames[Renderer::GetCurrentFrame()].Pool == VK_NULL_HANDLE)
+            return;
+
+        FrameData& data = s_Data.Frames[Renderer::GetCurrentFrame()];
+        std::vector<size_t>& open = s_Data.OpenZones[commandBuffer];
+
+        Zone zone = { name, (uint32_t)open.size() };
+        if (data.QueryCount + 2 <= MaxQueries) // Note: When we run out of queries the zone is still tracked, but never measured
+        {
+            zone.BeginQuery = data.QueryCount++;
+            zone.EndQuery = data.QueryCount++;
+
+            vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, data.Pool, zone.BeginQuery);
+        }
+
+        open.push_back(data.Zones.size());
+        data.Zones.push_back(zone);
+
+        #if HZ_GPU_PROFILING
+        if (s_Data.TracyContext)
+            s_Data.TracyZones[commandBuffer].push_back(std::make_unique<tracy::VkCtxScope>(s_Data.TracyContext, __LINE__, __FILE__, std::strlen(__FILE__), __FUNCTION__, std::strlen(__FUNCTION__), name, std::strlen(name), commandBuffer, true));
+        #endif
+    }
+
+    void VulkanGpuProfiler::EndZone(VkCommandBuffer commandBuffer)
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+        EndZoneInternal(commandBuffer);
+    }
+
+    void VulkanGpuProfiler::CountBarrier()
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+        s_Data.Counters.Barriers++;
+    }
+
+    GpuTimings VulkanGpuProfiler::GetTimings()
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+        return s_Data.Timings;
+    }
+
+    RenderCounters VulkanGpuProfiler::GetFrameCounters()
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+        return s_Data.FrameCounters;
+    }
+
+    PassStatistics VulkanGpuProfiler::GetPassStatistics(const std::vector<VkCommandBuffer>& commandBuffers)
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+
+        PassStatistics statistics = {};
+        for (VkCommandBuffer commandBuffer : commandBuffers)
+        {
+            if (auto it = s_Data.PassResults.find(commandBuffer); it != s_Data.PassResults.end() && it->second.Frame >= statistics.Frame)
+                statistics = it->second;
+        }
+
+        return statistics;
+    }
+
+    void VulkanGpuProfiler::Forget(const std::vector<VkCommandBuffer>& commandBuffers)
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+
+        // Note: Handles get reused by the driver, so the results may not outlive them
+        for (VkCommandBuffer commandBuffer : commandBuffers)
+        {
+            s_Data.PassResults.erase(commandBuffer);
+            s_Data.OpenPasses.erase(commandBuffer);
+            s_Data.OpenZones.erase(commandBuffer);
+
+            #if HZ_GPU_PROFILING
+            s_Data.TracyZones.erase(commandBuffer);
+            #endif
+        }
+    }
+
+    void VulkanGpuProfiler::Init()
+    {
+        s_Data.Initialized = true;
+        s_Data.Frames.resize((size_t)Renderer::GetSpecification().Buffers);
+
+        auto physicalDevice = VulkanContext::GetPhysicalDevice();
+        auto device = VulkanContext::GetDevice()->GetVkDevice();
+
+        // Note: Without host query reset we'd have to reset the pools on a command buffer
+        // that is guaranteed to execute first, which we can't know, so we don't query anything.
+        if (!physicalDevice->SupportsHostQueryReset())
+        {
+            HZ_LOG_WARN("Device doesn't support host query reset, GPU timings & pipeline statistics are disabled.");
+            return;
+        }
+
+        VkPhysicalDeviceProperties properties = {};
+        vkGetPhysicalDeviceProperties(physicalDevice->GetVkPhysicalDevice(), &properties);
+
+        if (properties.limits.timestampComputeAndGraphics)
+        {
+            uint32_t familyCount = 0;
+            vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice->GetVkPhysicalDevice(), &familyCount, nullptr);
+
+            std::vector<VkQueueFamilyProperties> families(familyCount);
+            vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice->GetVkPhysicalDevice(), &familyCount, families.data());
+
+            uint32_t validBits = 64;
+            for (const auto& family : families)
+            {
+                if ((family.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) && family.timestampValidBits > 0)
+                    validBits = std::min(validBits, family.timestampValidBits);
+            }
+
+            s_Data.TimestampPeriod = (double)properties.limits.timestampPeriod;
+            s_Data.TimestampMask = (validBits >= 64 ? Pulse::Numeric::Max<uint64_t>() : ((1ull << validBits) - 1));
+
+            VkQueryPoolCreateInfo poolInfo = {};
+            poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+            poolInfo.queryCount = MaxQueries;
+
+            for (auto& frame : s_Data.Frames)
+            {
+                VK_CHECK_RESULT(vkCreateQueryPool(device, &poolInfo, nullptr, &frame.Pool));
+                vkResetQueryPool(device, frame.Pool, 0, MaxQueries);
+            }
+
+            s_Data.Timings.Supported = true;
+        }
+        else
+        {
+            HZ_LOG_WARN("Device doesn't support timestamp queries, GPU timings are disabled.");
+        }
+
+        if (physicalDevice->SupportsPipelineStatistics())
+        {
+            VkQueryPoolCreateInfo poolInfo = {};
+            poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            poolInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+            poolInfo.queryCount = MaxPasses;
+            poolInfo.pipelineStatistics = StatisticFlags;
+
+            for (auto& frame : s_Data.Frames)
+            {
+                VK_CHECK_RESULT(vkCreateQueryPool(device, &poolInfo, nullptr, &frame.StatisticsPool));
+                vkResetQueryPool(device, frame.StatisticsPool, 0, MaxPasses);
+            }
+        }
+
+        #if HZ_GPU_PROFILING
+        if (s_Data.Timings.Supported)
+        {
+            VkCommandBufferAllocateInfo allocInfo = {};
+            allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocInfo.commandPool = VulkanContext::GetSwapChain()->GetVkCommandPool();
+            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            allocInfo.commandBufferCount = 1;
+
+            // Note: Tracy records and submits its initial calibration on this command buffer
+            VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+            VK_CHECK_RESULT(vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer));
+
+            // Note: Tracy submits to & waits on the queue
+            auto queueLock = RenderThread::Lock();
+
+            VkQueue queue = VulkanContext::GetDevice()->GetGraphicsQueue();
+            if (physicalDevice->SupportsCalibratedTimestamps())
+            {
+                auto getTimeDomains = (PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT)vkGetInstanceProcAddr(VulkanContext::GetVkInstance(), "vkGetPhysicalDeviceCalibrateableTimeDomainsEXT");
+                auto getTimestamps = (PFN_vkGetCalibratedTimestampsEXT)vkGetDeviceProcAddr(device, "vkGetCalibratedTimestampsEXT");
+
+                s_Data.TracyContext = TracyVkContextCalibrated(physicalDevice->GetVkPhysicalDevice(), device, queue, commandBuffer, getTimeDomains, getTimestamps);
+            }
+            else
+            {
+                s_Data.TracyContext = TracyVkContext(physicalDevice->GetVkPhysicalDevice(), device, queue, commandBuffer);
+            }
+
+            vkFreeCommandBuffers(device, allocInfo.commandPool, 1, &commandBuffer);
+        }
+        #endif
+    }
+
+    void VulkanGpuProfiler::ReadResults(uint32_t frame)
+    {
+        FrameData& data = s_Data.Frames[frame];
+        if (data.QueryCount == 0)
+            return;
+
+        // Note: Every query returns its value followed by its availability
+        FrameVector<uint64_t> results((size_t)data.QueryCount * 2);
+        VkResult result = vkGetQueryPoolResults(VulkanContext::GetDevice()->GetVkDevice(), data.Pool, 0, data.QueryCount, results.size() * sizeof(uint64_t), results.data(), 2 * sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+        if (result != VK_SUCCESS && result != VK_NOT_READY) // Note: Not ready means some command buffers were never submitted
+            return;
+
+        auto available = [&results](uint32_t query) { return (query != NoQuery && results[(size_t)query * 2 + 1] != 0); };
+        auto timestamp = [&results](uint32_t query) { return (results[(size_t)query * 2] & s_Data.TimestampMask); };
+        auto toMilliseconds = [](uint64_t ticks) { return ((double)(ticks & s_Data.TimestampMask) * s_Data.TimestampPeriod) / 1'000'000.0; };
+
+        uint64_t first = Pulse::Numeric::Max<uint64_t>();
+        uint64_t last = 0;
+        for (const auto& zone : data.Zones)
+        {
+            if (!available(zone.BeginQuery) || !available(zone.EndQuery))
+                continue;
+
+            first = std::min(first, timestamp(zone.BeginQuery));
+            last = std::max(last, timestamp(zone.EndQuery));
+        }
+
+        GpuTimings& timings = s_Data.Timings;
+        timings.Zones.clear();
+        timings.Frame = data.Frame;
+        timings.FrameTime = (last > first ? toMilliseconds(last - first) : 0.0);
+
+        for (const auto& zone : data.Zones)
+        {
+            if (!available(zone.BeginQuery) || !available(zone.EndQuery))
+                continue;
+
+            GpuZoneTiming& timing = timings.Zones.emplace_back();
+            timing.Name = zone.Name;
+            timing.Depth = zone.Depth;
+            timing.Start = toMilliseconds(timestamp(zone.BeginQuery) - first);
+            timing.Duration = toMilliseconds(timestamp(zone.EndQuery) - timestamp(zone.BeginQuery));
+        }
+
+        HZ_PROFILE_PLOT("GPU FrameTime", timings.FrameTime);
+    }
+
+    void VulkanGpuProfiler::ReadStatistics(uint32_t frame)
+    {
+        FrameData& data = s_Data.Frames[frame];
+
+        // Note: Every query returns its statistics (in bit order) followed by its availability
+        constexpr const uint32_t stride = StatisticCount + 1;
+
+        FrameVector<uint64_t> results = { };
+        if (data.StatisticsCount > 0)
+        {
+            results.resize((size_t)data.StatisticsCount * stride);
+
+            VkResult result = vkGetQueryPoolResults(VulkanContext::GetDevice()->GetVkDevice(), data.StatisticsPool, 0, data.StatisticsCount, results.size() * sizeof(uint64_t), results.data(), stride * sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+            if (result != VK_SUCCESS && result != VK_NOT_READY)
+                results.clear();
+        }
+
+        for (const auto& pass : data.Passes)
+        {
+            if (!pass.Ended)
+                continue;
+
+            PassStatistics statistics = {};
+            statistics.Counters = pass.Counters;
+            statistics.Frame = data.Frame;
+
+            if (pass.Query != NoQuery && !results.empty())
+            {
+                const uint64_t* values = &results[(size_t)pass.Query * stride];
+                if (values[StatisticCount] == 0) // Note: The recording was never submitted, so we keep the previous results
+                    continue;
+
+                statistics.Pipeline.InputVertices = values[0];
+                statistics.Pipeline.InputPrimitives = values[1];
+                statistics.Pipeline.VertexInvocations = values[2];
+                statistics.Pipeline.ClippingInvocations = values[3];
+                statistics.Pipeline.ClippingPrimitives = values[4];
+                statistics.Pipeline.FragmentInvocations = values[5];
+                statistics.Pipeline.ComputeInvocations = values[6];
+                statistics.Available = true;
+            }
+
+            s_Data.PassResults[pass.CommandBuffer] = statistics;
+        }
+    }
+
+    void VulkanGpuProfiler::EndZoneInternal(VkCommandBuffer commandBuffer)
+    {
+        #if HZ_GPU_PROFILING
+        if (auto it = s_Data.TracyZones.find(commandBuffer); it != s_Data.TracyZones.end() && !it->second.empty())
+            it->second.pop_back(); // Note: Destroying the scope records the end of the Tracy zone
+        #endif
+
+        auto it = s_Data.OpenZones.find(commandBuffer);
+        if (it == s_Data.OpenZones.end() || it->second.empty())
+            return;
+
+        FrameData& data = s_Data.Frames[Renderer::GetCurrentFrame()];
+        Zone& zone = data.Zones[it->second.back()];
+        it->second.pop_back();
+
+        if (zone.EndQuery != NoQuery)
+            vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, data.Pool, zone.EndQuery);
+    }
+
+}
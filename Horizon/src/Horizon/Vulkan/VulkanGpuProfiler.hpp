@@ -0,0 +1,132 @@
+#pragma once
+
+#include "Horizon/Core/Core.hpp"
+
+#include "Horizon/Renderer/Renderer.hpp"
+
+#include "Horizon/Utils/Profiler.hpp"
+
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+
+#include <vulkan/vulkan.h>
+
+// Note: Tracy's Vulkan context only exists when Tracy itself is enabled
+#if defined(TRACY_ENABLE) && !defined(HZ_DIST) && HZ_ENABLE_PROFILING
+    #define HZ_GPU_PROFILING 1
+    #include <tracy/TracyVulkan.hpp>
+#else
+    #define HZ_GPU_PROFILING 0
+#endif
+
+namespace Hz
+{
+
+    // Measures GPU zones with timestamp queries and every command buffer recording with a pipeline statistics query,
+    // every frame in flight has its own query pools which get read back (and host reset) once the frame's fences have been waited on.
+    // Note: When profiling is enabled the zones are also sent to Tracy as GPU zones (calibrated when the device supports it).
+    class VulkanGpuProfiler
+    {
+    public:
+        static void Update(); // Note: Gets called by the renderer every frame after waiting on the frame's fences
+        static void Destroy();
+
+        static void BeginCommandBuffer(VkCommandBuffer commandBuffer); // Note: Must be called outside of a render pass
+        static void EndCommandBuffer(VkCommandBuffer commandBuffer, const RenderCounters& counters); // Note: Closes all zones still open on the command buffer
+
+        static void BeginZone(VkCommandBuffer commandBuffer, const char* name); // Note: name needs to be a string literal (or have a static lifetime)
+        static void EndZone(VkCommandBuffer commandBuffer);
+
+        static void CountBarrier(); // Note: Counts towards the frame counters
+
+        static GpuTimings GetTimings(); // Note: Returns a copy, since the render thread updates them
+        static RenderCounters GetFrameCounters(); // Note: Returns a copy, since the render thread updates them
+
+        static PassStatistics GetPassStatistics(const std::vector<VkCommandBuffer>& commandBuffers); // Returns the most recent statistics of the handles
+        static void Forget(const std::vector<VkCommandBuffer>& commandBuffers); // Note: Gets called right before the handles are freed
+
+    private:
+        static void Init();
+
+        static void ReadResults(uint32_t frame);
+        static void ReadStatistics(uint32_t frame);
+        static void EndZoneInternal(VkCommandBuffer commandBuffer);
+
+        struct Zone
+        {
+        public:
+            const char* Name = nullptr;
+            uint32_t Depth = 0;
+
+            uint32_t BeginQuery = NoQuery;
+            uint32_t EndQuery = NoQuery;
+        };
+
+        struct Pass
+        {
+        public:
+            VkCommandBuffer CommandBuffer = VK_NULL_HANDLE;
+            uint32_t Query = NoQuery;
+
+            RenderCounters Counters = { };
+            bool Ended = false;
+        };
+
+        struct FrameData
+        {
+        public:
+            VkQueryPool Pool = VK_NULL_HANDLE;
+            uint32_t QueryCount = 0;
+
+            VkQueryPool StatisticsPool = VK_NULL_HANDLE;
+            uint32_t StatisticsCount = 0;
+
+            std::vector<Zone> Zones = { };
+            std::vector<Pass> Passes = { };
+            uint64_t Frame = 0;
+        };
+
+        // Note: We store our info in a struct, so we can ensure lifetime
+        // of all objects easily while the class remains static.
+        struct Info
+        {
+        public:
+            bool Initialized = false;
+
+            std::vector<FrameData> Frames = { };
+            std::unordered_map<VkCommandBuffer, std::vector<size_t>> OpenZones = { }; // Indices into the current frame's zones
+            std::unordered_map<VkCommandBuffer, size_t> OpenPasses = { }; // Indices into the current frame's passes
+            std::unordered_map<VkCommandBuffer, PassStatistics> PassResults = { };
+
+            double TimestampPeriod = 0.0;   // Nanoseconds per tick
+            uint64_t TimestampMask = 0;     // Note: Not every queue has 64 valid timestamp bits
+
+            uint64_t Frame = 0;
+            GpuTimings Timings = { };
+
+            RenderCounters Counters = { };      // Of the frame being recorded
+            RenderCounters FrameCounters = { }; // Of the last frame
+
+            #if HZ_GPU_PROFILING
+            TracyVkCtx TracyContext = nullptr;
+            bool TracyCollected = false;
+
+            std::unordered_map<VkCommandBuffer, std::vector<std::unique_ptr<tracy::VkCtxScope>>> TracyZones = { };
+            #endif
+        };
+
+        inline static std::mutex s_Mutex = {};
+        inline static Info s_Data = {};
+
+    public:
+        inline static constexpr const uint32_t MaxQueries = 1024; // Per frame in flight, every zone uses 2
+        inline static constexpr const uint32_t MaxPasses = 256; // Per frame in flight
+        inline static constexpr const VkQueryPipelineStatisticFlags StatisticFlags = VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT | VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT | VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT | VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT | VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT | VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT | VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+        inline static constexpr const uint32_t StatisticCount = 7; // Set bits in StatisticFlags
+        inline static constexpr const uint32_t NoQuery = UINT32_MAX;
+        inline static constexpr const size_t NoPass = SIZE_MAX;
+    };
+
+}
@@ -6,15 +6,22 @@
 #include "Horizon/Renderer/Renderer.hpp"
 #include "Horizon/Renderer/GraphicsContext.hpp"
 #include "Horizon/Renderer/Descriptors.hpp"
+#include "Horizon/Renderer/ImageDecoder.hpp"
 
 #include "Horizon/Vulkan/VulkanUtils.hpp"
 #include "Horizon/Vulkan/VulkanContext.hpp"
 #include "Horizon/Vulkan/VulkanDescriptors.hpp"
 #include "Horizon/Vulkan/VulkanCommandBuffer.hpp"
+#include "Horizon/Vulkan/VulkanImageLoader.hpp"
+#include "Horizon/Vulkan/VulkanMipGenerator.hpp"
+#include "Horizon/Vulkan/VulkanSampler.hpp"
+#include "Horizon/Vulkan/VulkanRenderTargetPool.hpp"
+#include "Horizon/Vulkan/VulkanRenderpassCache.hpp"
+#include "Horizon/Vulkan/VulkanGpuProfiler.hpp"
 
-#include <Pulse/Enum/Enum.hpp>
+#include "Horizon/Utils/Profiler.hpp"
 
-#include <stb_image.h>
+#include <Pulse/Enum/Enum.hpp>
 
 namespace Hz
 {
@@ -25,6 +32,25 @@ namespace Hz
 		: m_Specification(specs), m_SamplerSpecification(samplerSpecs)
 	{
         HZ_ASSERT(((m_Specification.Flags & ImageUsageFlags::Colour) || (m_Specification.Flags & ImageUsageFlags::DepthStencil)), "Tried to create image without specifying if it's a Colour or Depth image.")
+        HZ_ASSERT(((m_Specification.ViewType != ImageViewType::Cube) || (m_Specification.Layers == 6)), "Cubemaps require 6 layers.");
+        HZ_ASSERT(((m_Specification.ViewType != ImageViewType::CubeArray) || (m_Specification.Layers % 6 == 0)), "Cubemap arrays require a multiple of 6 layers.");
+        HZ_ASSERT(((m_Specification.ViewType == ImageViewType::Type3D) || (m_Specification.Depth == 1)), "Only 3D images can have a depth.");
+        HZ_ASSERT(((m_Specification.ViewType != ImageViewType::Type3D) || (m_Specification.Layers == 1)), "3D images can't have multiple layers.");
+        HZ_ASSERT(((m_Specification.Usage != ImageUsage::File) || (m_Specification.ViewType == ImageViewType::Type2D)), "Images loaded from a file are always 2D, use SetLayerData to fill arrays & cubemaps.");
+        HZ_ASSERT((!(m_Specification.Flags & ImageUsageFlags::Transient) || ((VkImageUsageFlags)m_Specification.Flags & ~(VkImageUsageFlags)(ImageUsageFlags::Transient | ImageUsageFlags::Colour | ImageUsageFlags::DepthStencil | ImageUsageFlags::Input)) == 0), "Transient images can only be used as attachments.");
+
+        if (m_Specification.Samples != SampleCount::Count1)
+        {
+            HZ_ASSERT((m_Specification.Usage == ImageUsage::Size && m_Specification.ViewType == ImageViewType::Type2D), "Multisampled images need to be 2D images created with a size.");
+            HZ_ASSERT(SampleCountSupported(m_Specification.Samples, m_Specification.Flags), "Sample count {0} isn't supported by the device.", (uint32_t)m_Specification.Samples);
+
+            // Note: Multisampled images which are only rendered to (and resolved) never need backing memory on tilers
+            const ImageUsageFlags attachmentFlags = ImageUsageFlags::Colour | ImageUsageFlags::DepthStencil | ImageUsageFlags::Input | ImageUsageFlags::Transient;
+            if (((VkImageUsageFlags)m_Specification.Flags & ~(VkImageUsageFlags)attachmentFlags) == 0)
+                m_Specification.Flags = m_Specification.Flags | ImageUsageFlags::Transient;
+
+            m_Specification.MipMaps = false;
+        }
 
         switch (m_Specification.Usage)
 		{
@@ -41,6 +67,32 @@ namespace Hz
 		}
     }
 
+    Ref<VulkanImage> VulkanImage::CreateAsync(const ImageSpecification& specs, const SamplerSpecification& samplerSpecs)
+    {
+        HZ_ASSERT((specs.Usage == ImageUsage::File), "Only images loaded from a file can be created asynchronously.");
+
+        // Note: A 1x1 magenta placeholder is used until the file has been uploaded
+        ImageSpecification placeholderSpecs = specs;
+        placeholderSpecs.Usage = ImageUsage::Size;
+        placeholderSpecs.Format = ImageFormat::RGBA;
+        placeholderSpecs.Width = 1;
+        placeholderSpecs.Height = 1;
+        placeholderSpecs.MipMaps = false;
+
+        Ref<VulkanImage> image = Ref<VulkanImage>::Create(placeholderSpecs, samplerSpecs);
+
+        uint32_t pixel = 0xFFFF00FF;
+        image->SetData((void*)&pixel, sizeof(uint32_t));
+
+        image->m_Specification.Usage = specs.Usage;
+        image->m_Specification.Path = specs.Path;
+        image->m_Specification.MipMaps = specs.MipMaps;
+        image->m_Loading = true;
+
+        VulkanImageLoader::Load(image.Raw(), specs.Path);
+        return image;
+    }
+
     VulkanImage::VulkanImage(const ImageSpecification& specs, const VkImage image, const VkImageView imageView)
         : m_Specification(specs), m_SamplerSpecification({}), m_Image(image), m_ImageView(imageView) // For SwapChain
     {
@@ -48,12 +100,37 @@ namespace Hz
 
 	VulkanImage::~VulkanImage()
 	{
+        if (m_Loading.load(std::memory_order_acquire))
+            VulkanImageLoader::Cancel(this);
+
         Destroy();
 	}
 
 	void VulkanImage::SetData(void* data, size_t size)
 	{
-        ImageLayout desiredLayout = m_Specification.Layout;
+		VkBuffer stagingBuffer = VK_NULL_HANDLE;
+		VmaAllocation stagingBufferAllocation = VK_NULL_HANDLE;
+		stagingBufferAllocation = VkUtils::Allocator::AllocateBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY, stagingBuffer);
+
+		void* mappedData;
+		VkUtils::Allocator::MapMemory(stagingBufferAllocation, mappedData);
+		memcpy(mappedData, data, size);
+		VkUtils::Allocator::UnMapMemory(stagingBufferAllocation);
+
+		// Note: Block compressed formats can't be downsampled, so only the first level gets uploaded
+		bool generateMips = (m_Specification.MipMaps && m_Miplevels > 1 && !ImageFormatInfo::Get(m_Specification.Format).Compressed);
+
+		// Note: The copy, mips & transitions all go into a single submission
+		VulkanCommand command = VulkanCommand(true);
+		RecordCopy(command.GetVkCommandBuffer(), stagingBuffer, 0, { { 0, size, m_Specification.Width, m_Specification.Height } }, generateMips, 0, m_Specification.Layers);
+		command.EndAndSubmit();
+
+		VkUtils::Allocator::DestroyBuffer(stagingBuffer, stagingBufferAllocation);
+	}
+
+	void VulkanImage::SetLayerData(uint32_t layer, void* data, size_t size)
+	{
+		HZ_ASSERT((layer < m_Specification.Layers), "Layer {0} is out of range, the image has {1} layers.", layer, m_Specification.Layers);
 
 		VkBuffer stagingBuffer = VK_NULL_HANDLE;
 		VmaAllocation stagingBufferAllocation = VK_NULL_HANDLE;
@@ -64,18 +141,12 @@ namespace Hz
 		memcpy(mappedData, data, size);
 		VkUtils::Allocator::UnMapMemory(stagingBufferAllocation);
 
-        Transition(ImageLayout::Undefined, ImageLayout::TransferDst);
-		VkUtils::Allocator::CopyBufferToImage(stagingBuffer, m_Image, m_Specification.Width, m_Specification.Height);
+		bool generateMips = (m_Specification.MipMaps && m_Miplevels > 1 && !ImageFormatInfo::Get(m_Specification.Format).Compressed);
 
-		if (m_Specification.MipMaps)
-		{
-			GenerateMipmaps(m_Image, (VkFormat)m_Specification.Format, m_Specification.Width, m_Specification.Height, m_Miplevels);
-			Transition(ImageLayout::ShaderRead, desiredLayout);
-		}
-		else
-		{
-            Transition(ImageLayout::TransferDst, desiredLayout);
-		}
+		// Note: Only this layer gets transitioned, so the other layers keep their contents
+		VulkanCommand command = VulkanCommand(true);
+		RecordCopy(command.GetVkCommandBuffer(), stagingBuffer, 0, { { 0, size, m_Specification.Width, m_Specification.Height } }, generateMips, layer, 1);
+		command.EndAndSubmit();
 
 		VkUtils::Allocator::DestroyBuffer(stagingBuffer, stagingBufferAllocation);
 	}
@@ -104,7 +175,7 @@ namespace Hz
 		barrier.subresourceRange.baseMipLevel = 0;
 		barrier.subresourceRange.levelCount = m_Miplevels;
 		barrier.subresourceRange.baseArrayLayer = 0;
-		barrier.subresourceRange.layerCount = 1;
+		barrier.subresourceRange.layerCount = m_Specification.Layers;
 
 		VkPipelineStageFlags sourceStage = {};
 		VkPipelineStageFlags destinationStage = {};
@@ -299,6 +370,7 @@ namespace Hz
         }
 
         vkCmdPipelineBarrier(command.GetVkCommandBuffer(), sourceStage, destinationStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+        VulkanGpuProfiler::CountBarrier();
 
 		command.EndAndSubmit();
 	}
@@ -307,64 +379,192 @@ namespace Hz
 	{
 		m_Specification.Width = width;
 		m_Specification.Height = height;
-		if (m_Specification.MipMaps)
-			m_Miplevels = static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1;
+		if (m_Specification.MipMaps && !ImageFormatInfo::Get(m_Specification.Format).Compressed)
+			m_Miplevels = static_cast<uint32_t>(std::floor(std::log2(std::max({ width, height, m_Specification.Depth })))) + 1;
 
-		m_Allocation = VkUtils::Allocator::AllocateImage(width, height, m_Miplevels, (VkFormat)m_Specification.Format, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | (VkImageUsageFlagBits)m_Specification.Flags, VMA_MEMORY_USAGE_GPU_ONLY, m_Image);
+		// Note: Render targets get their memory from the pool, so recreating them reuses previously released memory
+		m_Pooled = UsesPool();
+		if (m_Pooled)
+			m_Allocation = VulkanRenderTargetPool::Acquire(GetVkImageCreateInfo(), m_Image);
+		else
+			m_Allocation = VkUtils::Allocator::AllocateImage(GetVkImageCreateInfo(), VMA_MEMORY_USAGE_GPU_ONLY, m_Image);
 
-		m_ImageView = VkUtils::Allocator::CreateImageView(m_Image, (VkFormat)m_Specification.Format, GetVulkanImageAspectFromImageUsage(m_Specification.Flags), m_Miplevels);
-		m_Sampler = VkUtils::Allocator::CreateSampler((VkFilter)m_SamplerSpecification.MagFilter, (VkFilter)m_SamplerSpecification.MinFilter, (VkSamplerAddressMode)m_SamplerSpecification.Address, (VkSamplerMipmapMode)m_SamplerSpecification.Mipmaps, m_Miplevels);
+		m_ImageView = VkUtils::Allocator::CreateImageView(m_Image, (VkFormat)m_Specification.Format, GetVulkanImageAspectFromImageUsage(m_Specification.Flags), m_Miplevels, (VkImageViewType)m_Specification.ViewType, m_Specification.Layers);
+		m_Sampler = VulkanSamplerCache::Get(m_SamplerSpecification);
 
 		Transition(ImageLayout::Undefined, m_Specification.Layout);
 	}
 
 	void VulkanImage::CreateImage(const std::filesystem::path& path)
 	{
-		int width, height, texChannels;
-		stbi_uc* pixels = stbi_load(path.string().c_str(), &width, &height, &texChannels, STBI_rgb_alpha);
+		if (ImageFile::IsContainer(path))
+		{
+			auto data = ImageFile::Load(path);
+			HZ_ASSERT(data.has_value(), "Failed to load image from '{0}'", path.string());
 
-        HZ_ASSERT((pixels != nullptr), "Failed to load image from '{0}'", path.string());
+			CreateImage(data.value());
+			VulkanDefragmenter::Register(m_Allocation, this);
+			return;
+		}
 
-		m_Specification.Width = width;
-		m_Specification.Height = height;
-		if (m_Specification.MipMaps)
-			m_Miplevels = static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1;
+		// Note: We query the size first, so the staging buffer can be allocated before the decoded pixels are copied into it
+		ImageFileData data = {};
+		data.Format = ImageFormat::RGBA;
+
+		bool found = ImageDecoder::Info(path, data.Width, data.Height);
+        HZ_ASSERT(found, "Failed to load image from '{0}'", path.string());
+
+		size_t imageSize = (size_t)data.Width * data.Height * 4;
+		data.Levels.push_back({ 0, imageSize, data.Width, data.Height });
+
+		VkBuffer stagingBuffer = VK_NULL_HANDLE;
+		VmaAllocation stagingBufferAllocation = VK_NULL_HANDLE;
+		stagingBufferAllocation = VkUtils::Allocator::AllocateBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY, stagingBuffer);
+
+		void* mappedData;
+		VkUtils::Allocator::MapMemory(stagingBufferAllocation, mappedData);
+		bool decoded = ImageDecoder::DecodeInto(path, mappedData, imageSize);
+		VkUtils::Allocator::UnMapMemory(stagingBufferAllocation);
 
-		m_Specification.Format = ImageFormat::RGBA;
-		size_t imageSize = m_Specification.Width * m_Specification.Height * 4;
+        HZ_ASSERT(decoded, "Failed to load image from '{0}'", path.string());
 
-		m_Allocation = VkUtils::Allocator::AllocateImage(m_Specification.Width, m_Specification.Height, m_Miplevels, (VkFormat)m_Specification.Format, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | (VkImageUsageFlagBits)m_Specification.Flags, VMA_MEMORY_USAGE_GPU_ONLY, m_Image);
+		VulkanCommand command = VulkanCommand(true);
+		RecordUpload(command.GetVkCommandBuffer(), stagingBuffer, 0, data);
+		command.EndAndSubmit();
 
-		m_ImageView = VkUtils::Allocator::CreateImageView(m_Image, (VkFormat)m_Specification.Format, VK_IMAGE_ASPECT_COLOR_BIT, m_Miplevels);
-		m_Sampler = VkUtils::Allocator::CreateSampler((VkFilter)m_SamplerSpecification.MagFilter, (VkFilter)m_SamplerSpecification.MinFilter, (VkSamplerAddressMode)m_SamplerSpecification.Address, (VkSamplerMipmapMode)m_SamplerSpecification.Mipmaps, m_Miplevels);
+		VkUtils::Allocator::DestroyBuffer(stagingBuffer, stagingBufferAllocation);
 
-		SetData((void*)pixels, imageSize);
-		stbi_image_free((void*)pixels);
+        VulkanDefragmenter::Register(m_Allocation, this);
 	}
 
-	void VulkanImage::GenerateMipmaps(VkImage& image, VkFormat imageFormat, int32_t texWidth, int32_t texHeight, uint32_t mipLevels)
+	void VulkanImage::CreateImage(const ImageFileData& data)
 	{
-		// Check if image format supports linear blitting
-		VkFormatProperties formatProperties;
-		vkGetPhysicalDeviceFormatProperties(VulkanContext::GetPhysicalDevice()->GetVkPhysicalDevice(), imageFormat, &formatProperties);
-        HZ_VERIFY(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT, "Texture image format does not support linear blitting!");
+		HZ_PROFILE_SCOPE("VulkanImage::CreateImage");
+
+		VkBuffer stagingBuffer = VK_NULL_HANDLE;
+		VmaAllocation stagingBufferAllocation = VK_NULL_HANDLE;
+		stagingBufferAllocation = VkUtils::Allocator::AllocateBuffer(data.Data.size(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY, stagingBuffer);
+
+		void* mappedData;
+		VkUtils::Allocator::MapMemory(stagingBufferAllocation, mappedData);
+		memcpy(mappedData, data.Data.data(), data.Data.size());
+		VkUtils::Allocator::UnMapMemory(stagingBufferAllocation);
 
 		VulkanCommand command = VulkanCommand(true);
+		RecordUpload(command.GetVkCommandBuffer(), stagingBuffer, 0, data);
+		command.EndAndSubmit();
+
+		VkUtils::Allocator::DestroyBuffer(stagingBuffer, stagingBufferAllocation);
+	}
+
+	void VulkanImage::RecordUpload(VkCommandBuffer cmdBuf, VkBuffer stagingBuffer, size_t offset, const ImageFileData& data)
+	{
+		HZ_ASSERT(FormatSupported(data.Format), "Image format {0} of '{1}' is not supported by the device.", (uint32_t)data.Format, m_Specification.Path.string());
+
+		bool generateMips = (m_Specification.MipMaps && data.Levels.size() == 1 && !ImageFormatInfo::Get(data.Format).Compressed);
+
+		// Replace the previous image (a placeholder for example)
+		// Note: Its handles are freed once the frames in flight are done, so readers may still get them until the swap below
+		if (m_Image != VK_NULL_HANDLE)
+			Destroy();
+
+		{
+			std::scoped_lock<std::mutex> lock(s_HandleMutex);
+
+			m_Specification.Width = data.Width;
+			m_Specification.Height = data.Height;
+			m_Specification.Format = data.Format;
+			m_Miplevels = (generateMips ? static_cast<uint32_t>(std::floor(std::log2(std::max(data.Width, data.Height)))) + 1 : (uint32_t)data.Levels.size());
+
+			m_Allocation = VkUtils::Allocator::AllocateImage(GetVkImageCreateInfo(), VMA_MEMORY_USAGE_GPU_ONLY, m_Image);
+
+			m_ImageView = VkUtils::Allocator::CreateImageView(m_Image, (VkFormat)m_Specification.Format, VK_IMAGE_ASPECT_COLOR_BIT, m_Miplevels);
+			m_Sampler = VulkanSamplerCache::Get(m_SamplerSpecification);
+		}
+
+		RecordCopy(cmdBuf, stagingBuffer, offset, data.Levels, generateMips, 0, 1);
+	}
+
+	void VulkanImage::RecordCopy(VkCommandBuffer cmdBuf, VkBuffer stagingBuffer, size_t offset, const std::vector<ImageFileLevel>& levels, bool generateMips, uint32_t baseLayer, uint32_t layerCount)
+	{
+		VkImageMemoryBarrier barrier = {};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.image = m_Image;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, m_Miplevels, baseLayer, layerCount };
+		barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+		vkCmdPipelineBarrier(cmdBuf, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+		VulkanGpuProfiler::CountBarrier();
+
+		// Note: All levels get copied at once, the layers of a level are tightly packed
+		std::vector<VkBufferImageCopy> regions(levels.size());
+		for (size_t i = 0; i < levels.size(); i++)
+		{
+			VkBufferImageCopy& region = regions[i];
+			region.bufferOffset = offset + levels[i].Offset;
+			region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, (uint32_t)i, baseLayer, layerCount };
+			region.imageExtent = { levels[i].Width, levels[i].Height, std::max(m_Specification.Depth >> i, 1u) };
+		}
+
+		vkCmdCopyBufferToImage(cmdBuf, stagingBuffer, m_Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, (uint32_t)regions.size(), regions.data());
+
+		VkImageLayout layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		if (generateMips)
+		{
+			GenerateMipmaps(cmdBuf, baseLayer, layerCount);
+			layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		}
+
+		if (layout != (VkImageLayout)m_Specification.Layout)
+		{
+			barrier.oldLayout = layout;
+			barrier.newLayout = (VkImageLayout)m_Specification.Layout;
+			barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+
+			vkCmdPipelineBarrier(cmdBuf, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+			VulkanGpuProfiler::CountBarrier();
+		}
+	}
+
+	void VulkanImage::GenerateMipmaps(VkCommandBuffer cmdBuf, uint32_t baseLayer, uint32_t layerCount)
+	{
+		HZ_PROFILE_SCOPE("VulkanImage::GenerateMipmaps");
+
+		// Note: The whole chain is generated in a few dispatches when the format can be used as a storage image
+		if (GetVkUsage() & VK_IMAGE_USAGE_STORAGE_BIT)
+		{
+			VulkanMipGenerator::Record(cmdBuf, m_Image, m_Specification.Format, m_Specification.Width, m_Specification.Height, m_Miplevels, m_Specification.MipmapFilter, baseLayer, layerCount);
+			return;
+		}
+
+		// Fall back to blitting, formats without linear filtering get a nearest blit
+		VkFormatProperties formatProperties;
+		vkGetPhysicalDeviceFormatProperties(VulkanContext::GetPhysicalDevice()->GetVkPhysicalDevice(), (VkFormat)m_Specification.Format, &formatProperties);
+		HZ_ASSERT(((formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_BLIT_SRC_BIT) && (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_BLIT_DST_BIT)), "Image format {0} supports neither compute nor blit mip generation.", (uint32_t)m_Specification.Format);
+
+		VkFilter filter = ((formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) ? VK_FILTER_LINEAR : VK_FILTER_NEAREST);
 
 		VkImageMemoryBarrier barrier = {};
 		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-		barrier.image = image;
+		barrier.image = m_Image;
 		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
 		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
 		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		barrier.subresourceRange.baseArrayLayer = 0;
-		barrier.subresourceRange.layerCount = 1;
+		barrier.subresourceRange.baseArrayLayer = baseLayer;
+		barrier.subresourceRange.layerCount = layerCount;
 		barrier.subresourceRange.levelCount = 1;
 
-		int32_t mipWidth = texWidth;
-		int32_t mipHeight = texHeight;
+		int32_t mipWidth = (int32_t)m_Specification.Width;
+		int32_t mipHeight = (int32_t)m_Specification.Height;
+		int32_t mipDepth = (int32_t)m_Specification.Depth;
 
-		for (uint32_t i = 1; i < mipLevels; i++)
+		for (uint32_t i = 1; i < m_Miplevels; i++)
 		{
 			barrier.subresourceRange.baseMipLevel = i - 1;
 			barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
@@ -372,60 +572,285 @@ namespace Hz
 			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
 			barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
 
-			vkCmdPipelineBarrier(command.GetVkCommandBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+			vkCmdPipelineBarrier(cmdBuf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+			VulkanGpuProfiler::CountBarrier();
 
 			VkImageBlit blit = {};
 			blit.srcOffsets[0] = { 0, 0, 0 };
-			blit.srcOffsets[1] = { mipWidth, mipHeight, 1 };
+			blit.srcOffsets[1] = { mipWidth, mipHeight, mipDepth };
 			blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 			blit.srcSubresource.mipLevel = i - 1;
-			blit.srcSubresource.baseArrayLayer = 0;
-			blit.srcSubresource.layerCount = 1;
+			blit.srcSubresource.baseArrayLayer = baseLayer;
+			blit.srcSubresource.layerCount = layerCount;
 			blit.dstOffsets[0] = { 0, 0, 0 };
-			blit.dstOffsets[1] = { mipWidth > 1 ? mipWidth / 2 : 1, mipHeight > 1 ? mipHeight / 2 : 1, 1 };
+			blit.dstOffsets[1] = { mipWidth > 1 ? mipWidth / 2 : 1, mipHeight > 1 ? mipHeight / 2 : 1, mipDepth > 1 ? mipDepth / 2 : 1 };
 			blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 			blit.dstSubresource.mipLevel = i;
-			blit.dstSubresource.baseArrayLayer = 0;
-			blit.dstSubresource.layerCount = 1;
+			blit.dstSubresource.baseArrayLayer = baseLayer;
+			blit.dstSubresource.layerCount = layerCount;
 
-			vkCmdBlitImage(command.GetVkCommandBuffer(), image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+			vkCmdBlitImage(cmdBuf, m_Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, filter);
 
 			barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
 			barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 			barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
 			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
 
-			vkCmdPipelineBarrier(command.GetVkCommandBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+			vkCmdPipelineBarrier(cmdBuf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+			VulkanGpuProfiler::CountBarrier();
 
 			if (mipWidth > 1) mipWidth /= 2;
 			if (mipHeight > 1) mipHeight /= 2;
+			if (mipDepth > 1) mipDepth /= 2;
 		}
 
-		barrier.subresourceRange.baseMipLevel = mipLevels - 1;
+		barrier.subresourceRange.baseMipLevel = m_Miplevels - 1;
 		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
 		barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
 		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
 
-		vkCmdPipelineBarrier(command.GetVkCommandBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-
-		command.EndAndSubmit();
+		vkCmdPipelineBarrier(cmdBuf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+		VulkanGpuProfiler::CountBarrier();
 	}
 
+    VkImageUsageFlags VulkanImage::GetVkUsage() const
+    {
+        // Note: Transient attachments may only be combined with other attachment usages
+        if (m_Specification.Flags & ImageUsageFlags::Transient)
+            return (VkImageUsageFlags)m_Specification.Flags;
+
+        VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | (VkImageUsageFlags)m_Specification.Flags;
+
+        // Note: Storage is only added when the mips can be generated with compute
+        if (m_Specification.MipMaps && m_Miplevels > 1 && m_Specification.ViewType != ImageViewType::Type3D && VulkanMipGenerator::Supports(m_Specification.Format))
+            usage |= VK_IMAGE_USAGE_STORAGE_BIT;
+
+        return usage;
+    }
+
+    VkImageCreateInfo VulkanImage::GetVkImageCreateInfo() const
+    {
+        VkImageType type = VK_IMAGE_TYPE_2D;
+        if (m_Specification.ViewType == ImageViewType::Type3D)
+            type = VK_IMAGE_TYPE_3D;
+        else if (m_Specification.ViewType == ImageViewType::Type1D || m_Specification.ViewType == ImageViewType::Type1DArray)
+            type = VK_IMAGE_TYPE_1D;
+
+        VkImageCreateFlags flags = 0;
+        if (m_Specification.ViewType == ImageViewType::Cube || m_Specification.ViewType == ImageViewType::CubeArray)
+            flags |= VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
+
+        VkImageCreateInfo createInfo = VkUtils::Allocator::GetImageCreateInfo(m_Specification.Width, m_Specification.Height, m_Miplevels, (VkFormat)m_Specification.Format, VK_IMAGE_TILING_OPTIMAL, GetVkUsage(), m_Specification.Depth, m_Specification.Layers, type, flags);
+        createInfo.samples = (VkSampleCountFlagBits)m_Specification.Samples;
+
+        return createInfo;
+    }
+
+    FreeFunction VulkanImage::Move(VkCommandBuffer cmdBuf, VmaAllocation dstAllocation)
+    {
+        VkImageCreateInfo createInfo = GetVkImageCreateInfo();
+        VkImage newImage = VkUtils::Allocator::CreateBoundImage(createInfo, dstAllocation);
+
+        VkImageAspectFlags aspect = GetVulkanImageAspectFromImageUsage(m_Specification.Flags);
+
+        // Old image -> TransferSrc, new image -> TransferDst
+        std::array<VkImageMemoryBarrier, 2> barriers = { };
+        for (auto& barrier : barriers)
+        {
+            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.subresourceRange.aspectMask = aspect;
+            barrier.subresourceRange.baseMipLevel = 0;
+            barrier.subresourceRange.levelCount = m_Miplevels;
+            barrier.subresourceRange.baseArrayLayer = 0;
+            barrier.subresourceRange.layerCount = m_Specification.Layers;
+        }
+
+        barriers[0].image = m_Image;
+        barriers[0].oldLayout = (VkImageLayout)m_Specification.Layout;
+        barriers[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barriers[0].srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+        barriers[0].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+        barriers[1].image = newImage;
+        barriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barriers[1].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barriers[1].srcAccessMask = 0;
+        barriers[1].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+        vkCmdPipelineBarrier(cmdBuf, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, (uint32_t)barriers.size(), barriers.data());
+        VulkanGpuProfiler::CountBarrier();
+
+        std::vector<VkImageCopy> regions((size_t)m_Miplevels);
+        for (uint32_t i = 0; i < m_Miplevels; i++)
+        {
+            VkImageCopy& region = regions[i];
+            region.srcSubresource = { aspect, i, 0, m_Specification.Layers };
+            region.dstSubresource = { aspect, i, 0, m_Specification.Layers };
+            region.extent = { std::max(m_Specification.Width >> i, 1u), std::max(m_Specification.Height >> i, 1u), std::max(m_Specification.Depth >> i, 1u) };
+        }
+
+        vkCmdCopyImage(cmdBuf, m_Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, newImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, (uint32_t)regions.size(), regions.data());
+
+        // New image -> original layout
+        barriers[1].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barriers[1].newLayout = (VkImageLayout)m_Specification.Layout;
+        barriers[1].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barriers[1].dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+
+        vkCmdPipelineBarrier(cmdBuf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1, &barriers[1]);
+        VulkanGpuProfiler::CountBarrier();
+
+        VkImageView newImageView = VkUtils::Allocator::CreateImageView(newImage, (VkFormat)m_Specification.Format, aspect, m_Miplevels, (VkImageViewType)m_Specification.ViewType, m_Specification.Layers);
+
+        VkImage oldImage = VK_NULL_HANDLE;
+        VkImageView oldImageView = VK_NULL_HANDLE;
+        std::vector<VkImageView> oldViews = { };
+        {
+            std::scoped_lock<std::mutex> lock(s_HandleMutex);
+
+            oldImage = m_Image;
+            oldImageView = m_ImageView;
+            oldViews = TakeSubresourceViews();
+
+            m_Image = newImage;
+            m_ImageView = newImageView;
+        }
+
+        // Note: The memory is owned by the defragmenter, so we only destroy the handles
+        return [oldImage, oldImageView, oldViews]()
+        {
+            auto device = VulkanContext::GetDevice()->GetVkDevice();
+
+            for (auto& view : oldViews)
+            {
+                VulkanRenderpassCache::Evict(view);
+                vkDestroyImageView(device, view, nullptr);
+            }
+
+            VulkanRenderpassCache::Evict(oldImageView);
+            vkDestroyImageView(device, oldImageView, nullptr);
+            vkDestroyImage(device, oldImage, nullptr);
+        };
+    }
+
+    VkImageView VulkanImage::GetVkImageView(uint32_t mip, uint32_t layer)
+    {
+        std::scoped_lock<std::mutex> lock(s_HandleMutex);
+
+        HZ_ASSERT((mip < m_Miplevels && layer < m_Specification.Layers), "Subresource (mip {0}, layer {1}) is out of range.", mip, layer);
+        HZ_ASSERT((m_Specification.ViewType != ImageViewType::Type3D), "3D images don't have per layer views.");
+
+        uint64_t key = ((uint64_t)mip << 32) | layer;
+        if (auto it = m_SubresourceViews.find(key); it != m_SubresourceViews.end())
+            return it->second;
+
+        VkImageViewType viewType = ((m_Specification.ViewType == ImageViewType::Type1D || m_Specification.ViewType == ImageViewType::Type1DArray) ? VK_IMAGE_VIEW_TYPE_1D : VK_IMAGE_VIEW_TYPE_2D);
+        VkImageView view = VkUtils::Allocator::CreateImageView(m_Image, (VkFormat)m_Specification.Format, GetVulkanImageAspectFromImageUsage(m_Specification.Flags), 1, viewType, 1, mip, layer);
+
+        m_SubresourceViews[key] = view;
+        return view;
+    }
+
+    bool VulkanImage::UsesPool() const
+    {
+        // Note: Pooled images are never moved or reallocated in place, which rules out file & mipmapped images
+        return (m_Specification.Usage == ImageUsage::Size && !m_Specification.MipMaps && m_Specification.ViewType == ImageViewType::Type2D && m_Specification.Layers == 1);
+    }
+
+    std::vector<VkImageView> VulkanImage::TakeSubresourceViews()
+    {
+        std::vector<VkImageView> views = { };
+        views.reserve(m_SubresourceViews.size());
+
+        for (auto& [key, view] : m_SubresourceViews)
+            views.push_back(view);
+
+        m_SubresourceViews.clear();
+        return views;
+    }
+
     void VulkanImage::Destroy()
     {
-        Renderer::Free([sampler = m_Sampler, imageView = m_ImageView, image = m_Image, allocation = m_Allocation]()
+        VulkanDefragmenter::Unregister(m_Allocation, this);
+
+        // Note: The sampler is owned by the sampler cache
+        Renderer::Free([imageView = m_ImageView, views = TakeSubresourceViews(), image = m_Image, allocation = m_Allocation, pooled = m_Pooled]()
         {
             auto device = VulkanContext::GetDevice()->GetVkDevice();
 
-            if (sampler)
-                vkDestroySampler(device, sampler, nullptr);
+            // Note: Framebuffers using these views are destroyed with them
             if (imageView)
+            {
+                VulkanRenderpassCache::Evict(imageView);
                 vkDestroyImageView(device, imageView, nullptr);
+            }
+            for (auto& view : views)
+            {
+                VulkanRenderpassCache::Evict(view);
+                vkDestroyImageView(device, view, nullptr);
+            }
 
             if (image != VK_NULL_HANDLE && allocation != VK_NULL_HANDLE)
-                VkUtils::Allocator::DestroyImage(image, allocation);
+            {
+                if (pooled)
+                    VulkanRenderTargetPool::Release(image, allocation);
+                else
+                    VkUtils::Allocator::DestroyImage(image, allocation);
+            }
         });
+
+        m_Pooled = false;
+    }
+
+    bool VulkanImage::SampleCountSupported(SampleCount samples, ImageUsageFlags flags)
+    {
+        VkPhysicalDeviceProperties properties = {};
+        vkGetPhysicalDeviceProperties(VulkanContext::GetPhysicalDevice()->GetVkPhysicalDevice(), &properties);
+
+        VkSampleCountFlags supported = ((flags & ImageUsageFlags::DepthStencil) ? properties.limits.framebufferDepthSampleCounts : properties.limits.framebufferColorSampleCounts);
+        if (flags & ImageUsageFlags::Sampled)
+            supported &= ((flags & ImageUsageFlags::DepthStencil) ? properties.limits.sampledImageDepthSampleCounts : properties.limits.sampledImageColorSampleCounts);
+
+        return (supported & (VkSampleCountFlags)samples);
+    }
+
+    bool VulkanImage::FormatSupported(ImageFormat format)
+    {
+        auto physicalDevice = VulkanContext::GetPhysicalDevice();
+
+        switch (format)
+        {
+        case ImageFormat::BC1: case ImageFormat::BC1sRGB: case ImageFormat::BC1A: case ImageFormat::BC1AsRGB:
+        case ImageFormat::BC2: case ImageFormat::BC2sRGB: case ImageFormat::BC3: case ImageFormat::BC3sRGB:
+        case ImageFormat::BC4: case ImageFormat::BC4SNorm: case ImageFormat::BC5: case ImageFormat::BC5SNorm:
+        case ImageFormat::BC6H: case ImageFormat::BC6HSFloat: case ImageFormat::BC7: case ImageFormat::BC7sRGB:
+            if (!physicalDevice->SupportsCompressionBC())
+                return false;
+            break;
+
+        case ImageFormat::ETC2: case ImageFormat::ETC2sRGB: case ImageFormat::ETC2A1: case ImageFormat::ETC2A1sRGB:
+        case ImageFormat::ETC2A: case ImageFormat::ETC2AsRGB:
+            if (!physicalDevice->SupportsCompressionETC2())
+                return false;
+            break;
+
+        case ImageFormat::ASTC4x4: case ImageFormat::ASTC4x4sRGB: case ImageFormat::ASTC6x6: case ImageFormat::ASTC6x6sRGB:
+        case ImageFormat::ASTC8x8: case ImageFormat::ASTC8x8sRGB:
+            if (!physicalDevice->SupportsCompressionASTC())
+                return false;
+            break;
+
+        default:
+            break;
+        }
+
+        VkFormatProperties properties;
+        vkGetPhysicalDeviceFormatProperties(physicalDevice->GetVkPhysicalDevice(), (VkFormat)format, &properties);
+
+        return properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT;
     }
 
    static VkImageAspectFlags GetVulkanImageAspectFromImageUsage(ImageUsageFlags usage)
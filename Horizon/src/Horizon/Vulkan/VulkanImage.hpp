@@ -3,6 +3,14 @@
 #include "Horizon/Core/Core.hpp"
 
 #include "Horizon/Renderer/Image.hpp"
+#include "Horizon/Renderer/ImageFile.hpp"
+
+#include "Horizon/Vulkan/VulkanDefragmenter.hpp"
+
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <unordered_map>
 
 #include <vulkan/vulkan.h>
 #include <vma/vk_mem_alloc.h>
@@ -13,7 +21,7 @@ namespace Hz
     class VulkanSwapChain;
     class VulkanDescriptorSet;
 
-    class VulkanImage : public Image
+    class VulkanImage : public Image, public VulkanMovable
 	{
 	public:
 		VulkanImage(const ImageSpecification& specs, const SamplerSpecification& samplerSpecs);
@@ -21,26 +29,55 @@ namespace Hz
 		~VulkanImage();
 
 		void SetData(void* data, size_t size) override;
+		void SetLayerData(uint32_t layer, void* data, size_t size) override;
 
 		void Resize(uint32_t width, uint32_t height) override;
 
 		void Transition(ImageLayout initial, ImageLayout final) override;
 
-		inline const ImageSpecification& GetSpecification() const override { return m_Specification; }
+		inline ImageSpecification GetSpecification() const override { std::scoped_lock<std::mutex> lock(s_HandleMutex); return m_Specification; }
+
+		inline bool IsLoading() const override { return m_Loading.load(std::memory_order_acquire); }
+
+		inline uint32_t GetWidth() const { std::scoped_lock<std::mutex> lock(s_HandleMutex); return m_Specification.Width; }
+		inline uint32_t GetHeight() const { std::scoped_lock<std::mutex> lock(s_HandleMutex); return m_Specification.Height; }
 
-		inline uint32_t GetWidth() const { return m_Specification.Width; }
-		inline uint32_t GetHeight() const { return m_Specification.Height; }
+		inline const VkImage GetVkImage() const { std::scoped_lock<std::mutex> lock(s_HandleMutex); return m_Image; }
+		inline const VmaAllocation GetVmaAllocation() const { std::scoped_lock<std::mutex> lock(s_HandleMutex); return m_Allocation; }
+		inline const VkImageView GetVkImageView() const { std::scoped_lock<std::mutex> lock(s_HandleMutex); return m_ImageView; }
+		inline const VkSampler GetVkSampler() const { std::scoped_lock<std::mutex> lock(s_HandleMutex); return m_Sampler; }
 
-		inline const VkImage GetVkImage() const { return m_Image; }
-		inline const VmaAllocation GetVmaAllocation() const { return m_Allocation; }
-		inline const VkImageView GetVkImageView() const { return m_ImageView; }
-		inline const VkSampler GetVkSampler() const { return m_Sampler; }
+		// Returns a view of a single mip & layer (a cubemap face for example), views are created on first use
+		VkImageView GetVkImageView(uint32_t mip, uint32_t layer);
+
+        // Defragmentation
+        FreeFunction Move(VkCommandBuffer cmdBuf, VmaAllocation dstAllocation) override;
+        inline bool CanMove() const override { return m_Specification.Usage == ImageUsage::File; } // Note: Other images might be referenced by framebuffers
+
+        static Ref<VulkanImage> CreateAsync(const ImageSpecification& specs, const SamplerSpecification& samplerSpecs);
+        static bool FormatSupported(ImageFormat format);
+        static bool SampleCountSupported(SampleCount samples, ImageUsageFlags flags);
 
     private:
         void CreateImage(uint32_t width, uint32_t height);
 		void CreateImage(const std::filesystem::path& path);
+		void CreateImage(const ImageFileData& data);
+
+        // Replaces the current image with one holding data, the stored mip chain is used as is,
+        // Note: Mips are only generated for single level uncompressed data
+        void RecordUpload(VkCommandBuffer cmdBuf, VkBuffer stagingBuffer, size_t offset, const ImageFileData& data);
+        // Copies levels into the current image and transitions it to the specified layout
+        void RecordCopy(VkCommandBuffer cmdBuf, VkBuffer stagingBuffer, size_t offset, const std::vector<ImageFileLevel>& levels, bool generateMips, uint32_t baseLayer, uint32_t layerCount);
 
-		void GenerateMipmaps(VkImage& image, VkFormat imageFormat, int32_t texWidth, int32_t texHeight, uint32_t mipLevels);
+        // Expects all levels of the layers in TransferDst and leaves them in ShaderRead
+		void GenerateMipmaps(VkCommandBuffer cmdBuf, uint32_t baseLayer, uint32_t layerCount);
+
+        VkImageUsageFlags GetVkUsage() const;
+        VkImageCreateInfo GetVkImageCreateInfo() const;
+
+        bool UsesPool() const; // Render targets get their memory from the VulkanRenderTargetPool
+
+        std::vector<VkImageView> TakeSubresourceViews(); // Note: The caller is responsible for destroying the views
 
         void Destroy();
 
@@ -53,10 +90,25 @@ namespace Hz
 		VkImageView m_ImageView = VK_NULL_HANDLE;
 		VkSampler m_Sampler = VK_NULL_HANDLE;
 
+		std::unordered_map<uint64_t, VkImageView> m_SubresourceViews = { }; // Key: (mip << 32) | layer
+
 		uint32_t m_Miplevels = 1;
 
+        bool m_Pooled = false; // Set if the memory belongs to the VulkanRenderTargetPool
+        std::atomic<bool> m_Loading = false; // Set while an asynchronous load is in progress, Note: Cleared by the loader once it no longer touches the image
+
+    private:
+        // Note: The loader, the streamer & the defragmenter replace the handles (and size) on the render thread, so they're
+        // swapped under this lock & the accessors take it. Code on the replacing thread reads the members directly.
+        // It's shared by all images, since descriptor sets read the handles of several images at once.
+        // Lock order: VulkanDefragmenter::s_Mutex before this, never the other way around.
+        inline static std::mutex s_HandleMutex = {};
+
         friend class VulkanSwapChain;
         friend class VulkanDescriptorSet;
+        friend class VulkanStreamedImage;
+        friend class VulkanTextureStreamer;
+        friend class VulkanImageLoader;
 	};
 
 }
@@ -0,0 +1,278 @@
+#include "hzpch.h"
+#include "VulkanImageLoader.hpp"
+
+#include "Horizon/Core/Logging.hpp"
+
+#include "Horizon/Renderer/ImageDecoder.hpp"
+
+#include "Horizon/Utils/AllocationTracker.hpp"
+
+#include "Horizon/Vulkan/VulkanUtils.hpp"
+#include "Horizon/Vulkan/VulkanImage.hpp"
+#include "Horizon/Vulkan/VulkanDefragmenter.hpp"
+#include "Horizon/Vulkan/VulkanCommandBuffer.hpp"
+
+#include "Horizon/Utils/Profiler.hpp"
+
+namespace Hz
+{
+
+    ///////////////////////////////////////////////////////////
+    // Loader
+    ///////////////////////////////////////////////////////////
+    void VulkanImageLoader::Update()
+    {
+        std::vector<Result> batch = { };
+        {
+            std::scoped_lock<std::mutex> lock(s_Mutex);
+
+            // Note: The first result is always taken, so large images still get uploaded
+            size_t bytes = 0;
+            auto it = s_Data.Results.begin();
+            while (it != s_Data.Results.end() && batch.size() < MaxUploadsPerFrame && (batch.empty() || bytes + it->Size <= MaxUploadBytesPerFrame))
+            {
+                bytes += it->Size;
+                s_Data.Active.erase(it->Image);
+                s_Data.Uploading.insert(it->Image);
+                batch.push_back(std::move(*it));
+                it++;
+            }
+            s_Data.Results.erase(s_Data.Results.begin(), it);
+            s_Data.PendingBytes -= bytes;
+
+            if (!batch.empty())
+                s_Data.UploadThread = std::this_thread::get_id();
+        }
+
+        // Note: Finished decodes & the taken results free up room for more decodes
+        Pump();
+
+        if (batch.empty())
+            return;
+
+        Upload(batch);
+
+        {
+            std::scoped_lock<std::mutex> lock(s_Mutex);
+            s_Data.Uploading.clear();
+            s_Data.UploadThread = {};
+        }
+        s_Data.UploadCondition.notify_all();
+    }
+
+    void VulkanImageLoader::Upload(std::vector<Result>& batch)
+    {
+        HZ_PROFILE_SCOPE("VulkanImageLoader::Upload");
+
+        // Failed loads keep their placeholder
+        std::erase_if(batch, [](const Result& result)
+        {
+            if (result.StagingBuffer != VK_NULL_HANDLE)
+                return false;
+
+            HZ_LOG_ERROR("Failed to load image from '{0}'", result.Image->m_Specification.Path.string());
+            result.Image->m_Loading.store(false, std::memory_order_release);
+            return true;
+        });
+
+        if (batch.empty())
+            return;
+
+        // Upload & generate mips for the whole batch in one submission
+        VulkanCommand command = VulkanCommand(true);
+        for (auto& result : batch)
+            result.Image->RecordUpload(command.GetVkCommandBuffer(), result.StagingBuffer, 0, result.Data);
+        command.EndAndSubmit();
+
+        // Note: The queue is idle now, so descriptor sets can be rewritten directly
+        for (auto& result : batch)
+        {
+            VulkanDefragmenter::Register(result.Image->m_Allocation, result.Image);
+            VulkanDefragmenter::Refresh(result.Image);
+
+            Release(result);
+
+            // Note: Last, once this is cleared the image may be destroyed without waiting on us
+            result.Image->m_Loading.store(false, std::memory_order_release);
+        }
+    }
+
+    void VulkanImageLoader::Destroy()
+    {
+        std::vector<JobHandle> decodes = { };
+        {
+            std::scoped_lock<std::mutex> lock(s_Mutex);
+            s_Data.Queue.clear();
+            s_Data.Active.clear(); // Note: So the decodes in flight release their results
+
+            decodes = std::move(s_Data.Decodes);
+        }
+
+        // Note: Outside of the lock, the decode jobs finish under it
+        Jobs::Wait(decodes);
+
+        for (auto& result : s_Data.Results)
+            Release(result);
+
+        s_Data.Decodes.clear();
+        s_Data.Results.clear();
+        s_Data.PendingBytes = 0;
+    }
+
+    void VulkanImageLoader::Load(VulkanImage* image, const std::filesystem::path& path)
+    {
+        {
+            std::scoped_lock<std::mutex> lock(s_Mutex);
+
+            uint64_t id = s_Data.NextID++;
+            s_Data.Active[image] = id;
+            s_Data.Queue.push_back({ image, id, path });
+        }
+
+        Pump();
+    }
+
+    void VulkanImageLoader::Cancel(VulkanImage* image)
+    {
+        std::unique_lock<std::mutex> lock(s_Mutex);
+
+        // Note: The image's upload has already been taken out of the results, so we have to wait for it to finish.
+        // The uploading thread itself never waits, it isn't in the middle of an upload when it destroys an image.
+        if (s_Data.UploadThread != std::this_thread::get_id())
+            s_Data.UploadCondition.wait(lock, [image]() { return !s_Data.Uploading.contains(image); });
+
+        // Note: A decode in flight releases its result, since the image isn't active anymore
+        s_Data.Active.erase(image);
+        std::erase_if(s_Data.Queue, [image](const Request& request) { return request.Image == image; });
+        std::erase_if(s_Data.Results, [image](Result& result)
+        {
+            if (result.Image != image)
+                return false;
+
+            s_Data.PendingBytes -= result.Size;
+            Release(result);
+            return true;
+        });
+    }
+
+    void VulkanImageLoader::Pump()
+    {
+        // Note: Half of the workers at most, so loading doesn't stall the frame's jobs
+        const uint32_t maxDecodes = std::max(Jobs::GetWorkerCount() / 2, 1u);
+
+        // Note: Loops, since without a running pool the jobs are executed right away & free up their slot
+        while (true)
+        {
+            std::vector<Request> requests = { };
+            {
+                std::scoped_lock<std::mutex> lock(s_Mutex);
+                std::erase_if(s_Data.Decodes, [](const JobHandle& handle) { return handle.Done(); });
+
+                while (!s_Data.Queue.empty() && s_Data.Decoding < maxDecodes && s_Data.PendingBytes < MaxPendingBytes)
+                {
+                    requests.push_back(std::move(s_Data.Queue.front()));
+                    s_Data.Queue.pop_front();
+                    s_Data.Decoding++;
+                }
+            }
+
+            if (requests.empty())
+                return;
+
+            // Note: Submitted outside of the lock, the job finishes under it
+            for (auto& request : requests)
+            {
+                JobHandle handle = Jobs::Submit([request = std::move(request)]() mutable
+                {
+                    HZ_ALLOCATION_TAG(AllocationTag::Vulkan);
+
+                    Result result = { request.Image, request.ID };
+                    Decode(request.Path, result);
+                    Finish(request, result);
+                }, "VulkanImageLoader::Decode");
+
+                std::scoped_lock<std::mutex> lock(s_Mutex);
+                if (!handle.Done())
+                    s_Data.Decodes.push_back(handle);
+            }
+        }
+    }
+
+    void VulkanImageLoader::Finish(Request& request, Result& result)
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+        s_Data.Decoding--;
+
+        // Note: The image might have been destroyed while decoding
+        if (auto it = s_Data.Active.find(request.Image); it != s_Data.Active.end() && it->second == request.ID)
+        {
+            s_Data.PendingBytes += result.Size;
+            s_Data.Results.push_back(std::move(result));
+        }
+        else
+        {
+            Release(result);
+        }
+    }
+
+    bool VulkanImageLoader::Decode(const std::filesystem::path& path, Result& result)
+    {
+        HZ_PROFILE_SCOPE("VulkanImageLoader::Decode");
+
+        // Containers are read into memory and copied once
+        if (ImageFile::IsContainer(path))
+        {
+            auto data = ImageFile::Load(path);
+            if (!data)
+                return false;
+
+            result.Size = data->Data.size();
+            result.StagingAllocation = VkUtils::Allocator::AllocateBuffer(result.Size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY, result.StagingBuffer);
+
+            void* mappedData;
+            VkUtils::Allocator::MapMemory(result.StagingAllocation, mappedData);
+            memcpy(mappedData, data->Data.data(), result.Size);
+            VkUtils::Allocator::UnMapMemory(result.StagingAllocation);
+
+            result.Data = std::move(data.value());
+            result.Data.Data.clear();
+            result.Data.Data.shrink_to_fit();
+            return true;
+        }
+
+        // Other files get decoded & copied into the staging buffer
+        ImageFileData& data = result.Data;
+        data.Format = ImageFormat::RGBA;
+        if (!ImageDecoder::Info(path, data.Width, data.Height))
+            return false;
+
+        result.Size = (size_t)data.Width * data.Height * 4;
+        data.Levels.push_back({ 0, result.Size, data.Width, data.Height });
+
+        result.StagingAllocation = VkUtils::Allocator::AllocateBuffer(result.Size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY, result.StagingBuffer);
+
+        void* mappedData;
+        VkUtils::Allocator::MapMemory(result.StagingAllocation, mappedData);
+        bool decoded = ImageDecoder::DecodeInto(path, mappedData, result.Size);
+        VkUtils::Allocator::UnMapMemory(result.StagingAllocation);
+
+        if (!decoded)
+        {
+            Release(result);
+            return false;
+        }
+
+        return true;
+    }
+
+    void VulkanImageLoader::Release(Result& result)
+    {
+        if (result.StagingBuffer != VK_NULL_HANDLE)
+            VkUtils::Allocator::DestroyBuffer(result.StagingBuffer, result.StagingAllocation);
+
+        result.StagingBuffer = VK_NULL_HANDLE;
+        result.StagingAllocation = VK_NULL_HANDLE;
+        result.Size = 0;
+    }
+
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Horizon/Core/Core.hpp"
+#include "Horizon/Core/Jobs.hpp"
+
+#include "Horizon/Renderer/ImageFile.hpp"
+
+#include <mutex>
+#include <deque>
+#include <thread>
+#include <vector>
+#include <filesystem>
+#include <unordered_map>
+#include <unordered_set>
+#include <condition_variable>
+
+#include <vulkan/vulkan.h>
+#include <vma/vk_mem_alloc.h>
+
+namespace Hz
+{
+
+    class VulkanImage;
+
+    // Decodes image files on the job system and uploads the results in batches.
+    class VulkanImageLoader
+    {
+    public:
+        static void Update(); // Note: Gets called by the renderer every frame
+        static void Destroy(); // Waits for the decodes in flight, pending loads are dropped
+
+        static void Load(VulkanImage* image, const std::filesystem::path& path);
+        static void Cancel(VulkanImage* image); // Note: Waits when the image is being uploaded on another thread
+
+    private:
+        struct Request
+        {
+        public:
+            VulkanImage* Image = nullptr;
+            uint64_t ID = 0;
+            std::filesystem::path Path = {};
+        };
+
+        struct Result
+        {
+        public:
+            VulkanImage* Image = nullptr;
+            uint64_t ID = 0;
+            ImageFileData Data = {}; // Note: Data.Data stays empty, the pixels live in the staging buffer
+
+            VkBuffer StagingBuffer = VK_NULL_HANDLE;
+            VmaAllocation StagingAllocation = VK_NULL_HANDLE;
+            size_t Size = 0;
+        };
+
+        static void Upload(std::vector<Result>& batch);
+        static void Pump(); // Submits queued requests as decode jobs, as long as there's room. Note: Called by Load() & Update()
+        static void Finish(Request& request, Result& result); // Hands the result of a decode job over to be uploaded
+        static bool Decode(const std::filesystem::path& path, Result& result);
+        static void Release(Result& result); // Destroys the staging buffer
+
+        // Note: We store our info in a struct, so we can ensure lifetime
+        // of all objects easily while the class remains static.
+        struct Info
+        {
+        public:
+            std::deque<Request> Queue = { };
+            std::vector<JobHandle> Decodes = { }; // Note: Finished handles are dropped when pumping
+            uint32_t Decoding = 0;
+
+            std::vector<Result> Results = { };
+            size_t PendingBytes = 0; // Staging memory held by results
+
+            uint64_t NextID = 1;
+            std::unordered_map<VulkanImage*, uint64_t> Active = { }; // Only results with the active ID get uploaded
+
+            // Note: Images of the batch Update() is uploading, Cancel() waits till they're done so they aren't destroyed mid upload
+            std::unordered_set<VulkanImage*> Uploading = { };
+            std::thread::id UploadThread = {};
+            std::condition_variable UploadCondition = {};
+        };
+
+        // Note: Images can be destroyed after the renderer, so the loader uses static storage like the defragmenter.
+        inline static std::mutex s_Mutex = {};
+        inline static Info s_Data = {};
+
+    public:
+        inline static constexpr const uint32_t MaxUploadsPerFrame = 16;
+        inline static constexpr const size_t MaxUploadBytesPerFrame = 64ull * 1024 * 1024;
+        inline static constexpr const size_t MaxPendingBytes = 256ull * 1024 * 1024; // No decodes are started when more staging memory is waiting for upload
+    };
+
+}
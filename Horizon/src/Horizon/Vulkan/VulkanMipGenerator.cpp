@@ -0,0 +1,436 @@
+#include "hzpch.h"
+#include "VulkanMipGenerator.hpp"
+
+#include "Horizon/Core/Logging.hpp"
+
+#include "Horizon/Renderer/Renderer.hpp"
+#include "Horizon/Renderer/Shader.hpp"
+
+#include "Horizon/Vulkan/VulkanUtils.hpp"
+#include "Horizon/Vulkan/VulkanContext.hpp"
+#include "Horizon/Vulkan/VulkanGpuProfiler.hpp"
+
+#include "Horizon/Utils/Profiler.hpp"
+
+#include <array>
+#include <string>
+#include <utility>
+
+namespace Hz
+{
+
+    ///////////////////////////////////////////////////////////
+    // Shaders
+    ///////////////////////////////////////////////////////////
+    // Note: A workgroup reduces a 64x64 source tile to 32x32 in level 1, which is kept in shared memory
+    // and reduced further down to a single texel in level 6. The z dimension selects the layer.
+    static constexpr const char* s_DownsampleShader = R"(
+layout(local_size_x = 16, local_size_y = 16) in;
+
+layout(binding = 0, FORMAT) uniform readonly image2DArray u_Source;
+layout(binding = 1, FORMAT) uniform writeonly image2DArray u_Level1;
+layout(binding = 2, FORMAT) uniform writeonly image2DArray u_Level2;
+layout(binding = 3, FORMAT) uniform writeonly image2DArray u_Level3;
+layout(binding = 4, FORMAT) uniform writeonly image2DArray u_Level4;
+layout(binding = 5, FORMAT) uniform writeonly image2DArray u_Level5;
+layout(binding = 6, FORMAT) uniform writeonly image2DArray u_Level6;
+
+layout(push_constant) uniform Constants
+{
+    ivec2 SourceSize;
+    int Levels;
+} u_Constants;
+
+shared vec4 s_Tile[32][32];
+
+vec4 Reduce(vec4 a, vec4 b, vec4 c, vec4 d)
+{
+#if defined(FILTER_MIN)
+    return min(min(a, b), min(c, d));
+#elif defined(FILTER_MAX)
+    return max(max(a, b), max(c, d));
+#else
+    return (a + b + c + d) * 0.25;
+#endif
+}
+
+vec4 Load(ivec2 coord)
+{
+    return imageLoad(u_Source, ivec3(min(coord, u_Constants.SourceSize - 1), gl_WorkGroupID.z));
+}
+
+void Store(int level, ivec2 coord, vec4 value)
+{
+    if (any(greaterThanEqual(coord, max(u_Constants.SourceSize >> level, ivec2(1)))))
+        return;
+
+    ivec3 texel = ivec3(coord, gl_WorkGroupID.z);
+    switch (level)
+    {
+    case 1: imageStore(u_Level1, texel, value); break;
+    case 2: imageStore(u_Level2, texel, value); break;
+    case 3: imageStore(u_Level3, texel, value); break;
+    case 4: imageStore(u_Level4, texel, value); break;
+    case 5: imageStore(u_Level5, texel, value); break;
+    case 6: imageStore(u_Level6, texel, value); break;
+    }
+}
+
+void main()
+{
+    ivec2 local = ivec2(gl_LocalInvocationID.xy);
+    ivec2 origin = ivec2(gl_WorkGroupID.xy) * 32;
+
+    // Level 1, every thread produces a 2x2 quad
+    for (int i = 0; i < 4; i++)
+    {
+        ivec2 coord = local * 2 + ivec2(i & 1, i >> 1);
+        ivec2 src = (origin + coord) * 2;
+
+        vec4 value = Reduce(Load(src), Load(src + ivec2(1, 0)), Load(src + ivec2(0, 1)), Load(src + ivec2(1, 1)));
+        Store(1, origin + coord, value);
+        s_Tile[coord.y][coord.x] = value;
+    }
+
+    // Level 2-6, the tile halves every level
+    for (int level = 2; level <= u_Constants.Levels; level++)
+    {
+        memoryBarrierShared();
+        barrier();
+
+        int size = 64 >> level;
+        bool active = all(lessThan(local, ivec2(size)));
+
+        vec4 value = vec4(0.0);
+        if (active)
+        {
+            ivec2 src = local * 2;
+            value = Reduce(s_Tile[src.y][src.x], s_Tile[src.y][src.x + 1], s_Tile[src.y + 1][src.x], s_Tile[src.y + 1][src.x + 1]);
+            Store(level, (origin >> (level - 1)) + local, value);
+        }
+
+        memoryBarrierShared();
+        barrier();
+
+        if (active)
+            s_Tile[local.y][local.x] = value;
+    }
+}
+)";
+
+    // Note: The footprint is too wide for the shared memory chain, so this writes a single level per dispatch
+    static constexpr const char* s_KaiserShader = R"(
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(binding = 0, FORMAT) uniform readonly image2DArray u_Source;
+layout(binding = 1, FORMAT) uniform writeonly image2DArray u_Level1;
+
+layout(push_constant) uniform Constants
+{
+    ivec2 SourceSize;
+    int Levels;
+} u_Constants;
+
+// Kaiser windowed sinc (alpha = 4, radius = 3), taps at -2.5 to 2.5 source texels from the destination centre
+const float c_Weights[6] = float[](-0.020992, 0.094502, 0.426490, 0.426490, 0.094502, -0.020992);
+
+void main()
+{
+    ivec2 coord = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(coord, max(u_Constants.SourceSize >> 1, ivec2(1)))))
+        return;
+
+    vec4 value = vec4(0.0);
+    for (int y = 0; y < 6; y++)
+    {
+        for (int x = 0; x < 6; x++)
+        {
+            ivec2 src = clamp(coord * 2 + ivec2(x - 2, y - 2), ivec2(0), u_Constants.SourceSize - 1);
+            value += c_Weights[x] * c_Weights[y] * imageLoad(u_Source, ivec3(src, gl_GlobalInvocationID.z));
+        }
+    }
+
+    // Note: Negative lobes can ring below zero in float formats
+    imageStore(u_Level1, ivec3(coord, gl_GlobalInvocationID.z), max(value, vec4(0.0)));
+}
+)";
+
+    struct PushConstants
+    {
+    public:
+        int32_t SourceWidth;
+        int32_t SourceHeight;
+        int32_t Levels;
+    };
+
+    // Returns the GLSL format qualifier, nullptr if the format can't be used
+    static const char* GetFormatQualifier(ImageFormat format)
+    {
+        switch (format)
+        {
+        case ImageFormat::RGBA:
+            return "rgba8";
+        case ImageFormat::RGBA16SFloat:
+            return "rgba16f";
+        case ImageFormat::R32SFloat:
+            return "r32f";
+
+        default:
+            break;
+        }
+
+        return nullptr;
+    }
+
+    ///////////////////////////////////////////////////////////
+    // Generator
+    ///////////////////////////////////////////////////////////
+    void VulkanMipGenerator::Destroy()
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+        auto device = VulkanContext::GetDevice()->GetVkDevice();
+
+        for (auto& [key, pipeline] : s_Data.Pipelines)
+            vkDestroyPipeline(device, pipeline, nullptr);
+        for (auto& pool : s_Data.Pools)
+            vkDestroyDescriptorPool(device, pool, nullptr);
+
+        if (s_Data.PipelineLayout)
+            vkDestroyPipelineLayout(device, s_Data.PipelineLayout, nullptr);
+        if (s_Data.SetLayout)
+            vkDestroyDescriptorSetLayout(device, s_Data.SetLayout, nullptr);
+
+        s_Data = {};
+    }
+
+    bool VulkanMipGenerator::Supports(ImageFormat format)
+    {
+        if (!GetFormatQualifier(format))
+            return false;
+
+        VkFormatProperties properties;
+        vkGetPhysicalDeviceFormatProperties(VulkanContext::GetPhysicalDevice()->GetVkPhysicalDevice(), (VkFormat)format, &properties);
+
+        return (properties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT);
+    }
+
+    void VulkanMipGenerator::Record(VkCommandBuffer cmdBuf, VkImage image, ImageFormat format, uint32_t width, uint32_t height, uint32_t mipLevels, MipFilter filter, uint32_t baseLayer, uint32_t layerCount)
+    {
+        HZ_PROFILE_SCOPE("VulkanMipGenerator::Record");
+        HZ_ASSERT(Supports(format), "Image format {0} can't be used for compute mip generation.", (uint32_t)format);
+
+        auto device = VulkanContext::GetDevice()->GetVkDevice();
+
+        // All levels -> General
+        VkImageMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.image = image;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, mipLevels, baseLayer, layerCount };
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+        vkCmdPipelineBarrier(cmdBuf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+        VulkanGpuProfiler::CountBarrier();
+
+        // Note: Storage images can only view a single level, the layers are viewed as an array
+        std::vector<VkImageView> views(mipLevels);
+        for (uint32_t i = 0; i < mipLevels; i++)
+            views[i] = VkUtils::Allocator::CreateImageView(image, (VkFormat)format, VK_IMAGE_ASPECT_COLOR_BIT, 1, VK_IMAGE_VIEW_TYPE_2D_ARRAY, layerCount, i, baseLayer);
+
+        vkCmdBindPipeline(cmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, GetPipeline(format, filter));
+
+        uint32_t levelsPerDispatch = (filter == MipFilter::Kaiser ? 1 : LevelsPerDispatch);
+        uint32_t tileSize = (filter == MipFilter::Kaiser ? 8 : 32); // In level 1 texels
+
+        std::vector<std::pair<VkDescriptorPool, VkDescriptorSet>> sets = { };
+        for (uint32_t base = 0; base + 1 < mipLevels; base += levelsPerDispatch)
+        {
+            uint32_t levels = std::min(levelsPerDispatch, mipLevels - 1 - base);
+
+            VkDescriptorPool pool = VK_NULL_HANDLE;
+            VkDescriptorSet set = AllocateSet(pool);
+            sets.emplace_back(pool, set);
+
+            // Note: Bindings past the last level repeat it, the shader doesn't write to them
+            std::array<VkDescriptorImageInfo, LevelsPerDispatch + 1> imageInfos = { };
+            for (uint32_t i = 0; i < imageInfos.size(); i++)
+                imageInfos[i] = { VK_NULL_HANDLE, views[base + std::min(i, levels)], VK_IMAGE_LAYOUT_GENERAL };
+
+            VkWriteDescriptorSet write = {};
+            write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet = set;
+            write.dstBinding = 0;
+            write.descriptorCount = (uint32_t)imageInfos.size();
+            write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+            write.pImageInfo = imageInfos.data();
+
+            vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+            vkCmdBindDescriptorSets(cmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, s_Data.PipelineLayout, 0, 1, &set, 0, nullptr);
+
+            PushConstants constants = { (int32_t)std::max(width >> base, 1u), (int32_t)std::max(height >> base, 1u), (int32_t)levels };
+            vkCmdPushConstants(cmdBuf, s_Data.PipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &constants);
+
+            uint32_t dstWidth = std::max(width >> (base + 1), 1u);
+            uint32_t dstHeight = std::max(height >> (base + 1), 1u);
+            vkCmdDispatch(cmdBuf, (dstWidth + tileSize - 1) / tileSize, (dstHeight + tileSize - 1) / tileSize, layerCount);
+
+            // The next dispatch reads the last level written by this one
+            if (base + levels + 1 < mipLevels)
+            {
+                VkMemoryBarrier memoryBarrier = {};
+                memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+                memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+                memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+                vkCmdPipelineBarrier(cmdBuf, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+                VulkanGpuProfiler::CountBarrier();
+            }
+        }
+
+        // All levels -> ShaderRead
+        barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        vkCmdPipelineBarrier(cmdBuf, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+        VulkanGpuProfiler::CountBarrier();
+
+        Renderer::Free([views, sets]()
+        {
+            auto device = VulkanContext::GetDevice()->GetVkDevice();
+
+            for (auto& view : views)
+                vkDestroyImageView(device, view, nullptr);
+
+            std::scoped_lock<std::mutex> lock(s_Mutex);
+            for (auto& [pool, set] : sets)
+                vkFreeDescriptorSets(device, pool, 1, &set);
+        });
+    }
+
+    VkPipeline VulkanMipGenerator::GetPipeline(ImageFormat format, MipFilter filter)
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+        auto device = VulkanContext::GetDevice()->GetVkDevice();
+
+        uint32_t key = ((uint32_t)format << 8) | (uint32_t)filter;
+        if (auto it = s_Data.Pipelines.find(key); it != s_Data.Pipelines.end())
+            return it->second;
+
+        // Note: The layouts are shared by all pipelines and created on first use
+        if (!s_Data.SetLayout)
+        {
+            std::array<VkDescriptorSetLayoutBinding, LevelsPerDispatch + 1> bindings = { };
+            for (uint32_t i = 0; i < bindings.size(); i++)
+            {
+                bindings[i].binding = i;
+                bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+                bindings[i].descriptorCount = 1;
+                bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+            }
+
+            VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+            layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+            layoutInfo.bindingCount = (uint32_t)bindings.size();
+            layoutInfo.pBindings = bindings.data();
+
+            VK_CHECK_RESULT(vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &s_Data.SetLayout));
+
+            VkPushConstantRange range = {};
+            range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+            range.offset = 0;
+            range.size = sizeof(PushConstants);
+
+            VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+            pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+            pipelineLayoutInfo.setLayoutCount = 1;
+            pipelineLayoutInfo.pSetLayouts = &s_Data.SetLayout;
+            pipelineLayoutInfo.pushConstantRangeCount = 1;
+            pipelineLayoutInfo.pPushConstantRanges = &range;
+
+            VK_CHECK_RESULT(vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &s_Data.PipelineLayout));
+        }
+
+        std::string code = "#version 450\n";
+        code += std::string("#define FORMAT ") + GetFormatQualifier(format) + "\n";
+        if (filter == MipFilter::Min)
+            code += "#define FILTER_MIN\n";
+        else if (filter == MipFilter::Max)
+            code += "#define FILTER_MAX\n";
+        code += (filter == MipFilter::Kaiser ? s_KaiserShader : s_DownsampleShader);
+
+        std::vector<char> spirv = ShaderCompiler::Compile<ShadingLanguage::GLSL>(ShaderStage::Compute, code);
+
+        VkShaderModuleCreateInfo moduleInfo = {};
+        moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        moduleInfo.codeSize = spirv.size();
+        moduleInfo.pCode = reinterpret_cast<const uint32_t*>(spirv.data());
+
+        VkShaderModule shaderModule = VK_NULL_HANDLE;
+        VK_CHECK_RESULT(vkCreateShaderModule(device, &moduleInfo, nullptr, &shaderModule));
+
+        VkComputePipelineCreateInfo pipelineInfo = {};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineInfo.stage.module = shaderModule;
+        pipelineInfo.stage.pName = "main";
+        pipelineInfo.layout = s_Data.PipelineLayout;
+
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        VK_CHECK_RESULT(vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline));
+
+        vkDestroyShaderModule(device, shaderModule, nullptr);
+
+        s_Data.Pipelines[key] = pipeline;
+        return pipeline;
+    }
+
+    VkDescriptorSet VulkanMipGenerator::AllocateSet(VkDescriptorPool& pool)
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+        auto device = VulkanContext::GetDevice()->GetVkDevice();
+
+        VkDescriptorSetAllocateInfo allocInfo = {};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &s_Data.SetLayout;
+
+        VkDescriptorSet set = VK_NULL_HANDLE;
+        for (auto it = s_Data.Pools.rbegin(); it != s_Data.Pools.rend(); it++)
+        {
+            allocInfo.descriptorPool = *it;
+            if (vkAllocateDescriptorSets(device, &allocInfo, &set) == VK_SUCCESS)
+            {
+                pool = *it;
+                return set;
+            }
+        }
+
+        // Note: All pools are full, sets get freed once the GPU is done with them
+        VkDescriptorPoolSize poolSize = {};
+        poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        poolSize.descriptorCount = SetsPerPool * (LevelsPerDispatch + 1);
+
+        VkDescriptorPoolCreateInfo poolInfo = {};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+        poolInfo.maxSets = SetsPerPool;
+        poolInfo.poolSizeCount = 1;
+        poolInfo.pPoolSizes = &poolSize;
+
+        VK_CHECK_RESULT(vkCreateDescriptorPool(device, &poolInfo, nullptr, &pool));
+        s_Data.Pools.push_back(pool);
+
+        allocInfo.descriptorPool = pool;
+        VK_CHECK_RESULT(vkAllocateDescriptorSets(device, &allocInfo, &set));
+
+        return set;
+    }
+
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Horizon/Core/Core.hpp"
+
+#include "Horizon/Renderer/Image.hpp"
+
+#include <mutex>
+#include <vector>
+#include <unordered_map>
+
+#include <vulkan/vulkan.h>
+
+namespace Hz
+{
+
+    // Generates mip chains with compute shaders, every dispatch writes up to 6 levels
+    // from a single source level through shared memory (similar to a single pass downsampler).
+    // Note: Images need VK_IMAGE_USAGE_STORAGE_BIT, see VulkanMipGenerator::Supports
+    class VulkanMipGenerator
+    {
+    public:
+        static void Destroy();
+
+        // Returns true if the format can be written to as a storage image
+        static bool Supports(ImageFormat format);
+
+        // Expects all levels of the layers in TransferDst and leaves them in ShaderRead
+        static void Record(VkCommandBuffer cmdBuf, VkImage image, ImageFormat format, uint32_t width, uint32_t height, uint32_t mipLevels, MipFilter filter, uint32_t baseLayer = 0, uint32_t layerCount = 1);
+
+    private:
+        static VkPipeline GetPipeline(ImageFormat format, MipFilter filter);
+        static VkDescriptorSet AllocateSet(VkDescriptorPool& pool);
+
+        // Note: We store our info in a struct, so we can ensure lifetime
+        // of all objects easily while the class remains static.
+        struct Info
+        {
+        public:
+            VkDescriptorSetLayout SetLayout = VK_NULL_HANDLE;
+            VkPipelineLayout PipelineLayout = VK_NULL_HANDLE;
+
+            std::unordered_map<uint32_t, VkPipeline> Pipelines = { }; // Key: (format << 8) | filter
+            std::vector<VkDescriptorPool> Pools = { };
+        };
+
+        inline static std::mutex s_Mutex = {};
+        inline static Info s_Data = {};
+
+    public:
+        inline static constexpr const uint32_t LevelsPerDispatch = 6;
+        inline static constexpr const uint32_t SetsPerPool = 256;
+    };
+
+}
@@ -8,6 +8,8 @@
 #include "Horizon/Vulkan/VulkanUtils.hpp"
 #include "Horizon/Vulkan/VulkanContext.hpp"
 
+#include <cstring>
+
 namespace Hz
 {
 
@@ -34,6 +36,7 @@ namespace Hz
 		HZ_ASSERT(m_PhysicalDevice, "Failed to find a GPU with support for this application's required Vulkan capabilities!");
 
 		m_DepthFormat = GetDepthFormat();
+		QueryOptionalFeatures();
 	}
 
 	VulkanPhysicalDevice::~VulkanPhysicalDevice()
@@ -167,6 +170,40 @@ namespace Hz
 		return VK_FORMAT_UNDEFINED;
 	}
 
+	void VulkanPhysicalDevice::QueryOptionalFeatures()
+	{
+		VkPhysicalDeviceVulkan12Features features12 = {};
+		features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+		VkPhysicalDeviceFeatures2 features = {};
+		features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		features.pNext = &features12;
+
+		vkGetPhysicalDeviceFeatures2(m_PhysicalDevice, &features);
+
+		m_BufferDeviceAddress = features12.bufferDeviceAddress;
+		m_HostQueryReset = features12.hostQueryReset;
+		m_PipelineStatistics = features.features.pipelineStatisticsQuery;
+		m_CompressionBC = features.features.textureCompressionBC;
+		m_CompressionETC2 = features.features.textureCompressionETC2;
+		m_CompressionASTC = features.features.textureCompressionASTC_LDR;
+
+		// Optional extensions
+		uint32_t extensionCount;
+		vkEnumerateDeviceExtensionProperties(m_PhysicalDevice, nullptr, &extensionCount, nullptr);
+
+		std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+		vkEnumerateDeviceExtensionProperties(m_PhysicalDevice, nullptr, &extensionCount, availableExtensions.data());
+
+		for (const auto& extension : availableExtensions)
+		{
+			if (std::strcmp(extension.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0)
+				m_MemoryBudget = true;
+			else if (std::strcmp(extension.extensionName, VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME) == 0)
+				m_CalibratedTimestamps = true;
+		}
+	}
+
 	Ref<VulkanPhysicalDevice> VulkanPhysicalDevice::Select(const VkSurfaceKHR surface)
 	{
 		return Ref<VulkanPhysicalDevice>::Create(surface);
@@ -49,17 +49,37 @@ namespace Hz
 		inline const VkFormat GetDepthFormat() const { return m_DepthFormat; }
 		inline const VkPhysicalDevice GetVkPhysicalDevice() const { return m_PhysicalDevice; }
 
+		// Optional features
+		inline bool SupportsBufferDeviceAddress() const { return m_BufferDeviceAddress; }
+		inline bool SupportsMemoryBudget() const { return m_MemoryBudget; }
+		inline bool SupportsHostQueryReset() const { return m_HostQueryReset; }
+		inline bool SupportsPipelineStatistics() const { return m_PipelineStatistics; }
+		inline bool SupportsCalibratedTimestamps() const { return m_CalibratedTimestamps; }
+		inline bool SupportsCompressionBC() const { return m_CompressionBC; }
+		inline bool SupportsCompressionETC2() const { return m_CompressionETC2; }
+		inline bool SupportsCompressionASTC() const { return m_CompressionASTC; }
+
 		static Ref<VulkanPhysicalDevice> Select(const VkSurfaceKHR surface);
 
 	private:
 		bool PhysicalDeviceSuitable(const VkSurfaceKHR surface, const VkPhysicalDevice device);
 		bool ExtensionsSupported(const VkPhysicalDevice device);
 		VkFormat GetDepthFormat();
+		void QueryOptionalFeatures();
 
 	private:
 		VkPhysicalDevice m_PhysicalDevice = VK_NULL_HANDLE;
 
 		VkFormat m_DepthFormat = VK_FORMAT_UNDEFINED;
+
+		bool m_BufferDeviceAddress = false;
+		bool m_MemoryBudget = false;
+		bool m_HostQueryReset = false;
+		bool m_PipelineStatistics = false;
+		bool m_CalibratedTimestamps = false;
+		bool m_CompressionBC = false;
+		bool m_CompressionETC2 = false;
+		bool m_CompressionASTC = false;
 	};
 
 }
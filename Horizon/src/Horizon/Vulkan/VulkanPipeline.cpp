@@ -16,6 +16,7 @@
 #include "Horizon/Vulkan/VulkanRenderpass.hpp"
 #include "Horizon/Vulkan/VulkanDescriptors.hpp"
 #include "Horizon/Vulkan/VulkanCommandBuffer.hpp"
+#include "Horizon/Vulkan/VulkanGpuProfiler.hpp"
 
 static VKAPI_ATTR VkResult VKAPI_CALL CreateRayTracingPipelinesKHR(VkDevice device, VkDeferredOperationKHR deferredOperation, VkPipelineCache pipelineCache, uint32_t createInfoCount, const VkRayTracingPipelineCreateInfoKHR* pCreateInfos, const VkAllocationCallbacks*  pAllocator, VkPipeline* pPipelines)
 {
@@ -86,14 +87,20 @@ namespace Hz
     {
         Ref<VulkanCommandBuffer> src = commandBuffer.As<VulkanCommandBuffer>();
 
-		vkCmdBindPipeline(src->GetVkCommandBuffer(Renderer::GetCurrentFrame()), (VkPipelineBindPoint)bindPoint, m_Pipeline);
+        src->BindPipeline((VkPipelineBindPoint)bindPoint, m_Pipeline);
     }
 
     void VulkanPipeline::DispatchCompute(Ref<CommandBuffer> commandBuffer, uint32_t width, uint32_t height, uint32_t depth)
     {
         Ref<VulkanCommandBuffer> src = commandBuffer.As<VulkanCommandBuffer>();
 
-		vkCmdDispatch(src->GetVkCommandBuffer(Renderer::GetCurrentFrame()), width, height, depth);
+        VkCommandBuffer cmdBuf = src->GetVkCommandBuffer(Renderer::GetCurrentFrame());
+
+        VulkanGpuProfiler::BeginZone(cmdBuf, "Dispatch");
+		vkCmdDispatch(cmdBuf, width, height, depth);
+        VulkanGpuProfiler::EndZone(cmdBuf);
+
+        src->GetCounters().Dispatches++;
     }
 
     void VulkanPipeline::CreateGraphicsPipeline(Ref<DescriptorSets> sets, Ref<Shader> shader, Ref<Renderpass> renderpass) // Renderpass may be null
@@ -124,7 +131,7 @@ namespace Hz
 
 		VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
 		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-		if (!m_Specification.Bufferlayout.GetElements().empty())
+		if (!m_Specification.VertexPulling && !m_Specification.Bufferlayout.GetElements().empty())
 		{
 			vertexInputInfo.vertexBindingDescriptionCount = 1;
 			vertexInputInfo.vertexAttributeDescriptionCount = (uint32_t)attributeDescriptions.size();
@@ -162,18 +169,36 @@ namespace Hz
 		VkPipelineMultisampleStateCreateInfo multisampling = {};
 		multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
 		multisampling.sampleShadingEnable = VK_FALSE;
-		multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+		multisampling.rasterizationSamples = (VkSampleCountFlagBits)m_Specification.Samples;
+
+		HZ_ASSERT((!renderpass || renderpass->GetSpecification().Samples == m_Specification.Samples), "The pipeline's sample count doesn't match the renderpass' sample count.");
+
+		// Note: Every colour attachment needs its own blend state
+		uint32_t colourAttachments = (renderpass ? renderpass->GetColourAttachmentCount(m_Specification.Subpass) : (uint32_t)m_Specification.ColourFormats.size());
+		HZ_ASSERT((m_Specification.ColourBlends.empty() || m_Specification.ColourBlends.size() == colourAttachments), "The amount of blend states ({0}) doesn't match the amount of colour attachments ({1}).", m_Specification.ColourBlends.size(), colourAttachments);
 
-		VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
-		colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-		colorBlendAttachment.blendEnable = m_Specification.Blending; // Note(Jorben): Set true for transparancy
+		std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments(colourAttachments);
+		for (uint32_t i = 0; i < colourAttachments; i++)
+		{
+			BlendState blend = (m_Specification.ColourBlends.empty() ? BlendState{ .Enabled = m_Specification.Blending } : m_Specification.ColourBlends[i]);
+
+			VkPipelineColorBlendAttachmentState& colorBlendAttachment = colorBlendAttachments[i];
+			colorBlendAttachment.colorWriteMask = (VkColorComponentFlags)blend.WriteMask;
+			colorBlendAttachment.blendEnable = (blend.Enabled ? VK_TRUE : VK_FALSE);
+			colorBlendAttachment.srcColorBlendFactor = (VkBlendFactor)blend.SrcColour;
+			colorBlendAttachment.dstColorBlendFactor = (VkBlendFactor)blend.DstColour;
+			colorBlendAttachment.colorBlendOp = (VkBlendOp)blend.ColourOp;
+			colorBlendAttachment.srcAlphaBlendFactor = (VkBlendFactor)blend.SrcAlpha;
+			colorBlendAttachment.dstAlphaBlendFactor = (VkBlendFactor)blend.DstAlpha;
+			colorBlendAttachment.alphaBlendOp = (VkBlendOp)blend.AlphaOp;
+		}
 
 		VkPipelineColorBlendStateCreateInfo colorBlending = {};
 		colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
 		colorBlending.logicOpEnable = VK_FALSE;
 		colorBlending.logicOp = VK_LOGIC_OP_COPY;
-		colorBlending.attachmentCount = 1;
-		colorBlending.pAttachments = &colorBlendAttachment;
+		colorBlending.attachmentCount = colourAttachments;
+		colorBlending.pAttachments = (colorBlendAttachments.empty() ? nullptr : colorBlendAttachments.data());
 		colorBlending.blendConstants[0] = 0.0f;
 		colorBlending.blendConstants[1] = 0.0f;
 		colorBlending.blendConstants[2] = 0.0f;
@@ -218,9 +243,21 @@ namespace Hz
 
         VK_CHECK_RESULT(vkCreatePipelineLayout(VulkanContext::GetDevice()->GetVkDevice(), &pipelineLayoutInfo, nullptr, &m_PipelineLayout));
 
+		// Dynamic rendering needs the attachment formats up front
+		std::vector<VkFormat> colourFormats = { };
+		for (auto format : m_Specification.ColourFormats)
+			colourFormats.push_back((VkFormat)format);
+
+		VkPipelineRenderingCreateInfo renderingInfo = {};
+		renderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+		renderingInfo.colorAttachmentCount = (uint32_t)colourFormats.size();
+		renderingInfo.pColorAttachmentFormats = (colourFormats.empty() ? nullptr : colourFormats.data());
+		renderingInfo.depthAttachmentFormat = (VkFormat)m_Specification.DepthFormat;
+
 		// Create the actual graphics pipeline (where we actually use the shaders and other info)
 		VkGraphicsPipelineCreateInfo pipelineInfo = {};
 		pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		pipelineInfo.pNext = (renderpass ? nullptr : &renderingInfo);
 		pipelineInfo.stageCount = (uint32_t)shaderStages.size();
 		pipelineInfo.pStages = shaderStages.data();
 		pipelineInfo.pVertexInputState = &vertexInputInfo;
@@ -233,7 +270,7 @@ namespace Hz
 		pipelineInfo.pDynamicState = &dynamicState;
 		pipelineInfo.layout = m_PipelineLayout;
 		pipelineInfo.renderPass = (renderpass ? renderpass.As<VulkanRenderpass>()->GetVkRenderPass() : nullptr);
-		pipelineInfo.subpass = 0;
+		pipelineInfo.subpass = (renderpass ? m_Specification.Subpass : 0);
 		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE; // Optional
 		pipelineInfo.basePipelineIndex = -1; // Optional
 
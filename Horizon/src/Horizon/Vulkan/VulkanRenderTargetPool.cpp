@@ -0,0 +1,178 @@
+#include "hzpch.h"
+#include "VulkanRenderTargetPool.hpp"
+
+#include "Horizon/Core/Logging.hpp"
+
+#include "Horizon/Vulkan/VulkanUtils.hpp"
+#include "Horizon/Vulkan/VulkanContext.hpp"
+
+#include "Horizon/Utils/Profiler.hpp"
+
+#include <bit>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+
+namespace Hz
+{
+
+    ///////////////////////////////////////////////////////////
+    // Pool
+    ///////////////////////////////////////////////////////////
+    void VulkanRenderTargetPool::Update()
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+        s_Data.Frame++;
+
+        for (auto& [key, entries] : s_Data.Free)
+        {
+            std::erase_if(entries, [&key](const Entry& entry)
+            {
+                if (s_Data.Frame - entry.ReleasedFrame <= MaxIdleFrames)
+                    return false;
+
+                s_Data.Stats.FreeCount--;
+                s_Data.Stats.FreeBytes -= key.SizeClass;
+                VkUtils::Allocator::FreeMemory(entry.Allocation);
+                return true;
+            });
+        }
+
+        HZ_PROFILE_PLOT("RenderTargetPool FreeBytes", (int64_t)s_Data.Stats.FreeBytes);
+    }
+
+    void VulkanRenderTargetPool::Destroy()
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+
+        for (auto& [key, entries] : s_Data.Free)
+        {
+            for (auto& entry : entries)
+                VkUtils::Allocator::FreeMemory(entry.Allocation);
+        }
+
+        if (!s_Data.Used.empty())
+            HZ_LOG_WARN("{0} render target(s) were still in use when the pool got destroyed.", s_Data.Used.size());
+
+        s_Data = {};
+    }
+
+    VmaAllocation VulkanRenderTargetPool::Acquire(const VkImageCreateInfo& createInfo, VkImage& image)
+    {
+        auto device = VulkanContext::GetDevice()->GetVkDevice();
+        VK_CHECK_RESULT(vkCreateImage(device, &createInfo, nullptr, &image));
+
+        VkMemoryRequirements requirements = {};
+        vkGetImageMemoryRequirements(device, image, &requirements);
+
+        // Note: The size class is part of the key, so slightly different sizes (from consecutive resizes) share memory
+        Key key = { createInfo.format, createInfo.usage, createInfo.samples, GetSizeClass(requirements.size) };
+        VmaAllocation allocation = VK_NULL_HANDLE;
+        {
+            std::scoped_lock<std::mutex> lock(s_Mutex);
+            s_Data.Stats.Requests++;
+
+            // Note: The key doesn't capture everything the image requires, so the recycled memory is checked as well
+            if (auto it = s_Data.Free.find(key); it != s_Data.Free.end())
+            {
+                auto& entries = it->second;
+                auto entry = std::find_if(entries.rbegin(), entries.rend(), [&requirements](const Entry& entry) { return Fits(entry.Allocation, requirements); });
+
+                if (entry != entries.rend())
+                {
+                    allocation = entry->Allocation;
+                    entries.erase(std::next(entry).base());
+
+                    s_Data.Stats.Hits++;
+                    s_Data.Stats.FreeCount--;
+                    s_Data.Stats.FreeBytes -= key.SizeClass;
+                }
+            }
+        }
+
+        if (allocation == VK_NULL_HANDLE)
+        {
+            requirements.size = key.SizeClass;
+
+            // Note: Transient attachments never leave tile memory on tilers, so they don't need any backing memory
+            if (createInfo.usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT)
+                allocation = VkUtils::Allocator::AllocateImageMemory(requirements, VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED);
+
+            bool lazy = (allocation != VK_NULL_HANDLE);
+            if (!lazy)
+                allocation = VkUtils::Allocator::AllocateImageMemory(requirements, VMA_MEMORY_USAGE_GPU_ONLY);
+
+            HZ_ASSERT((allocation != VK_NULL_HANDLE), "Failed to allocate memory for render target.");
+
+            std::scoped_lock<std::mutex> lock(s_Mutex);
+            if (lazy)
+                s_Data.Stats.Lazy++;
+        }
+
+        VK_CHECK_RESULT(vmaBindImageMemory(VkUtils::Allocator::GetVmaAllocator(), allocation, image));
+
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+        s_Data.Used[allocation] = key;
+        s_Data.Stats.UsedCount = s_Data.Used.size();
+
+        return allocation;
+    }
+
+    void VulkanRenderTargetPool::Release(VkImage image, VmaAllocation allocation)
+    {
+        vkDestroyImage(VulkanContext::GetDevice()->GetVkDevice(), image, nullptr);
+
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+
+        auto it = s_Data.Used.find(allocation);
+        HZ_ASSERT((it != s_Data.Used.end()), "Tried to release an allocation which wasn't acquired from the render target pool.");
+
+        Key key = it->second;
+        s_Data.Used.erase(it);
+
+        s_Data.Free[key].push_back({ allocation, s_Data.Frame });
+
+        s_Data.Stats.UsedCount = s_Data.Used.size();
+        s_Data.Stats.FreeCount++;
+        s_Data.Stats.FreeBytes += key.SizeClass;
+    }
+
+    VulkanRenderTargetPool::Statistics VulkanRenderTargetPool::GetStatistics()
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+        return s_Data.Stats;
+    }
+
+    bool VulkanRenderTargetPool::Fits(VmaAllocation allocation, const VkMemoryRequirements& requirements)
+    {
+        VmaAllocationInfo info = {};
+        vmaGetAllocationInfo(VkUtils::Allocator::GetVmaAllocator(), allocation, &info);
+
+        return (requirements.memoryTypeBits & (1u << info.memoryType)) && (info.offset % requirements.alignment == 0) && (info.size >= requirements.size);
+    }
+
+    VkDeviceSize VulkanRenderTargetPool::GetSizeClass(VkDeviceSize size)
+    {
+        // Note: Sizes are rounded up to a quarter of their power of two,
+        // this wastes at most 25% while a resize usually stays in the same class.
+        if (size <= MinSizeClass)
+            return MinSizeClass;
+
+        VkDeviceSize step = std::bit_floor(size) / 4;
+        return (size + step - 1) / step * step;
+    }
+
+    size_t VulkanRenderTargetPool::Hash::operator () (const Key& key) const
+    {
+        size_t hash = 0;
+        auto combine = [&hash](size_t value) { hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2); };
+
+        combine(std::hash<uint32_t>()((uint32_t)key.Format));
+        combine(std::hash<uint32_t>()((uint32_t)key.Usage));
+        combine(std::hash<uint32_t>()((uint32_t)key.Samples));
+        combine(std::hash<uint64_t>()((uint64_t)key.SizeClass));
+
+        return hash;
+    }
+
+}
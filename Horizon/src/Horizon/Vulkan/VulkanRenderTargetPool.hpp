@@ -0,0 +1,94 @@
+#pragma once
+
+#include "Horizon/Core/Core.hpp"
+
+#include <mutex>
+#include <vector>
+#include <unordered_map>
+
+#include <vulkan/vulkan.h>
+#include <vma/vk_mem_alloc.h>
+
+namespace Hz
+{
+
+    // Recycles the memory of render targets (attachments), so recreating a target reuses
+    // an allocation of the same (format, usage, samples, size class) that fits its requirements.
+    // Note: Images release their memory through Renderer::Free, so it only becomes available a frame later.
+    // A resize therefore can't reuse its own previous allocation, but repeated resizes (dragging the window) reuse each other's.
+    // Note: Transient attachments get lazily allocated memory when the device has it.
+    class VulkanRenderTargetPool
+    {
+    public:
+        struct Statistics
+        {
+        public:
+            uint64_t Requests = 0;
+            uint64_t Hits = 0;          // Requests served by a recycled allocation
+            uint64_t Lazy = 0;          // Allocations made from lazily allocated memory
+
+            size_t UsedCount = 0;
+            size_t FreeCount = 0;
+            VkDeviceSize FreeBytes = 0; // Memory held by the pool, but not bound to an image
+        };
+
+    public:
+        static void Update(); // Note: Gets called by the renderer every frame, frees allocations which have been idle for too long
+        static void Destroy();
+
+        // Creates the image and binds it to pooled memory
+        static VmaAllocation Acquire(const VkImageCreateInfo& createInfo, VkImage& image);
+        // Destroys the image and keeps the memory around, Note: The image must no longer be in use by the GPU
+        static void Release(VkImage image, VmaAllocation allocation);
+
+        static Statistics GetStatistics();
+
+    private:
+        static VkDeviceSize GetSizeClass(VkDeviceSize size);
+        static bool Fits(VmaAllocation allocation, const VkMemoryRequirements& requirements); // Memory type, alignment & size
+
+        struct Key
+        {
+        public:
+            VkFormat Format = VK_FORMAT_UNDEFINED;
+            VkImageUsageFlags Usage = 0;
+            VkSampleCountFlagBits Samples = VK_SAMPLE_COUNT_1_BIT;
+            VkDeviceSize SizeClass = 0;
+
+            bool operator == (const Key& other) const = default;
+        };
+
+        struct Hash
+        {
+        public:
+            size_t operator () (const Key& key) const;
+        };
+
+        struct Entry
+        {
+        public:
+            VmaAllocation Allocation = VK_NULL_HANDLE;
+            uint64_t ReleasedFrame = 0;
+        };
+
+        // Note: We store our info in a struct, so we can ensure lifetime
+        // of all objects easily while the class remains static.
+        struct Info
+        {
+        public:
+            std::unordered_map<Key, std::vector<Entry>, Hash> Free = { };
+            std::unordered_map<VmaAllocation, Key> Used = { };
+
+            uint64_t Frame = 0;
+            Statistics Stats = { };
+        };
+
+        inline static std::mutex s_Mutex = {};
+        inline static Info s_Data = {};
+
+    public:
+        inline static constexpr const uint64_t MaxIdleFrames = 120;
+        inline static constexpr const VkDeviceSize MinSizeClass = 64 * 1024;
+    };
+
+}
@@ -1,8 +1,10 @@
 #include "hzpch.h"
 #include "VulkanRenderer.hpp"
 
+#include "Horizon/Core/Jobs.hpp"
 #include "Horizon/Core/Logging.hpp"
 #include "Horizon/Core/Window.hpp"
+#include "Horizon/Core/FrameAllocator.hpp"
 
 #include "Horizon/Renderer/Renderer.hpp"
 #include "Horizon/Renderer/GraphicsContext.hpp"
@@ -15,7 +17,18 @@
 #include "Horizon/Vulkan/VulkanCommandBuffer.hpp"
 #include "Horizon/Vulkan/VulkanRenderpass.hpp"
 #include "Horizon/Vulkan/VulkanBuffers.hpp"
+#include "Horizon/Vulkan/VulkanPipeline.hpp"
+#include "Horizon/Vulkan/VulkanDescriptors.hpp"
 #include "Horizon/Vulkan/VulkanImage.hpp"
+#include "Horizon/Vulkan/VulkanDefragmenter.hpp"
+#include "Horizon/Vulkan/VulkanStreamedImage.hpp"
+#include "Horizon/Vulkan/VulkanImageLoader.hpp"
+#include "Horizon/Vulkan/VulkanRenderTargetPool.hpp"
+#include "Horizon/Vulkan/VulkanGpuProfiler.hpp"
+
+#include "Horizon/Utils/Profiler.hpp"
+#include "Horizon/Utils/FrameTimer.hpp"
+#include "Horizon/Utils/AllocationTracker.hpp"
 
 #include <Pulse/Core/Defines.hpp>
 #include <Pulse/Enum/Enum.hpp>
@@ -27,6 +40,8 @@ namespace Hz
     {
         s_Data = new Info();
         s_Data->Specification = specs;
+
+        FrameAllocator::Init((uint32_t)specs.Buffers);
     }
 
     bool VulkanRenderer::Initialized()
@@ -36,6 +51,8 @@ namespace Hz
 
     void VulkanRenderer::Destroy()
     {
+        FrameAllocator::Destroy();
+
         delete s_Data;
         s_Data = nullptr;
     }
@@ -46,12 +63,20 @@ namespace Hz
         s_Data->Specification.VSync = vsync;
     }
 
-    void VulkanRenderer::BeginFrame()
+    void VulkanRenderer::BeginFrame(uint32_t frame)
     {
+        // Note: Set even when minimized, so we stay in step with the recording thread
+        VulkanContext::GetSwapChain()->m_CurrentFrame = frame;
+
         if (Window::Get().IsMinimized())
             return;
 
-        Renderer::FreeObjects();
+        FrameTimer::BeginFrame();
+        AllocationTracker::NewFrame();
+        {
+            FrameTimer::Scope timer(FramePhase::Update);
+            Renderer::FreeObjects();
+        }
 
         auto swapChain = VulkanContext::GetSwapChain();
         {
@@ -60,15 +85,31 @@ namespace Hz
             {
                 auto device = VulkanContext::GetDevice()->GetVkDevice();
 
+                FrameTimer::Scope timer(FramePhase::FenceWait);
                 vkWaitForFences(device, (uint32_t)fences.size(), fences.data(), VK_TRUE, Pulse::Numeric::Max<uint64_t>());
                 vkResetFences(device, (uint32_t)fences.size(), fences.data());
             }
             s_Data->Manager.ResetFences();
 
             s_Data->Manager.Add(swapChain->GetCurrentImageAvailableSemaphore());
+
+            // Note: Everything that could reference the frame's arena has finished
+            FrameAllocator::NewFrame(GetCurrentFrame());
+        }
+        {
+            FrameTimer::Scope timer(FramePhase::Update);
+            HZ_ALLOCATION_TAG(AllocationTag::Vulkan);
+
+            VulkanDefragmenter::Update();
+            VulkanTextureStreamer::Update();
+            VulkanImageLoader::Update();
+            VulkanRenderTargetPool::Update();
+            VulkanGpuProfiler::Update();
+            VkUtils::Allocator::UpdateStatistics();
         }
         {
             // Acquire SwapChain Image
+            FrameTimer::Scope timer(FramePhase::Acquire);
             swapChain->m_AcquiredImage = swapChain->AcquireNextImage();;
         }
     }
@@ -98,6 +139,9 @@ namespace Hz
 
 		VkResult result = VK_SUCCESS;
 		{
+            FrameTimer::Scope timer(FramePhase::Present);
+            auto queueLock = RenderThread::Lock();
+
 			// Note(Jorben): Without this line there is a memory leak on windows when validation layers are enabled.
             #if defined(HZ_PLATFORM_WINDOWS)
 			if constexpr (VulkanContext::s_Validation)
@@ -120,20 +164,40 @@ namespace Hz
 		}
 
         s_Data->Manager.ResetSemaphores();
-		swapChain->m_CurrentFrame = (swapChain->m_CurrentFrame + 1) % (uint32_t)s_Data->Specification.Buffers;
+
+        FrameTimer::EndFrame();
     }
 
     void VulkanRenderer::BeginDynamic(Ref<CommandBuffer> cmdBuf, DynamicRenderState&& state)
     {
         Ref<VulkanCommandBuffer> vkCmdBuf = cmdBuf.As<VulkanCommandBuffer>();
 
-        VkRenderingAttachmentInfo colourAttachment = {};
-        colourAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
-        colourAttachment.imageView = (state.ColourAttachment ? state.ColourAttachment.As<VulkanImage>()->GetVkImageView() : VK_NULL_HANDLE);
-        colourAttachment.imageLayout = (state.ColourAttachment ? (VkImageLayout)state.ColourAttachment->GetSpecification().Layout : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
-        colourAttachment.loadOp = (VkAttachmentLoadOp)state.ColourLoadOp;
-        colourAttachment.storeOp = (VkAttachmentStoreOp)state.ColourStoreOp;
-        colourAttachment.clearValue = { state.ColourClearValue.r, state.ColourClearValue.g, state.ColourClearValue.b, state.ColourClearValue.a };
+        InlineVector<VkRenderingAttachmentInfo, 8> colourAttachments = { };
+        colourAttachments.reserve((state.ColourAttachment ? 1 : 0) + state.ColourAttachments.size());
+
+        auto addColour = [&colourAttachments](Ref<Image> image, LoadOperation loadOp, StoreOperation storeOp, const glm::vec4& clearValue, Ref<Image> resolve)
+        {
+            VkRenderingAttachmentInfo& colourAttachment = colourAttachments.emplace_back();
+            colourAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+            colourAttachment.imageView = image.As<VulkanImage>()->GetVkImageView();
+            colourAttachment.imageLayout = (VkImageLayout)image->GetSpecification().Layout;
+            colourAttachment.loadOp = (VkAttachmentLoadOp)loadOp;
+            colourAttachment.storeOp = (VkAttachmentStoreOp)storeOp;
+            colourAttachment.clearValue = { clearValue.r, clearValue.g, clearValue.b, clearValue.a };
+
+            // Note: The resolve happens at the end of the rendering scope, no separate blit needed
+            if (resolve)
+            {
+                colourAttachment.resolveMode = VK_RESOLVE_MODE_AVERAGE_BIT;
+                colourAttachment.resolveImageView = resolve.As<VulkanImage>()->GetVkImageView();
+                colourAttachment.resolveImageLayout = (VkImageLayout)resolve->GetSpecification().Layout;
+            }
+        };
+
+        if (state.ColourAttachment)
+            addColour(state.ColourAttachment, state.ColourLoadOp, state.ColourStoreOp, state.ColourClearValue, state.ColourResolve);
+        for (auto& colour : state.ColourAttachments)
+            addColour(colour.Attachment, colour.LoadOp, colour.StoreOp, colour.ClearColour, colour.Resolve);
 
         VkRenderingAttachmentInfo depthAttachment = {};
         depthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
@@ -149,6 +213,11 @@ namespace Hz
             width = state.ColourAttachment->GetSpecification().Width;
             height = state.ColourAttachment->GetSpecification().Height;
         }
+        else if (!state.ColourAttachments.empty())
+        {
+            width = state.ColourAttachments[0].Attachment->GetSpecification().Width;
+            height = state.ColourAttachments[0].Attachment->GetSpecification().Height;
+        }
         else if (state.DepthAttachment)
         {
             width = state.DepthAttachment->GetSpecification().Width;
@@ -164,10 +233,11 @@ namespace Hz
         renderingInfo.renderArea.offset = { 0, 0 };
         renderingInfo.renderArea.extent = { width, height };
         renderingInfo.layerCount = 1;
-        renderingInfo.colorAttachmentCount = (state.ColourAttachment ? 1 : 0);
-        renderingInfo.pColorAttachments = (state.ColourAttachment ? &colourAttachment : nullptr);
+        renderingInfo.colorAttachmentCount = (uint32_t)colourAttachments.size();
+        renderingInfo.pColorAttachments = (colourAttachments.empty() ? nullptr : colourAttachments.data());
         renderingInfo.pDepthAttachment =(state.DepthAttachment ? &depthAttachment : nullptr);
 
+        VulkanGpuProfiler::BeginZone(vkCmdBuf->GetVkCommandBuffer(GetCurrentFrame()), "Dynamic rendering");
         vkCmdBeginRendering(vkCmdBuf->GetVkCommandBuffer(GetCurrentFrame()), &renderingInfo);
     }
 
@@ -176,6 +246,7 @@ namespace Hz
         Ref<VulkanCommandBuffer> vkCmdBuf = cmdBuf.As<VulkanCommandBuffer>();
 
         vkCmdEndRendering(vkCmdBuf->GetVkCommandBuffer(GetCurrentFrame()));
+        VulkanGpuProfiler::EndZone(vkCmdBuf->GetVkCommandBuffer(GetCurrentFrame()));
     }
 
     void VulkanRenderer::Begin(Ref<CommandBuffer> cmdBuf)
@@ -192,6 +263,12 @@ namespace Hz
 		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 
         VK_CHECK_RESULT(vkBeginCommandBuffer(commandBuffer, &beginInfo));
+
+        vkCmdBuf->m_Counters = {};
+        vkCmdBuf->m_Bound = {}; // Note: Nothing is bound at the start of a command buffer
+        vkCmdBuf->m_RecordingFrame = currentFrame;
+        VulkanGpuProfiler::BeginCommandBuffer(commandBuffer);
+        VulkanGpuProfiler::BeginZone(commandBuffer, "Command buffer");
     }
 
     void VulkanRenderer::Begin(Ref<Renderpass> renderpass)
@@ -201,6 +278,7 @@ namespace Hz
         Ref<VulkanCommandBuffer> vkCmdBuf = cmdBuf.As<VulkanCommandBuffer>();
 
         Begin(cmdBuf);
+        vkRenderpass->Revalidate();
 
         auto size = renderpass->GetSize();
         VkExtent2D extent = { size.first, size.second };
@@ -212,21 +290,28 @@ namespace Hz
         renderPassInfo.renderArea.offset = { 0, 0 };
         renderPassInfo.renderArea.extent = extent;
 
-        std::vector<VkClearValue> clearValues = {};
+        InlineVector<VkClearValue, 8> clearValues = {};
         if (!vkRenderpass->m_Specification.ColourAttachment.empty())
         {
             VkClearValue colourClear = {{ { vkRenderpass->m_Specification.ColourClearColour.r, vkRenderpass->m_Specification.ColourClearColour.g, vkRenderpass->m_Specification.ColourClearColour.b, vkRenderpass->m_Specification.ColourClearColour.a } }};
             clearValues.push_back(colourClear);
         }
+        for (auto& colour : vkRenderpass->m_Specification.ColourAttachments)
+        {
+            VkClearValue colourClear = {{ { colour.ClearColour.r, colour.ClearColour.g, colour.ClearColour.b, colour.ClearColour.a } }};
+            clearValues.push_back(colourClear);
+        }
         if (vkRenderpass->m_Specification.DepthAttachment)
         {
             VkClearValue depthClear = { { { 1.0f, 0 } } };
             clearValues.push_back(depthClear);
         }
+        clearValues.resize(clearValues.size() + vkRenderpass->GetResolveAttachmentCount(), VkClearValue()); // Note: Resolve targets are never cleared
 
         renderPassInfo.clearValueCount = (uint32_t)clearValues.size();
         renderPassInfo.pClearValues = clearValues.data();
 
+        VulkanGpuProfiler::BeginZone(vkCmdBuf->m_CommandBuffers[GetCurrentFrame()], "Renderpass");
         vkCmdBeginRenderPass(vkCmdBuf->m_CommandBuffers[GetCurrentFrame()], &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
 
         VkViewport viewport = {};
@@ -236,30 +321,38 @@ namespace Hz
         viewport.height = (float)extent.height;
         viewport.minDepth = 0.0f;
         viewport.maxDepth = 1.0f;
-        vkCmdSetViewport(vkCmdBuf->m_CommandBuffers[GetCurrentFrame()], 0, 1, &viewport);
+        vkCmdBuf->SetViewport(viewport);
 
         VkRect2D scissor = {};
         scissor.offset = { 0, 0 };
         scissor.extent = extent;
-        vkCmdSetScissor(vkCmdBuf->m_CommandBuffers[GetCurrentFrame()], 0, 1, &scissor);
+        vkCmdBuf->SetScissor(scissor);
     }
 
     void VulkanRenderer::End(Ref<CommandBuffer> cmdBuf)
     {
         Ref<VulkanCommandBuffer> vkCmdBuf = cmdBuf.As<VulkanCommandBuffer>();
 
+        VulkanGpuProfiler::EndCommandBuffer(vkCmdBuf->m_CommandBuffers[GetCurrentFrame()], vkCmdBuf->m_Counters);
         VK_CHECK_RESULT(vkEndCommandBuffer(vkCmdBuf->m_CommandBuffers[GetCurrentFrame()]));
     }
 
+    void VulkanRenderer::NextSubpass(Ref<Renderpass> renderpass)
+    {
+        Ref<VulkanCommandBuffer> vkCmdBuf = renderpass->GetCommandBuffer().As<VulkanCommandBuffer>();
+        vkCmdNextSubpass(vkCmdBuf->m_CommandBuffers[GetCurrentFrame()], VK_SUBPASS_CONTENTS_INLINE);
+    }
+
     void VulkanRenderer::End(Ref<Renderpass> renderpass)
     {
         Ref<VulkanCommandBuffer> vkCmdBuf = renderpass->GetCommandBuffer().As<VulkanCommandBuffer>();
         vkCmdEndRenderPass(vkCmdBuf->m_CommandBuffers[GetCurrentFrame()]);
+        VulkanGpuProfiler::EndZone(vkCmdBuf->m_CommandBuffers[GetCurrentFrame()]);
 
         End(renderpass->GetCommandBuffer());
     }
 
-    void VulkanRenderer::Submit(Ref<CommandBuffer> cmdBuf, ExecutionPolicy policy, Queue queue, const std::vector<Ref<CommandBuffer>>& waitOn)
+    void VulkanRenderer::Submit(Ref<CommandBuffer> cmdBuf, ExecutionPolicy policy, Queue queue, std::span<const Ref<CommandBuffer>> waitOn)
     {
         #if defined(HZ_CONFIG_DEBUG)
             VerifyExectionPolicy(policy);
@@ -274,7 +367,7 @@ namespace Hz
 		VkSubmitInfo submitInfo = {};
 		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-		std::vector<VkSemaphore> semaphores = { };
+		InlineVector<VkSemaphore, 8> semaphores = { };
 
 		for (auto cmd : waitOn)
 		{
@@ -294,7 +387,7 @@ namespace Hz
 				semaphores.push_back(semaphore);
 		}
 
-		std::vector<VkPipelineStageFlags> waitStages(semaphores.size(), VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT); // TODO: Make customizable?
+		InlineVector<VkPipelineStageFlags, 8> waitStages(semaphores.size(), VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT); // TODO: Make customizable?
 
 		submitInfo.waitSemaphoreCount = (uint32_t)semaphores.size();
 		submitInfo.pWaitSemaphores = semaphores.data();
@@ -306,6 +399,8 @@ namespace Hz
 		submitInfo.pSignalSemaphores = &vkCmdBuf->m_RenderFinishedSemaphores[currentFrame];
 
         // Submission
+        FrameTimer::Scope timer(FramePhase::Submit);
+        auto queueLock = RenderThread::Lock();
         switch (queue)
         {
         case Queue::Graphics:
@@ -333,7 +428,7 @@ namespace Hz
 		s_Data->Manager.Add(vkCmdBuf, policy);
     }
 
-    void VulkanRenderer::Submit(Ref<Renderpass> renderpass, ExecutionPolicy policy, Queue queue, const std::vector<Ref<CommandBuffer>>& waitOn)
+    void VulkanRenderer::Submit(Ref<Renderpass> renderpass, ExecutionPolicy policy, Queue queue, std::span<const Ref<CommandBuffer>> waitOn)
     {
         Submit(renderpass->GetCommandBuffer(), policy, queue, waitOn);
     }
@@ -343,6 +438,7 @@ namespace Hz
         Ref<VulkanCommandBuffer> vkCmdBuf = cmdBuf.As<VulkanCommandBuffer>();
 
 		vkCmdDraw(vkCmdBuf->GetVkCommandBuffer(GetCurrentFrame()), vertexCount, instanceCount, 0, 0);
+        vkCmdBuf->m_Counters.Draws++;
     }
 
     void VulkanRenderer::DrawIndexed(Ref<CommandBuffer> cmdBuf, Ref<IndexBuffer> indexBuffer, uint32_t instanceCount)
@@ -350,6 +446,103 @@ namespace Hz
         Ref<VulkanCommandBuffer> vkCmdBuf = cmdBuf.As<VulkanCommandBuffer>();
 
 		vkCmdDrawIndexed(vkCmdBuf->GetVkCommandBuffer(GetCurrentFrame()), indexBuffer->GetCount(), instanceCount, 0, 0, 0);
+        vkCmdBuf->m_Counters.Draws++;
+    }
+
+    void VulkanRenderer::Replay(Ref<CommandBuffer> cmdBuf, Ref<CommandStream> stream)
+    {
+        Replay(*cmdBuf.As<VulkanCommandBuffer>(), *stream, 0, stream->Size());
+    }
+
+    void VulkanRenderer::Replay(const std::vector<Ref<CommandBuffer>>& cmdBufs, Ref<CommandStream> stream)
+    {
+        if (cmdBufs.empty())
+            return;
+
+        // Note: Every command buffer has its own pool, so the shares are recorded in parallel on the job system.
+        // The command buffers have to be distinct, we wait here so the stream outlives the recording.
+        const CommandStream& commands = *stream;
+        const size_t share = (commands.Size() + cmdBufs.size() - 1) / cmdBufs.size();
+
+        JobHandle handle = Jobs::ParallelFor((uint32_t)cmdBufs.size(), 1, [&cmdBufs, &commands, share](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t i = begin; i < end; i++)
+            {
+                size_t first = std::min((size_t)i * share, commands.Size());
+                Replay(*static_cast<VulkanCommandBuffer*>(cmdBufs[i].Raw()), commands, first, std::min(share, commands.Size() - first));
+            }
+        }, "VulkanRenderer::Replay");
+
+        Jobs::Wait(handle);
+    }
+
+    void VulkanRenderer::Replay(VulkanCommandBuffer& cmdBuf, const CommandStream& stream, size_t first, size_t count)
+    {
+        HZ_PROFILE_SCOPE("VulkanRenderer::Replay");
+
+        // Note: Can run on a job worker, so the frame comes from the command buffer instead of the calling thread
+        const uint32_t frame = cmdBuf.m_RecordingFrame;
+        VkCommandBuffer commandBuffer = cmdBuf.m_CommandBuffers[frame];
+        RenderCounters& counters = cmdBuf.m_Counters;
+
+        std::span<const uint32_t> dynamicOffsets = stream.GetDynamicOffsets();
+
+        // Note: The state is only applied when it changes, the command buffer skips what's already bound
+        const CommandState* bound = nullptr;
+        for (const CommandPacket& packet : stream.GetPackets().subspan(first, count))
+        {
+            const CommandState& state = stream.GetState(packet.State);
+            if (&state != bound)
+            {
+                // Note: The objects are kept alive by the stream, so we skip the refcounting of As<>()
+                VulkanPipeline* pipeline = static_cast<VulkanPipeline*>(state.BoundPipeline.Raw());
+                VkPipelineBindPoint bindPoint = (VkPipelineBindPoint)state.BindPoint;
+
+                cmdBuf.BindPipeline(bindPoint, pipeline->GetVkPipeline());
+
+                for (uint32_t i = 0; i < CommandState::MaxDescriptorSets; i++)
+                {
+                    if (!state.Sets[i])
+                        continue;
+
+                    VkDescriptorSet set = static_cast<VulkanDescriptorSet*>(state.Sets[i].Raw())->GetVkDescriptorSet(frame);
+                    cmdBuf.BindDescriptorSet(bindPoint, pipeline->GetVkPipelineLayout(), i, set, dynamicOffsets.subspan(state.DynamicOffsetStart[i], state.DynamicOffsetCount[i]));
+                }
+
+                if (state.Vertices)
+                {
+                    VkBuffer buffer = static_cast<VulkanVertexBuffer*>(state.Vertices.Raw())->GetVkBuffer();
+                    VkDeviceSize offset = 0;
+
+                    cmdBuf.BindVertexBuffers({ &buffer, 1 }, { &offset, 1 });
+                }
+
+                if (state.Indices)
+                    cmdBuf.BindIndexBuffer(static_cast<VulkanIndexBuffer*>(state.Indices.Raw())->GetVkBuffer(), VK_INDEX_TYPE_UINT32);
+
+                bound = &state;
+            }
+
+            switch (packet.Type)
+            {
+            case CommandType::Draw:
+                vkCmdDraw(commandBuffer, packet.Draw.VertexCount, packet.Draw.InstanceCount, packet.Draw.FirstVertex, packet.Draw.FirstInstance);
+                counters.Draws++;
+                break;
+            case CommandType::DrawIndexed:
+                vkCmdDrawIndexed(commandBuffer, packet.DrawIndexed.IndexCount, packet.DrawIndexed.InstanceCount, packet.DrawIndexed.FirstIndex, packet.DrawIndexed.VertexOffset, packet.DrawIndexed.FirstInstance);
+                counters.Draws++;
+                break;
+            case CommandType::Dispatch:
+                vkCmdDispatch(commandBuffer, packet.Dispatch.GroupCountX, packet.Dispatch.GroupCountY, packet.Dispatch.GroupCountZ);
+                counters.Dispatches++;
+                break;
+
+            default:
+                HZ_LOG_ERROR("Invalid CommandType passed to VulkanRenderer::Replay.");
+                break;
+            }
+        }
     }
 
     void VulkanRenderer::Free(FreeFunction&& func)
@@ -360,15 +553,25 @@ namespace Hz
 
     void VulkanRenderer::FreeObjects()
     {
-        if (s_FreeQueue.empty()) return;
+        {
+            std::scoped_lock<std::mutex> lock(s_FreeQueueMutex);
+            if (s_FreeQueue.empty()) return;
+        }
 
         VulkanContext::GetDevice()->Wait(); // Wait till idle
 
         // We repeat this, because sometimes the function calls Free() of another objects and that will be unresolved without repeating
-        while (!s_FreeQueue.empty())
+        // Note: The queue is swapped under the lock, since other threads keep calling Free() while the render thread runs this
+        while (true)
         {
             std::queue<FreeFunction> functions = {};
-            functions.swap(s_FreeQueue);
+            {
+                std::scoped_lock<std::mutex> lock(s_FreeQueueMutex);
+                if (s_FreeQueue.empty())
+                    break;
+
+                functions.swap(s_FreeQueue);
+            }
 
             while (!functions.empty())
             {
@@ -389,6 +592,41 @@ namespace Hz
         return VulkanContext::GetSwapChain()->GetCurrentFrame();
     }
 
+    MemoryStatistics VulkanRenderer::GetMemoryStatistics()
+    {
+        return VkUtils::Allocator::GetStatistics();
+    }
+
+    void VulkanRenderer::AddMemoryBudgetCallback(MemoryBudgetCallback&& callback, float highThreshold)
+    {
+        VkUtils::Allocator::AddBudgetCallback(std::move(callback), highThreshold);
+    }
+
+    void VulkanRenderer::Defragment(const DefragmentationSpecification& specs)
+    {
+        VulkanDefragmenter::Begin(specs);
+    }
+
+    bool VulkanRenderer::IsDefragmenting()
+    {
+        return VulkanDefragmenter::Active();
+    }
+
+    void VulkanRenderer::SetStreamingBudget(uint64_t bytes)
+    {
+        VulkanTextureStreamer::SetBudget(bytes);
+    }
+
+    GpuTimings VulkanRenderer::GetGpuTimings()
+    {
+        return VulkanGpuProfiler::GetTimings();
+    }
+
+    RenderCounters VulkanRenderer::GetFrameCounters()
+    {
+        return VulkanGpuProfiler::GetFrameCounters();
+    }
+
     void VulkanRenderer::VerifyExectionPolicy(ExecutionPolicy& policy) // Should only be used in Debug
     {
         if (!(policy & ExecutionPolicy::InOrder) && !(policy & ExecutionPolicy::Parallel))
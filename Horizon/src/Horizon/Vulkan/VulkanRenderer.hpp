@@ -6,6 +6,7 @@
 
 #include "Horizon/Vulkan/VulkanTaskManager.hpp"
 
+#include <span>
 #include <queue>
 #include <mutex>
 
@@ -13,6 +14,7 @@ namespace Hz
 {
 
     class VulkanSwapChain;
+    class VulkanCommandBuffer;
 
     class VulkanRenderer
     {
@@ -23,7 +25,7 @@ namespace Hz
 
         static void Recreate(uint32_t width, uint32_t height, const bool vsync);
 
-        static void BeginFrame();
+        static void BeginFrame(uint32_t frame); // Note: frame is the index the frame was recorded with
         static void EndFrame();
         static void Present();
 
@@ -33,24 +35,40 @@ namespace Hz
         static void Begin(Ref<CommandBuffer> cmdBuf);
         static void Begin(Ref<Renderpass> renderpass);
         static void End(Ref<CommandBuffer> cmdBuf);
+        static void NextSubpass(Ref<Renderpass> renderpass);
         static void End(Ref<Renderpass> renderpass);
-        static void Submit(Ref<CommandBuffer> cmdBuf, ExecutionPolicy policy, Queue queue, const std::vector<Ref<CommandBuffer>>& waitOn);
-        static void Submit(Ref<Renderpass> renderpass, ExecutionPolicy policy, Queue queue, const std::vector<Ref<CommandBuffer>>& waitOn);
+        static void Submit(Ref<CommandBuffer> cmdBuf, ExecutionPolicy policy, Queue queue, std::span<const Ref<CommandBuffer>> waitOn);
+        static void Submit(Ref<Renderpass> renderpass, ExecutionPolicy policy, Queue queue, std::span<const Ref<CommandBuffer>> waitOn);
 
         static void Draw(Ref<CommandBuffer> cmdBuf, uint32_t vertexCount, uint32_t instanceCount);
         static void DrawIndexed(Ref<CommandBuffer> cmdBuf, Ref<IndexBuffer> indexBuffer, uint32_t instanceCount);
 
+        static void Replay(Ref<CommandBuffer> cmdBuf, Ref<CommandStream> stream);
+        static void Replay(const std::vector<Ref<CommandBuffer>>& cmdBufs, Ref<CommandStream> stream);
+
         static void Free(FreeFunction&& func);
         static void FreeObjects();
 
         static uint32_t GetAcquiredImage();
         static uint32_t GetCurrentFrame();
 
+        static MemoryStatistics GetMemoryStatistics();
+        static void AddMemoryBudgetCallback(MemoryBudgetCallback&& callback, float highThreshold);
+
+        static void Defragment(const DefragmentationSpecification& specs);
+        static bool IsDefragmenting();
+
+        static void SetStreamingBudget(uint64_t bytes);
+
+        static GpuTimings GetGpuTimings();
+        static RenderCounters GetFrameCounters();
+
         inline static VulkanTaskManager& GetTaskManager() { return s_Data->Manager; }
         inline static const RendererSpecification& GetSpecification() { return s_Data->Specification; }
 
     private:
         static void VerifyExectionPolicy(ExecutionPolicy& policy);
+        static void Replay(VulkanCommandBuffer& cmdBuf, const CommandStream& stream, size_t first, size_t count);
 
     private:
         // Note: We store our info in a struct, so we can ensure lifetime
@@ -10,6 +10,7 @@
 #include "Horizon/Vulkan/VulkanContext.hpp"
 #include "Horizon/Vulkan/VulkanImage.hpp"
 #include "Horizon/Vulkan/VulkanCommandBuffer.hpp"
+#include "Horizon/Vulkan/VulkanRenderpassCache.hpp"
 
 namespace Hz
 {
@@ -17,7 +18,24 @@ namespace Hz
     VulkanRenderpass::VulkanRenderpass(RenderpassSpecification specs, Ref<CommandBuffer> commandBuffer)
         : m_Specification(specs), m_CommandBuffer(commandBuffer)
     {
-        HZ_ASSERT(((!m_Specification.ColourAttachment.empty()) || m_Specification.DepthAttachment), "No Colour or Depth image passed in.");
+        HZ_ASSERT(((!m_Specification.ColourAttachment.empty()) || (!m_Specification.ColourAttachments.empty()) || m_Specification.DepthAttachment), "No Colour or Depth image passed in.");
+
+        VkPhysicalDeviceProperties properties = {};
+        vkGetPhysicalDeviceProperties(VulkanContext::GetPhysicalDevice()->GetVkPhysicalDevice(), &properties);
+        HZ_ASSERT((GetColourAttachmentCount() <= properties.limits.maxColorAttachments), "Too many colour attachments, the device supports up to {0}.", properties.limits.maxColorAttachments);
+
+        #if !defined(HZ_CONFIG_DIST)
+        {
+            std::vector<Ref<Image>> images = { m_Specification.DepthAttachment };
+            if (!m_Specification.ColourAttachment.empty())
+                images.push_back(m_Specification.ColourAttachment[0]);
+            for (auto& colour : m_Specification.ColourAttachments)
+                images.push_back(colour.Attachment);
+
+            for (auto& image : images)
+                HZ_ASSERT((!image || image->GetSpecification().Samples == m_Specification.Samples), "Every attachment of a renderpass needs to have the renderpass' sample count.");
+        }
+        #endif
 
         std::pair<uint32_t, uint32_t> size = GetSize();
 
@@ -32,9 +50,8 @@ namespace Hz
 
     void VulkanRenderpass::Resize(uint32_t width, uint32_t height)
     {
-        for (auto& framebuffer : m_Framebuffers)
-            vkDestroyFramebuffer(VulkanContext::GetDevice()->GetVkDevice(), framebuffer, nullptr);
-
+        // Note: An unchanged framebuffer is simply acquired again
+        ReleaseFramebuffers();
         CreateFramebuffers(width, height);
     }
 
@@ -47,6 +64,11 @@ namespace Hz
             size.first = m_Specification.ColourAttachment[0]->GetSpecification().Width;
             size.second = m_Specification.ColourAttachment[0]->GetSpecification().Height;
         }
+        else if (!m_Specification.ColourAttachments.empty())
+        {
+            size.first = m_Specification.ColourAttachments[0].Attachment->GetSpecification().Width;
+            size.second = m_Specification.ColourAttachments[0].Attachment->GetSpecification().Height;
+        }
         else if (m_Specification.DepthAttachment)
         {
             size.first = m_Specification.DepthAttachment->GetSpecification().Width;
@@ -56,96 +78,274 @@ namespace Hz
         return size;
     }
 
+    uint32_t VulkanRenderpass::GetColourAttachmentCount() const
+    {
+        return (m_Specification.ColourAttachment.empty() ? 0 : 1) + (uint32_t)m_Specification.ColourAttachments.size();
+    }
+
+    uint32_t VulkanRenderpass::GetColourAttachmentCount(uint32_t subpass) const
+    {
+        if (m_Specification.Subpasses.empty())
+            return GetColourAttachmentCount();
+
+        HZ_ASSERT((subpass < m_Specification.Subpasses.size()), "Subpass {0} doesn't exist, the renderpass has {1} subpasses.", subpass, m_Specification.Subpasses.size());
+        return (uint32_t)m_Specification.Subpasses[subpass].ColourAttachments.size();
+    }
+
+    uint32_t VulkanRenderpass::GetResolveAttachmentCount() const
+    {
+        uint32_t count = ((!m_Specification.ColourAttachment.empty() && !m_Specification.ColourResolve.empty()) ? 1 : 0);
+        for (auto& colour : m_Specification.ColourAttachments)
+            count += (colour.Resolve ? 1 : 0);
+
+        return count;
+    }
+
+    uint32_t VulkanRenderpass::GetSubpassCount() const
+    {
+        return std::max((uint32_t)m_Specification.Subpasses.size(), 1u);
+    }
+
     void VulkanRenderpass::CreateRenderpass()
     {
         ///////////////////////////////////////////////////////////
         // Renderpass
         ///////////////////////////////////////////////////////////
         std::vector<VkAttachmentDescription> attachments = { };
-        std::vector<VkAttachmentReference> attachmentRefs = { };
 
-        if (!m_Specification.ColourAttachment.empty())
+        const VkSampleCountFlagBits samples = (VkSampleCountFlagBits)m_Specification.Samples;
+
+        // Note: Attachments which get resolved stay in attachment layout, the resolve target gets the final layout
+        auto addColour = [&](ImageFormat format, LoadOperation loadOp, StoreOperation storeOp, ImageLayout previous, ImageLayout final, bool resolved)
         {
             VkAttachmentDescription& colorAttachment = attachments.emplace_back();
-            colorAttachment.format = (VkFormat)m_Specification.ColourAttachment[0]->GetSpecification().Format;
-            colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-            colorAttachment.loadOp = (VkAttachmentLoadOp)m_Specification.ColourLoadOp;
-            colorAttachment.storeOp = (VkAttachmentStoreOp)m_Specification.ColourStoreOp;
+            colorAttachment.format = (VkFormat)format;
+            colorAttachment.samples = samples;
+            colorAttachment.loadOp = (VkAttachmentLoadOp)loadOp;
+            colorAttachment.storeOp = (VkAttachmentStoreOp)storeOp;
             colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
             colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-            colorAttachment.initialLayout = (VkImageLayout)m_Specification.PreviousColourImageLayout;
-            colorAttachment.finalLayout = (VkImageLayout)m_Specification.FinalColourImageLayout;
+            colorAttachment.initialLayout = (VkImageLayout)previous;
+            colorAttachment.finalLayout = (resolved ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : (VkImageLayout)final);
+        };
 
-            VkAttachmentReference& colorAttachmentRef = attachmentRefs.emplace_back();
-            colorAttachmentRef.attachment = (uint32_t)(attachments.size() - 1);
-            colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        // Note: Resolve targets are added after the depth attachment
+        std::vector<std::pair<Ref<Image>, ImageLayout>> resolves = { };
+
+        if (!m_Specification.ColourAttachment.empty())
+        {
+            addColour(m_Specification.ColourAttachment[0]->GetSpecification().Format, m_Specification.ColourLoadOp, m_Specification.ColourStoreOp, m_Specification.PreviousColourImageLayout, m_Specification.FinalColourImageLayout, !m_Specification.ColourResolve.empty());
+            resolves.emplace_back((m_Specification.ColourResolve.empty() ? Ref<Image>(nullptr) : m_Specification.ColourResolve[0]), m_Specification.FinalColourImageLayout);
+        }
+
+        for (auto& colour : m_Specification.ColourAttachments)
+        {
+            addColour(colour.Attachment->GetSpecification().Format, colour.LoadOp, colour.StoreOp, colour.PreviousLayout, colour.FinalLayout, (bool)colour.Resolve);
+            resolves.emplace_back(colour.Resolve, colour.FinalLayout);
         }
 
         if (m_Specification.DepthAttachment)
         {
             VkAttachmentDescription& depthAttachment = attachments.emplace_back();
             depthAttachment.format = (VkFormat)m_Specification.DepthAttachment->GetSpecification().Format;
-            depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+            depthAttachment.samples = samples;
             depthAttachment.loadOp = (VkAttachmentLoadOp)m_Specification.DepthLoadOp;
             depthAttachment.storeOp = (VkAttachmentStoreOp)m_Specification.DepthStoreOp;
             depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
             depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
             depthAttachment.initialLayout = (VkImageLayout)m_Specification.PreviousDepthImageLayout;
             depthAttachment.finalLayout = (VkImageLayout)m_Specification.FinalDepthImageLayout;
+        }
 
-            VkAttachmentReference& depthAttachmentRef = attachmentRefs.emplace_back();
-            depthAttachmentRef.attachment = (uint32_t)(attachments.size() - 1);
-            depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        // Note: Resolves happen inside the renderpass (at the end of the last subpass writing the attachment)
+        std::vector<uint32_t> resolveIndices(resolves.size(), VK_ATTACHMENT_UNUSED);
+        for (size_t i = 0; i < resolves.size(); i++)
+        {
+            auto& [resolve, layout] = resolves[i];
+            if (!resolve)
+                continue;
+
+            HZ_ASSERT((m_Specification.Samples != SampleCount::Count1), "Resolve attachments require a multisampled renderpass.");
+            HZ_ASSERT((resolve->GetSpecification().Samples == SampleCount::Count1), "Resolve attachments can't be multisampled.");
+
+            VkAttachmentDescription& resolveAttachment = attachments.emplace_back();
+            resolveAttachment.format = (VkFormat)resolve->GetSpecification().Format;
+            resolveAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+            resolveAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            resolveAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+            resolveAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            resolveAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            resolveAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            resolveAttachment.finalLayout = (VkImageLayout)layout;
+
+            resolveIndices[i] = (uint32_t)(attachments.size() - 1);
         }
 
-        VkSubpassDescription subpass = {};
-        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-        if (!m_Specification.ColourAttachment.empty())
+        ///////////////////////////////////////////////////////////
+        // Subpasses
+        ///////////////////////////////////////////////////////////
+        const uint32_t colourCount = GetColourAttachmentCount();
+        const uint32_t depthIndex = colourCount; // Note: The depth attachment always comes after the colour attachments
+
+        // Note: Without explicit subpasses a single subpass writes every attachment
+        std::vector<SubpassSpecification> subpassSpecs = m_Specification.Subpasses;
+        if (subpassSpecs.empty())
         {
-            subpass.colorAttachmentCount = 1;
-            subpass.pColorAttachments = &attachmentRefs[0];
+            SubpassSpecification& all = subpassSpecs.emplace_back();
+            for (uint32_t i = 0; i < colourCount; i++)
+                all.ColourAttachments.push_back(i);
         }
-        else
+
+        const uint32_t subpassCount = (uint32_t)subpassSpecs.size();
+        auto toAttachment = [depthIndex](uint32_t index) { return (index == SubpassSpecification::Depth ? depthIndex : index); };
+
+        // Which attachments each subpass writes/reads, used for preserving contents & dependencies
+        std::vector<std::vector<bool>> writes(subpassCount, std::vector<bool>(attachments.size(), false));
+        std::vector<std::vector<bool>> reads(subpassCount, std::vector<bool>(attachments.size(), false));
+        for (uint32_t s = 0; s < subpassCount; s++)
         {
-            subpass.colorAttachmentCount = 0;
-            subpass.pColorAttachments = nullptr;
+            for (uint32_t index : subpassSpecs[s].ColourAttachments)
+            {
+                HZ_ASSERT((index < colourCount), "Subpass {0} references colour attachment {1}, but there are only {2}.", s, index, colourCount);
+                writes[s][index] = true;
+            }
+            for (uint32_t index : subpassSpecs[s].InputAttachments)
+            {
+                HZ_ASSERT((index < colourCount || (index == SubpassSpecification::Depth && m_Specification.DepthAttachment)), "Subpass {0} references an input attachment which doesn't exist.", s);
+                reads[s][toAttachment(index)] = true;
+            }
+            if (subpassSpecs[s].DepthTest && m_Specification.DepthAttachment && !reads[s][depthIndex])
+                writes[s][depthIndex] = true;
         }
 
-        if (m_Specification.DepthAttachment)
+        std::vector<uint32_t> lastWriter(colourCount, 0);
+        for (uint32_t s = 0; s < subpassCount; s++)
         {
-            if (!m_Specification.ColourAttachment.empty())
-                subpass.pDepthStencilAttachment = &attachmentRefs[1];
-            else
-                subpass.pDepthStencilAttachment = &attachmentRefs[0];
+            for (uint32_t index : subpassSpecs[s].ColourAttachments)
+                lastWriter[index] = s;
+        }
+
+        // Note: The references need to stay alive until the renderpass is created
+        std::vector<std::vector<VkAttachmentReference>> colourRefs(subpassCount);
+        std::vector<std::vector<VkAttachmentReference>> resolveRefs(subpassCount);
+        std::vector<std::vector<VkAttachmentReference>> inputRefs(subpassCount);
+        std::vector<std::vector<uint32_t>> preserveRefs(subpassCount);
+        std::vector<VkAttachmentReference> depthRefs(subpassCount);
+        std::vector<VkSubpassDescription> subpasses(subpassCount);
+
+        for (uint32_t s = 0; s < subpassCount; s++)
+        {
+            const SubpassSpecification& spec = subpassSpecs[s];
+
+            bool resolving = false;
+            for (uint32_t index : spec.ColourAttachments)
+            {
+                colourRefs[s].push_back({ index, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL });
+
+                bool resolve = (resolveIndices[index] != VK_ATTACHMENT_UNUSED && lastWriter[index] == s);
+                resolveRefs[s].push_back({ (resolve ? resolveIndices[index] : VK_ATTACHMENT_UNUSED), VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL });
+
+                if (resolve)
+                    writes[s][resolveIndices[index]] = true;
+                resolving |= resolve;
+            }
+
+            for (uint32_t index : spec.InputAttachments)
+                inputRefs[s].push_back({ toAttachment(index), (index == SubpassSpecification::Depth ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) });
+
+            // Note: Depth that's also read as an input can still be tested against, but not written
+            bool depth = (spec.DepthTest && m_Specification.DepthAttachment);
+            if (depth)
+                depthRefs[s] = { depthIndex, (reads[s][depthIndex] ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL) };
+
+            // Attachments used before & after this subpass, but not by it, need to be preserved
+            for (uint32_t a = 0; a < (uint32_t)attachments.size(); a++)
+            {
+                if (writes[s][a] || reads[s][a] || (a == depthIndex && depth))
+                    continue;
+
+                bool before = false, after = false;
+                for (uint32_t other = 0; other < subpassCount; other++)
+                {
+                    bool used = (writes[other][a] || reads[other][a]);
+                    before |= (used && other < s);
+                    after |= (used && other > s);
+                }
+
+                if (before && after)
+                    preserveRefs[s].push_back(a);
+            }
+
+            VkSubpassDescription& subpass = subpasses[s];
+            subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+            subpass.colorAttachmentCount = (uint32_t)colourRefs[s].size();
+            subpass.pColorAttachments = (colourRefs[s].empty() ? nullptr : colourRefs[s].data());
+            subpass.pResolveAttachments = (resolving ? resolveRefs[s].data() : nullptr);
+            subpass.inputAttachmentCount = (uint32_t)inputRefs[s].size();
+            subpass.pInputAttachments = (inputRefs[s].empty() ? nullptr : inputRefs[s].data());
+            subpass.preserveAttachmentCount = (uint32_t)preserveRefs[s].size();
+            subpass.pPreserveAttachments = (preserveRefs[s].empty() ? nullptr : preserveRefs[s].data());
+            subpass.pDepthStencilAttachment = (depth ? &depthRefs[s] : nullptr);
+        }
+
+        ///////////////////////////////////////////////////////////
+        // Dependencies
+        ///////////////////////////////////////////////////////////
+        std::vector<VkSubpassDependency> dependencies = { };
+
+        VkSubpassDependency& external = dependencies.emplace_back();
+        external.srcSubpass = VK_SUBPASS_EXTERNAL;
+        external.dstSubpass = 0;
+        external.srcStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+        external.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        external.srcAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+        external.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        external.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+
+        // Note: Every subpass waits on the previous one (to keep the writes ordered) and on every subpass
+        // which wrote one of its input attachments. These are by region, so the data never leaves tile memory.
+        for (uint32_t dst = 1; dst < subpassCount; dst++)
+        {
+            for (uint32_t src = 0; src < dst; src++)
+            {
+                bool input = false;
+                for (uint32_t a = 0; a < (uint32_t)attachments.size(); a++)
+                    input |= (writes[src][a] && reads[dst][a]);
+
+                if (!input && src != dst - 1)
+                    continue;
+
+                VkSubpassDependency& dependency = dependencies.emplace_back();
+                dependency.srcSubpass = src;
+                dependency.dstSubpass = dst;
+                dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+                dependency.dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+                dependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+                dependency.dstAccessMask = VK_ACCESS_INPUT_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+                dependency.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+            }
         }
 
-        std::array<VkSubpassDependency, 2> dependencies = { };
-        dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
-        dependencies[0].dstSubpass = 0;
-        dependencies[0].srcStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
-        dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-        dependencies[0].srcAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-        dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-        dependencies[0].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
-
-        dependencies[1].srcSubpass = 0;
-        dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
-        dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-        dependencies[1].dstStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
-        dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-        dependencies[1].dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-        dependencies[1].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+        VkSubpassDependency& last = dependencies.emplace_back();
+        last.srcSubpass = subpassCount - 1;
+        last.dstSubpass = VK_SUBPASS_EXTERNAL;
+        last.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        last.dstStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+        last.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        last.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+        last.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
 
         VkRenderPassCreateInfo renderPassInfo = {};
         renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
         renderPassInfo.attachmentCount = (uint32_t)attachments.size();
         renderPassInfo.pAttachments = attachments.data();
-        renderPassInfo.subpassCount = 1;
-        renderPassInfo.pSubpasses = &subpass;
+        renderPassInfo.subpassCount = subpassCount;
+        renderPassInfo.pSubpasses = subpasses.data();
         renderPassInfo.dependencyCount = (uint32_t)dependencies.size();
         renderPassInfo.pDependencies = dependencies.data();
 
-        VK_CHECK_RESULT(vkCreateRenderPass(VulkanContext::GetDevice()->GetVkDevice(), &renderPassInfo, nullptr, &m_RenderPass));
+        // Note: Renderpasses with the same description share a VkRenderPass (and therefore compatible pipelines)
+        m_RenderPass = VulkanRenderpassCache::GetRenderPass(renderPassInfo);
     }
 
     void VulkanRenderpass::CreateFramebuffers(uint32_t width, uint32_t height)
@@ -154,7 +354,9 @@ namespace Hz
         // Framebuffers
         ///////////////////////////////////////////////////////////
         // Framebuffer creation
+        m_Evictions = VulkanRenderpassCache::GetEvictions();
         m_Framebuffers.resize(VulkanContext::GetSwapChain()->GetSwapChainImages().size());
+        m_FramebufferIDs.resize(m_Framebuffers.size());
         for (size_t i = 0; i < m_Framebuffers.size(); i++)
         {
             std::vector<VkImageView> attachments = { };
@@ -171,36 +373,65 @@ namespace Hz
                     attachments.push_back(vkImage->GetVkImageView());
                 }
             }
+            for (auto& colour : m_Specification.ColourAttachments)
+            {
+                Ref<VulkanImage> vkImage = colour.Attachment.As<VulkanImage>();
+                attachments.push_back(vkImage->GetVkImageView());
+            }
             if (m_Specification.DepthAttachment)
             {
                 Ref<VulkanImage> vkImage = m_Specification.DepthAttachment.As<VulkanImage>();
                 attachments.push_back(vkImage->GetVkImageView());
             }
+            if (!m_Specification.ColourAttachment.empty() && !m_Specification.ColourResolve.empty())
+            {
+                Ref<VulkanImage> vkImage = m_Specification.ColourResolve[(m_Specification.ColourResolve.size() == 1 ? 0 : i)].As<VulkanImage>();
+                attachments.push_back(vkImage->GetVkImageView());
+            }
+            for (auto& colour : m_Specification.ColourAttachments)
+            {
+                if (!colour.Resolve)
+                    continue;
 
-            VkFramebufferCreateInfo framebufferInfo = {};
-            framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-            framebufferInfo.renderPass = m_RenderPass;
-            framebufferInfo.attachmentCount = (uint32_t)attachments.size();
-            framebufferInfo.pAttachments = attachments.data();
-            framebufferInfo.width = width;
-            framebufferInfo.height = height;
-            framebufferInfo.layers = 1;
+                Ref<VulkanImage> vkImage = colour.Resolve.As<VulkanImage>();
+                attachments.push_back(vkImage->GetVkImageView());
+            }
 
-            VK_CHECK_RESULT(vkCreateFramebuffer(VulkanContext::GetDevice()->GetVkDevice(), &framebufferInfo, nullptr, &m_Framebuffers[i]));
+            m_Framebuffers[i] = VulkanRenderpassCache::AcquireFramebuffer(m_RenderPass, attachments, width, height, m_FramebufferIDs[i]);
         }
     }
 
-    void VulkanRenderpass::Destroy()
+    void VulkanRenderpass::ReleaseFramebuffers()
     {
-        Renderer::Free([frameBuffers = m_Framebuffers, renderpass = m_RenderPass]()
+        Renderer::Free([ids = m_FramebufferIDs]()
         {
-            auto device = VulkanContext::GetDevice()->GetVkDevice();
+            for (auto id : ids)
+                VulkanRenderpassCache::ReleaseFramebuffer(id);
+        });
+    }
+
+    void VulkanRenderpass::Revalidate()
+    {
+        // Note: Only framebuffers that got evicted since our last check need to be looked up
+        uint64_t evictions = VulkanRenderpassCache::GetEvictions();
+        if (evictions == m_Evictions)
+            return;
 
-            for (auto& framebuffer : frameBuffers)
-                vkDestroyFramebuffer(device, framebuffer, nullptr);
+        m_Evictions = evictions;
+        if (std::none_of(m_FramebufferIDs.begin(), m_FramebufferIDs.end(), [](uint64_t id) { return VulkanRenderpassCache::IsEvicted(id); }))
+            return;
 
-            vkDestroyRenderPass(device, renderpass, nullptr);
-        });
+        // Note: The attachments have been recreated in place, so their current views & size are used
+        std::pair<uint32_t, uint32_t> size = GetSize();
+
+        ReleaseFramebuffers();
+        CreateFramebuffers(size.first, size.second);
+    }
+
+    void VulkanRenderpass::Destroy()
+    {
+        // Note: The VkRenderPass is owned by the cache
+        ReleaseFramebuffers();
     }
 
 }
@@ -25,6 +25,10 @@ namespace Hz
 		void Resize(uint32_t width, uint32_t height) override;
 
         std::pair<uint32_t, uint32_t> GetSize() const override;
+        uint32_t GetColourAttachmentCount() const override;
+        uint32_t GetColourAttachmentCount(uint32_t subpass) const override;
+        uint32_t GetSubpassCount() const override;
+        uint32_t GetResolveAttachmentCount() const;
 
 		inline const RenderpassSpecification& GetSpecification() override { return m_Specification; }
 		inline Ref<CommandBuffer> GetCommandBuffer() override { return m_CommandBuffer; }
@@ -35,6 +39,8 @@ namespace Hz
 	private:
 		void CreateRenderpass();
 		void CreateFramebuffers(uint32_t width, uint32_t height);
+		void ReleaseFramebuffers(); // Note: Released through Renderer::Free, since they might still be in use
+		void Revalidate(); // Acquires new framebuffers when the cache evicted one of ours (a recreated swapchain for example)
 		void Destroy();
 
 	private:
@@ -44,6 +50,8 @@ namespace Hz
 
 		VkRenderPass m_RenderPass = VK_NULL_HANDLE;
 		std::vector<VkFramebuffer> m_Framebuffers = { };
+		std::vector<uint64_t> m_FramebufferIDs = { }; // Cache IDs of m_Framebuffers
+		uint64_t m_Evictions = 0; // VulkanRenderpassCache::GetEvictions() when we last checked our framebuffers
 
         friend class VulkanRenderer;
 	};
@@ -0,0 +1,202 @@
+#include "hzpch.h"
+#include "VulkanRenderpassCache.hpp"
+
+#include "Horizon/Core/Logging.hpp"
+
+#include "Horizon/Vulkan/VulkanUtils.hpp"
+#include "Horizon/Vulkan/VulkanContext.hpp"
+
+#include <functional>
+
+namespace Hz
+{
+
+    ///////////////////////////////////////////////////////////
+    // Cache
+    ///////////////////////////////////////////////////////////
+    void VulkanRenderpassCache::Destroy()
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+        auto device = VulkanContext::GetDevice()->GetVkDevice();
+
+        for (auto& [key, entry] : s_Data.Framebuffers)
+            vkDestroyFramebuffer(device, entry.Framebuffer, nullptr);
+        for (auto& [key, renderPass] : s_Data.RenderPasses)
+            vkDestroyRenderPass(device, renderPass, nullptr);
+
+        s_Data = {};
+    }
+
+    VkRenderPass VulkanRenderpassCache::GetRenderPass(const VkRenderPassCreateInfo& createInfo)
+    {
+        std::vector<uint32_t> key = GetRenderPassKey(createInfo);
+
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+        if (auto it = s_Data.RenderPasses.find(key); it != s_Data.RenderPasses.end())
+            return it->second;
+
+        VkRenderPass renderPass = VK_NULL_HANDLE;
+        VK_CHECK_RESULT(vkCreateRenderPass(VulkanContext::GetDevice()->GetVkDevice(), &createInfo, nullptr, &renderPass));
+
+        s_Data.RenderPasses[std::move(key)] = renderPass;
+        return renderPass;
+    }
+
+    VkFramebuffer VulkanRenderpassCache::AcquireFramebuffer(VkRenderPass renderPass, const std::vector<VkImageView>& views, uint32_t width, uint32_t height, uint64_t& id)
+    {
+        FramebufferKey key = { renderPass, views, width, height };
+
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+        if (auto it = s_Data.Framebuffers.find(key); it != s_Data.Framebuffers.end())
+        {
+            it->second.References++;
+            id = it->second.ID;
+            return it->second.Framebuffer;
+        }
+
+        VkFramebufferCreateInfo framebufferInfo = {};
+        framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        framebufferInfo.renderPass = renderPass;
+        framebufferInfo.attachmentCount = (uint32_t)views.size();
+        framebufferInfo.pAttachments = views.data();
+        framebufferInfo.width = width;
+        framebufferInfo.height = height;
+        framebufferInfo.layers = 1;
+
+        VkFramebuffer framebuffer = VK_NULL_HANDLE;
+        VK_CHECK_RESULT(vkCreateFramebuffer(VulkanContext::GetDevice()->GetVkDevice(), &framebufferInfo, nullptr, &framebuffer));
+
+        id = s_Data.NextID++;
+        s_Data.IDs[id] = key;
+        s_Data.Framebuffers[std::move(key)] = { framebuffer, id, 1 };
+        return framebuffer;
+    }
+
+    void VulkanRenderpassCache::ReleaseFramebuffer(uint64_t id)
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+
+        // Note: The framebuffer might have been evicted already
+        auto key = s_Data.IDs.find(id);
+        if (key == s_Data.IDs.end())
+            return;
+
+        auto it = s_Data.Framebuffers.find(key->second);
+        if (--it->second.References > 0)
+            return;
+
+        vkDestroyFramebuffer(VulkanContext::GetDevice()->GetVkDevice(), it->second.Framebuffer, nullptr);
+        s_Data.Framebuffers.erase(it);
+        s_Data.IDs.erase(key);
+    }
+
+    void VulkanRenderpassCache::Evict(VkImageView view)
+    {
+        if (view == VK_NULL_HANDLE)
+            return;
+
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+        auto device = VulkanContext::GetDevice()->GetVkDevice();
+
+        // Note: Handles get reused by the driver, so a framebuffer may never outlive its views.
+        // Referenced framebuffers are destroyed as well, their owners acquire new ones (see IsEvicted).
+        size_t evicted = std::erase_if(s_Data.Framebuffers, [device, view](const auto& pair)
+        {
+            if (std::find(pair.first.Views.begin(), pair.first.Views.end(), view) == pair.first.Views.end())
+                return false;
+
+            vkDestroyFramebuffer(device, pair.second.Framebuffer, nullptr);
+            s_Data.IDs.erase(pair.second.ID);
+            return true;
+        });
+
+        if (evicted > 0)
+            s_Evictions.fetch_add(1, std::memory_order_release);
+    }
+
+    bool VulkanRenderpassCache::IsEvicted(uint64_t id)
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+        return !s_Data.IDs.contains(id);
+    }
+
+    size_t VulkanRenderpassCache::GetRenderPassCount()
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+        return s_Data.RenderPasses.size();
+    }
+
+    size_t VulkanRenderpassCache::GetFramebufferCount()
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+        return s_Data.Framebuffers.size();
+    }
+
+    std::vector<uint32_t> VulkanRenderpassCache::GetRenderPassKey(const VkRenderPassCreateInfo& createInfo)
+    {
+        std::vector<uint32_t> key = { };
+        auto addReferences = [&key](const VkAttachmentReference* references, uint32_t count)
+        {
+            key.push_back(references ? count : 0);
+            for (uint32_t i = 0; references && i < count; i++)
+                key.insert(key.end(), { references[i].attachment, (uint32_t)references[i].layout });
+        };
+
+        key.push_back(createInfo.attachmentCount);
+        for (uint32_t i = 0; i < createInfo.attachmentCount; i++)
+        {
+            const VkAttachmentDescription& attachment = createInfo.pAttachments[i];
+            key.insert(key.end(), { attachment.flags, (uint32_t)attachment.format, (uint32_t)attachment.samples, (uint32_t)attachment.loadOp, (uint32_t)attachment.storeOp, (uint32_t)attachment.stencilLoadOp, (uint32_t)attachment.stencilStoreOp, (uint32_t)attachment.initialLayout, (uint32_t)attachment.finalLayout });
+        }
+
+        key.push_back(createInfo.subpassCount);
+        for (uint32_t i = 0; i < createInfo.subpassCount; i++)
+        {
+            const VkSubpassDescription& subpass = createInfo.pSubpasses[i];
+            key.push_back((uint32_t)subpass.pipelineBindPoint);
+
+            addReferences(subpass.pInputAttachments, subpass.inputAttachmentCount);
+            addReferences(subpass.pColorAttachments, subpass.colorAttachmentCount);
+            addReferences(subpass.pResolveAttachments, subpass.colorAttachmentCount);
+            addReferences(subpass.pDepthStencilAttachment, 1);
+
+            key.push_back(subpass.preserveAttachmentCount);
+            key.insert(key.end(), subpass.pPreserveAttachments, subpass.pPreserveAttachments + subpass.preserveAttachmentCount);
+        }
+
+        key.push_back(createInfo.dependencyCount);
+        for (uint32_t i = 0; i < createInfo.dependencyCount; i++)
+        {
+            const VkSubpassDependency& dependency = createInfo.pDependencies[i];
+            key.insert(key.end(), { dependency.srcSubpass, dependency.dstSubpass, dependency.srcStageMask, dependency.dstStageMask, dependency.srcAccessMask, dependency.dstAccessMask, dependency.dependencyFlags });
+        }
+
+        return key;
+    }
+
+    size_t VulkanRenderpassCache::Hash::operator () (const std::vector<uint32_t>& key) const
+    {
+        size_t hash = 0;
+        auto combine = [&hash](size_t value) { hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2); };
+
+        for (uint32_t value : key)
+            combine(std::hash<uint32_t>()(value));
+
+        return hash;
+    }
+
+    size_t VulkanRenderpassCache::Hash::operator () (const FramebufferKey& key) const
+    {
+        size_t hash = 0;
+        auto combine = [&hash](size_t value) { hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2); };
+
+        combine(std::hash<void*>()((void*)key.RenderPass));
+        for (VkImageView view : key.Views)
+            combine(std::hash<void*>()((void*)view));
+        combine(std::hash<uint32_t>()(key.Width));
+        combine(std::hash<uint32_t>()(key.Height));
+
+        return hash;
+    }
+
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Horizon/Core/Core.hpp"
+
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <unordered_map>
+
+#include <vulkan/vulkan.h>
+
+namespace Hz
+{
+
+    // Shares VkRenderPasses & VkFramebuffers between Renderpass objects.
+    // Render passes are keyed by their full description (formats, samples, ops, layouts, subpasses & dependencies),
+    // so renderpasses with the same description (and their pipelines) use the same VkRenderPass. Framebuffers are keyed by
+    // render pass, image views and extent and are reference counted, they get evicted as soon as one of their views is destroyed.
+    class VulkanRenderpassCache
+    {
+    public:
+        static void Destroy();
+
+        // Render passes live until the renderer is destroyed
+        static VkRenderPass GetRenderPass(const VkRenderPassCreateInfo& createInfo);
+
+        // Note: Framebuffers are released by their ID, since the driver may hand out the handle of an evicted framebuffer again
+        static VkFramebuffer AcquireFramebuffer(VkRenderPass renderPass, const std::vector<VkImageView>& views, uint32_t width, uint32_t height, uint64_t& id);
+        static void ReleaseFramebuffer(uint64_t id); // Note: The framebuffer must no longer be in use by the GPU, releasing an evicted framebuffer does nothing
+
+        // Destroys every framebuffer using the view, Note: Gets called right before the view is destroyed, while the GPU is idle.
+        // Owners notice through GetEvictions() & IsEvicted() and acquire new framebuffers before their next use.
+        static void Evict(VkImageView view);
+
+        static bool IsEvicted(uint64_t id);
+        inline static uint64_t GetEvictions() { return s_Evictions.load(std::memory_order_acquire); } // Increases every time framebuffers got evicted
+
+        static size_t GetRenderPassCount();
+        static size_t GetFramebufferCount();
+
+    private:
+        static std::vector<uint32_t> GetRenderPassKey(const VkRenderPassCreateInfo& createInfo);
+
+        struct FramebufferKey
+        {
+        public:
+            VkRenderPass RenderPass = VK_NULL_HANDLE;
+            std::vector<VkImageView> Views = { };
+            uint32_t Width = 0;
+            uint32_t Height = 0;
+
+            bool operator == (const FramebufferKey& other) const = default;
+        };
+
+        struct FramebufferEntry
+        {
+        public:
+            VkFramebuffer Framebuffer = VK_NULL_HANDLE;
+            uint64_t ID = 0;
+            uint32_t References = 0;
+        };
+
+        struct Hash
+        {
+        public:
+            size_t operator () (const std::vector<uint32_t>& key) const;
+            size_t operator () (const FramebufferKey& key) const;
+        };
+
+        // Note: We store our info in a struct, so we can ensure lifetime
+        // of all objects easily while the class remains static.
+        struct Info
+        {
+        public:
+            std::unordered_map<std::vector<uint32_t>, VkRenderPass, Hash> RenderPasses = { };
+            std::unordered_map<FramebufferKey, FramebufferEntry, Hash> Framebuffers = { };
+            std::unordered_map<uint64_t, FramebufferKey> IDs = { }; // Of live framebuffers only
+
+            uint64_t NextID = 1;
+        };
+
+        inline static std::mutex s_Mutex = {};
+        inline static Info s_Data = {};
+        inline static std::atomic<uint64_t> s_Evictions = 0;
+    };
+
+}
@@ -0,0 +1,112 @@
+#include "hzpch.h"
+#include "VulkanSampler.hpp"
+
+#include "Horizon/Core/Logging.hpp"
+
+#include "Horizon/Vulkan/VulkanUtils.hpp"
+#include "Horizon/Vulkan/VulkanContext.hpp"
+
+#include <functional>
+
+namespace Hz
+{
+
+    ///////////////////////////////////////////////////////////
+    // Sampler
+    ///////////////////////////////////////////////////////////
+    VulkanSampler::VulkanSampler(const SamplerSpecification& specs)
+        : m_Specification(specs), m_Sampler(VulkanSamplerCache::Get(specs))
+    {
+    }
+
+    ///////////////////////////////////////////////////////////
+    // Cache
+    ///////////////////////////////////////////////////////////
+    void VulkanSamplerCache::Destroy()
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+        auto device = VulkanContext::GetDevice()->GetVkDevice();
+
+        for (auto& [specs, sampler] : s_Data.Samplers)
+            vkDestroySampler(device, sampler, nullptr);
+
+        s_Data = {};
+    }
+
+    VkSampler VulkanSamplerCache::Get(const SamplerSpecification& specs)
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+
+        if (auto it = s_Data.Samplers.find(specs); it != s_Data.Samplers.end())
+            return it->second;
+
+        VkSampler sampler = CreateSampler(specs);
+        s_Data.Samplers[specs] = sampler;
+        return sampler;
+    }
+
+    size_t VulkanSamplerCache::GetCount()
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+        return s_Data.Samplers.size();
+    }
+
+    VkSampler VulkanSamplerCache::CreateSampler(const SamplerSpecification& specs)
+    {
+        if (s_Data.MaxAnisotropy == 0.0f)
+        {
+            VkPhysicalDeviceProperties properties = {};
+            vkGetPhysicalDeviceProperties(VulkanContext::GetPhysicalDevice()->GetVkPhysicalDevice(), &properties);
+
+            s_Data.MaxAnisotropy = properties.limits.maxSamplerAnisotropy;
+        }
+
+        float anisotropy = std::clamp(specs.MaxAnisotropy, 1.0f, s_Data.MaxAnisotropy);
+
+        VkSamplerCreateInfo samplerInfo = {};
+        samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        samplerInfo.magFilter = (VkFilter)specs.MagFilter;
+        samplerInfo.minFilter = (VkFilter)specs.MinFilter;
+        samplerInfo.addressModeU = (VkSamplerAddressMode)specs.Address;
+        samplerInfo.addressModeV = (VkSamplerAddressMode)specs.Address;
+        samplerInfo.addressModeW = (VkSamplerAddressMode)specs.Address;
+
+        samplerInfo.anisotropyEnable = (anisotropy > 1.0f ? VK_TRUE : VK_FALSE);
+        samplerInfo.maxAnisotropy = anisotropy;
+
+        samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+        samplerInfo.unnormalizedCoordinates = VK_FALSE;
+        samplerInfo.compareEnable = (specs.CompareEnable ? VK_TRUE : VK_FALSE);
+        samplerInfo.compareOp = (VkCompareOp)specs.Compare;
+
+        samplerInfo.mipmapMode = (VkSamplerMipmapMode)specs.Mipmaps;
+        samplerInfo.minLod = specs.MinLod;
+        samplerInfo.maxLod = specs.MaxLod;
+        samplerInfo.mipLodBias = specs.LodBias;
+
+        VkSampler sampler = VK_NULL_HANDLE;
+        VK_CHECK_RESULT(vkCreateSampler(VulkanContext::GetDevice()->GetVkDevice(), &samplerInfo, nullptr, &sampler));
+
+        return sampler;
+    }
+
+    size_t VulkanSamplerCache::Hash::operator () (const SamplerSpecification& specs) const
+    {
+        size_t hash = 0;
+        auto combine = [&hash](size_t value) { hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2); };
+
+        combine(std::hash<uint32_t>()((uint32_t)specs.MagFilter));
+        combine(std::hash<uint32_t>()((uint32_t)specs.MinFilter));
+        combine(std::hash<uint32_t>()((uint32_t)specs.Address));
+        combine(std::hash<uint32_t>()((uint32_t)specs.Mipmaps));
+        combine(std::hash<float>()(specs.MaxAnisotropy));
+        combine(std::hash<float>()(specs.LodBias));
+        combine(std::hash<float>()(specs.MinLod));
+        combine(std::hash<float>()(specs.MaxLod));
+        combine(std::hash<bool>()(specs.CompareEnable));
+        combine(std::hash<uint32_t>()((uint32_t)specs.Compare));
+
+        return hash;
+    }
+
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Horizon/Core/Core.hpp"
+
+#include "Horizon/Renderer/Image.hpp"
+
+#include <mutex>
+#include <unordered_map>
+
+#include <vulkan/vulkan.h>
+
+namespace Hz
+{
+
+    class VulkanSampler : public Sampler
+    {
+    public:
+        VulkanSampler(const SamplerSpecification& specs);
+        ~VulkanSampler() = default; // Note: The VkSampler is owned by the cache
+
+        inline const SamplerSpecification& GetSpecification() const override { return m_Specification; }
+
+        inline const VkSampler GetVkSampler() const { return m_Sampler; }
+
+    private:
+        SamplerSpecification m_Specification;
+        VkSampler m_Sampler = VK_NULL_HANDLE;
+    };
+
+    // Deduplicates samplers, every unique specification gets a single VkSampler which lives until the renderer is destroyed.
+    class VulkanSamplerCache
+    {
+    public:
+        static void Destroy();
+
+        static VkSampler Get(const SamplerSpecification& specs);
+
+        static size_t GetCount();
+
+    private:
+        static VkSampler CreateSampler(const SamplerSpecification& specs);
+
+        struct Hash
+        {
+        public:
+            size_t operator () (const SamplerSpecification& specs) const;
+        };
+
+        // Note: We store our info in a struct, so we can ensure lifetime
+        // of all objects easily while the class remains static.
+        struct Info
+        {
+        public:
+            std::unordered_map<SamplerSpecification, VkSampler, Hash> Samplers = { };
+
+            float MaxAnisotropy = 0.0f; // Device limit, queried on first use
+        };
+
+        inline static std::mutex s_Mutex = {};
+        inline static Info s_Data = {};
+    };
+
+}
@@ -0,0 +1,603 @@
+#include "hzpch.h"
+#include "VulkanStreamedImage.hpp"
+
+#include "Horizon/Core/Logging.hpp"
+
+#include "Horizon/Renderer/ImageDecoder.hpp"
+#include "Horizon/Renderer/ImageEncoder.hpp"
+
+#include "Horizon/Vulkan/VulkanUtils.hpp"
+#include "Horizon/Vulkan/VulkanContext.hpp"
+#include "Horizon/Vulkan/VulkanGpuProfiler.hpp"
+#include "Horizon/Vulkan/VulkanDefragmenter.hpp"
+
+#include "Horizon/Utils/Profiler.hpp"
+
+#include <stb_image.h>
+
+namespace Hz
+{
+
+    ///////////////////////////////////////////////////////////
+    // Streamed image
+    ///////////////////////////////////////////////////////////
+    VulkanStreamedImage::VulkanStreamedImage(const StreamedImageSpecification& specs, const SamplerSpecification& samplerSpecs)
+        : m_Specification(specs)
+    {
+        // Note: Only the header is read here, the file gets decoded on the job system
+        bool found = ImageDecoder::Info(m_Specification.Path, m_Width, m_Height);
+        HZ_ASSERT(found, "Failed to load image from '{0}'", m_Specification.Path.string());
+
+        m_MipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(m_Width, m_Height)))) + 1;
+
+        while (m_TailMip + 1 < m_MipLevels && std::max(m_Width >> m_TailMip, m_Height >> m_TailMip) > m_Specification.TailSize)
+            m_TailMip++;
+
+        // A 1x1 magenta placeholder is used until the tail has been uploaded
+        // Note: TransferSrc, since the levels that stay resident are copied into the next image
+        ImageSpecification imageSpecs = ImageSpecification(1, 1, m_Specification.Flags | ImageUsageFlags::TransferSrc | ImageUsageFlags::TransferDst);
+        imageSpecs.Layout = m_Specification.Layout;
+        imageSpecs.Format = ImageFormat::RGBA;
+        imageSpecs.MipMaps = true;
+
+        m_Image = Ref<VulkanImage>::Create(imageSpecs, samplerSpecs);
+
+        uint32_t pixel = 0xFFFF00FF;
+        m_Image->SetData((void*)&pixel, sizeof(uint32_t));
+
+        m_ResidentMip = m_MipLevels;
+        m_RequestedMip.store(m_TailMip, std::memory_order_relaxed);
+        m_Request.Mip = m_TailMip;
+
+        StartDecode(m_TailMip, m_MipLevels);
+        VulkanTextureStreamer::Register(this);
+    }
+
+    VulkanStreamedImage::~VulkanStreamedImage()
+    {
+        // Note: An upload in flight gets cleaned up by the streamer
+        VulkanTextureStreamer::Unregister(this);
+
+        // Note: The decode job writes into us
+        m_Decode.Wait();
+    }
+
+    void VulkanStreamedImage::RequestMip(uint32_t mip)
+    {
+        m_RequestedMip.store(std::min(mip, m_TailMip), std::memory_order_relaxed);
+        m_LastRequest.store(VulkanTextureStreamer::s_Data.Frame.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    void VulkanStreamedImage::RequestCoverage(uint32_t pixels)
+    {
+        uint32_t largest = std::max(m_Width, m_Height);
+
+        uint32_t mip = 0;
+        while (mip < m_TailMip && (largest >> (mip + 1)) >= std::max(pixels, 1u))
+            mip++;
+
+        RequestMip(mip);
+    }
+
+    ImageFileData VulkanStreamedImage::Decode(const std::filesystem::path& path, uint32_t first, uint32_t end)
+    {
+        HZ_PROFILE_SCOPE("VulkanStreamedImage::Decode");
+
+        int width, height, texChannels;
+        stbi_uc* pixels = stbi_load(path.string().c_str(), &width, &height, &texChannels, STBI_rgb_alpha);
+        if (!pixels)
+            return {};
+
+        ImageFileData data = {};
+        data.Format = ImageFormat::RGBA;
+        data.Width = (uint32_t)width;
+        data.Height = (uint32_t)height;
+
+        size_t total = 0;
+        for (uint32_t i = first; i < end; i++)
+            total += (size_t)std::max(data.Width >> i, 1u) * std::max(data.Height >> i, 1u) * 4;
+        data.Data.reserve(total);
+
+        // Note: Every mip is downsampled from the previous one, the levels before first are dropped once the next one exists
+        const uint8_t* source = pixels;
+        std::vector<uint8_t> mip = { };
+
+        uint32_t levelWidth = data.Width;
+        uint32_t levelHeight = data.Height;
+        for (uint32_t i = 0; i < end; i++)
+        {
+            if (i > 0)
+            {
+                std::vector<uint8_t> next = ImageEncoder::Downsample(source, levelWidth, levelHeight, 1);
+                mip.swap(next);
+                source = mip.data();
+            }
+
+            if (i < first)
+                continue;
+
+            size_t size = (size_t)levelWidth * levelHeight * 4;
+            data.Levels.push_back({ data.Data.size(), size, levelWidth, levelHeight });
+            data.Data.insert(data.Data.end(), source, source + size);
+        }
+
+        stbi_image_free((void*)pixels);
+        return data;
+    }
+
+    void VulkanStreamedImage::StartDecode(uint32_t first, uint32_t end)
+    {
+        m_State = State::Decoding;
+        m_PendingMip = first;
+        m_DecodeEnd = end;
+
+        m_Decode = Jobs::Submit([this, path = m_Specification.Path, first, end]() { m_Staged = Decode(path, first, end); }, "VulkanStreamedImage::Decode");
+    }
+
+    bool VulkanStreamedImage::FinishDecode()
+    {
+        m_Decode = {};
+
+        // Note: Failed images keep what they have resident
+        if (m_Staged.Width != m_Width || m_Staged.Height != m_Height || m_Staged.Levels.size() != (size_t)(m_DecodeEnd - m_PendingMip))
+        {
+            HZ_LOG_ERROR("Failed to load image from '{0}'", m_Specification.Path.string());
+
+            m_Staged = {};
+            m_State = State::Idle;
+            m_Failed = true;
+            return false;
+        }
+
+        m_State = State::Decoded;
+        return true;
+    }
+
+    size_t VulkanStreamedImage::GetResidentSize(uint32_t mip) const
+    {
+        size_t size = 0;
+        for (uint32_t i = mip; i < m_MipLevels; i++)
+            size += (size_t)std::max(m_Width >> i, 1u) * std::max(m_Height >> i, 1u) * 4;
+
+        return size;
+    }
+
+    ///////////////////////////////////////////////////////////
+    // Streamer
+    ///////////////////////////////////////////////////////////
+    void VulkanTextureStreamer::Update()
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+        s_Data.Frame++;
+
+        // Destroy replaced handles no frame in flight uses anymore
+        std::erase_if(s_Data.Retired, [](std::pair<uint64_t, FreeFunction>& retired)
+        {
+            if (retired.first > s_Data.Frame)
+                return false;
+
+            retired.second();
+            return true;
+        });
+
+        if (s_Data.Images.empty() && s_Data.Uploads.empty())
+            return;
+
+        HZ_PROFILE_SCOPE("VulkanTextureStreamer::Update");
+
+        // Finished decodes & the requests made since the last update
+        for (auto image : s_Data.Images)
+        {
+            if (image->m_State == VulkanStreamedImage::State::Decoding && image->m_Decode.Done())
+            {
+                uint64_t reserved = image->GetResidentSize(image->m_PendingMip) - image->GetResidentSize(image->m_ResidentMip);
+                if (!image->FinishDecode())
+                    s_Data.ResidentBytes -= reserved;
+            }
+
+            image->m_Request = { image->m_RequestedMip.load(std::memory_order_relaxed), image->m_LastRequest.load(std::memory_order_relaxed) };
+        }
+
+        // Finished uploads, Note: We only poll the fences, the frame never waits on an upload
+        auto device = VulkanContext::GetDevice()->GetVkDevice();
+        std::erase_if(s_Data.Uploads, [device](Upload& upload)
+        {
+            if (vkGetFenceStatus(device, upload.Fence) != VK_SUCCESS)
+                return false;
+
+            FinishUpload(upload);
+            return true;
+        });
+
+        // Evict when over budget
+        uint64_t budget = GetEffectiveBudget();
+        if (s_Data.ResidentBytes > budget)
+            MakeRoom(s_Data.ResidentBytes - budget, nullptr);
+
+        // Upload decoded levels, Note: Their memory has been accounted for when the decode started
+        uint32_t uploads = 0;
+        for (auto image : s_Data.Images)
+        {
+            if (uploads >= MaxUploadsPerFrame || s_Data.Uploads.size() >= MaxUploadsInFlight)
+                break;
+
+            if (image->m_State != VulkanStreamedImage::State::Decoded)
+                continue;
+
+            StartUpload(image, image->m_PendingMip);
+            uploads++;
+        }
+
+        // Decode requested mips, most recently requested first
+        // Note: Only once the tail is resident, the tail is the first decode and ignores the budget
+        std::vector<VulkanStreamedImage*> candidates = { };
+        uint32_t decodes = 0;
+        for (auto image : s_Data.Images)
+        {
+            if (image->m_State == VulkanStreamedImage::State::Decoding)
+                decodes++;
+            else if (image->m_State == VulkanStreamedImage::State::Idle && !image->m_Failed && image->m_ResidentMip < image->m_MipLevels && image->m_Request.Mip < image->m_ResidentMip)
+                candidates.push_back(image);
+        }
+
+        std::sort(candidates.begin(), candidates.end(), [](VulkanStreamedImage* a, VulkanStreamedImage* b) { return a->m_Request.Frame > b->m_Request.Frame; });
+
+        for (auto image : candidates)
+        {
+            if (decodes >= MaxDecodesInFlight)
+                break;
+
+            uint32_t mip = image->m_Request.Mip;
+            uint64_t needed = image->GetResidentSize(mip) - image->GetResidentSize(image->m_ResidentMip);
+            if (s_Data.ResidentBytes + needed > budget && !MakeRoom(s_Data.ResidentBytes + needed - budget, image))
+                continue;
+
+            // Note: Only the levels that aren't resident yet are decoded
+            image->StartDecode(mip, image->m_ResidentMip);
+            s_Data.ResidentBytes += needed;
+            decodes++;
+        }
+
+        HZ_PROFILE_PLOT("Streamed Texture Memory", (int64_t)s_Data.ResidentBytes);
+    }
+
+    void VulkanTextureStreamer::Destroy()
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+        if (s_Data.CommandPool == VK_NULL_HANDLE)
+            return;
+
+        VulkanContext::GetDevice()->Wait();
+
+        // Note: Images which are still alive keep their current handles
+        for (auto& upload : s_Data.Uploads)
+        {
+            if (upload.Image)
+                upload.Image->m_State = VulkanStreamedImage::State::Idle;
+
+            Release(upload, false);
+        }
+        s_Data.Uploads.clear();
+
+        for (auto& [frame, func] : s_Data.Retired)
+            func();
+        s_Data.Retired.clear();
+
+        vkDestroyCommandPool(VulkanContext::GetDevice()->GetVkDevice(), s_Data.CommandPool, nullptr);
+        s_Data.CommandPool = VK_NULL_HANDLE;
+    }
+
+    void VulkanTextureStreamer::SetBudget(uint64_t bytes)
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+        s_Data.Budget = bytes;
+    }
+
+    void VulkanTextureStreamer::Register(VulkanStreamedImage* image)
+    {
+        // Note: Under memory pressure we shrink our budget to what we currently use, so we back off before running out of memory.
+        // The callback is added outside of s_Mutex and only stores the pressure, see the lock order.
+        std::call_once(s_Data.CallbackAdded, []()
+        {
+            Renderer::AddMemoryBudgetCallback([](uint32_t heap, MemoryPressure pressure, const MemoryStatistics& stats)
+            {
+                if (stats.Heaps[heap].DeviceLocal)
+                    s_Data.Pressure.store(pressure, std::memory_order_relaxed);
+            });
+        });
+
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+
+        s_Data.Images.push_back(image);
+        s_Data.ResidentBytes += image->GetResidentSize(image->GetTargetMip());
+    }
+
+    void VulkanTextureStreamer::Unregister(VulkanStreamedImage* image)
+    {
+        std::scoped_lock<std::mutex> lock(s_Mutex);
+
+        if (std::erase(s_Data.Images, image) > 0)
+            s_Data.ResidentBytes -= image->GetResidentSize(image->GetTargetMip());
+
+        for (auto& upload : s_Data.Uploads)
+        {
+            if (upload.Image == image)
+                upload.Image = nullptr;
+        }
+    }
+
+    void VulkanTextureStreamer::StartUpload(VulkanStreamedImage* image, uint32_t mip)
+    {
+        HZ_PROFILE_SCOPE("VulkanTextureStreamer::StartUpload");
+
+        auto device = VulkanContext::GetDevice()->GetVkDevice();
+
+        // Note: The pool is created on first use, so the streamer doesn't need to be initialized
+        if (s_Data.CommandPool == VK_NULL_HANDLE)
+        {
+            QueueFamilyIndices queueFamilyIndices = QueueFamilyIndices::Find(VulkanContext::GetSwapChain()->GetVkSurface(), VulkanContext::GetPhysicalDevice()->GetVkPhysicalDevice());
+
+            VkCommandPoolCreateInfo poolInfo = {};
+            poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+            poolInfo.queueFamilyIndex = queueFamilyIndices.GraphicsFamily.value();
+
+            VK_CHECK_RESULT(vkCreateCommandPool(device, &poolInfo, nullptr, &s_Data.CommandPool));
+        }
+
+        Upload upload = {};
+        upload.Image = image;
+        upload.Mip = mip;
+
+        const ImageFileData& staged = image->m_Staged;
+        const uint32_t levels = image->m_MipLevels - mip;
+        const uint32_t resident = image->m_ResidentMip;
+        const uint32_t copyFirst = std::max(mip, resident); // Note: Levels from here on are copied from the current image
+
+        // The new image, Note: The view only covers the resident mips, so the shared sampler can stay
+        VkImageCreateInfo createInfo = image->m_Image->GetVkImageCreateInfo();
+        createInfo.extent = { std::max(image->m_Width >> mip, 1u), std::max(image->m_Height >> mip, 1u), 1 };
+        createInfo.mipLevels = levels;
+
+        upload.Allocation = VkUtils::Allocator::AllocateImage(createInfo, VMA_MEMORY_USAGE_GPU_ONLY, upload.NewImage);
+        upload.ImageView = VkUtils::Allocator::CreateImageView(upload.NewImage, createInfo.format, VK_IMAGE_ASPECT_COLOR_BIT, levels);
+
+        // The decoded levels are stored back to back, so they're copied at once
+        // Note: The decoded pixels are freed right after, nothing stays in memory while uploading
+        if (copyFirst > mip)
+        {
+            upload.StagingAllocation = VkUtils::Allocator::AllocateBuffer(staged.Data.size(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY, upload.StagingBuffer);
+
+            void* mappedData;
+            VkUtils::Allocator::MapMemory(upload.StagingAllocation, mappedData);
+            memcpy(mappedData, staged.Data.data(), staged.Data.size());
+            VkUtils::Allocator::UnMapMemory(upload.StagingAllocation);
+        }
+
+        // Recording
+        VkCommandBufferAllocateInfo allocInfo = {};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = s_Data.CommandPool;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandBufferCount = 1;
+
+        VK_CHECK_RESULT(vkAllocateCommandBuffers(device, &allocInfo, &upload.CommandBuffer));
+
+        VkFenceCreateInfo fenceInfo = {};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+        VK_CHECK_RESULT(vkCreateFence(device, &fenceInfo, nullptr, &upload.Fence));
+
+        VkCommandBufferBeginInfo beginInfo = {};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        VK_CHECK_RESULT(vkBeginCommandBuffer(upload.CommandBuffer, &beginInfo));
+
+        VkImageMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.image = upload.NewImage;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, levels, 0, 1 };
+        barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+        vkCmdPipelineBarrier(upload.CommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+        VulkanGpuProfiler::CountBarrier();
+
+        if (copyFirst > mip)
+        {
+            std::vector<VkBufferImageCopy> regions((size_t)(copyFirst - mip));
+            for (uint32_t i = 0; i < copyFirst - mip; i++)
+            {
+                const ImageFileLevel& level = staged.Levels[i];
+
+                VkBufferImageCopy& region = regions[i];
+                region.bufferOffset = level.Offset;
+                region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, i, 0, 1 };
+                region.imageExtent = { level.Width, level.Height, 1 };
+            }
+
+            vkCmdCopyBufferToImage(upload.CommandBuffer, upload.StagingBuffer, upload.NewImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, (uint32_t)regions.size(), regions.data());
+        }
+
+        // The levels that stay resident are copied on the GPU
+        if (copyFirst < image->m_MipLevels)
+        {
+            const uint32_t copies = image->m_MipLevels - copyFirst;
+
+            VkImageMemoryBarrier sourceBarrier = barrier;
+            sourceBarrier.image = image->m_Image->m_Image;
+            sourceBarrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, image->m_MipLevels - resident, 0, 1 };
+            sourceBarrier.oldLayout = (VkImageLayout)image->m_Specification.Layout;
+            sourceBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            sourceBarrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            sourceBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+            vkCmdPipelineBarrier(upload.CommandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &sourceBarrier);
+            VulkanGpuProfiler::CountBarrier();
+
+            std::vector<VkImageCopy> regions((size_t)copies);
+            for (uint32_t i = 0; i < copies; i++)
+            {
+                const uint32_t level = copyFirst + i;
+
+                VkImageCopy& region = regions[i];
+                region.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level - resident, 0, 1 };
+                region.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level - mip, 0, 1 };
+                region.extent = { std::max(image->m_Width >> level, 1u), std::max(image->m_Height >> level, 1u), 1 };
+            }
+
+            vkCmdCopyImage(upload.CommandBuffer, sourceBarrier.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, upload.NewImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, (uint32_t)regions.size(), regions.data());
+
+            // Note: The current image stays in use until the new one replaces it
+            sourceBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            sourceBarrier.newLayout = (VkImageLayout)image->m_Specification.Layout;
+            sourceBarrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+            sourceBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+            vkCmdPipelineBarrier(upload.CommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &sourceBarrier);
+            VulkanGpuProfiler::CountBarrier();
+        }
+
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = (VkImageLayout)image->m_Specification.Layout;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        vkCmdPipelineBarrier(upload.CommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+        VulkanGpuProfiler::CountBarrier();
+
+        VK_CHECK_RESULT(vkEndCommandBuffer(upload.CommandBuffer));
+
+        VkSubmitInfo submitInfo = {};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &upload.CommandBuffer;
+
+        {
+            auto queueLock = RenderThread::Lock(); // Note: The graphics queue is shared with the main thread
+            VK_CHECK_RESULT(vkQueueSubmit(VulkanContext::GetDevice()->GetGraphicsQueue(), 1, &submitInfo, upload.Fence));
+        }
+
+        image->m_Staged = {};
+        image->m_State = VulkanStreamedImage::State::Uploading;
+        image->m_PendingMip = mip;
+        s_Data.Uploads.push_back(upload);
+    }
+
+    void VulkanTextureStreamer::FinishUpload(Upload& upload)
+    {
+        // Note: The image was destroyed while uploading
+        if (!upload.Image)
+        {
+            Release(upload, false);
+            return;
+        }
+
+        VulkanStreamedImage* streamed = upload.Image;
+        Ref<VulkanImage> image = streamed->m_Image;
+
+        {
+            // Note: Descriptor sets being uploaded on another thread either see the old handles & get patched below, or the new ones
+            std::scoped_lock<std::mutex> lock(VulkanImage::s_HandleMutex);
+
+            // The old handles stay alive until every frame in flight has had its descriptor sets patched
+            FreeFunction old = [imageView = image->m_ImageView, views = image->TakeSubresourceViews(), vkImage = image->m_Image, allocation = image->m_Allocation]()
+            {
+                vkDestroyImageView(VulkanContext::GetDevice()->GetVkDevice(), imageView, nullptr);
+                for (auto& view : views)
+                    vkDestroyImageView(VulkanContext::GetDevice()->GetVkDevice(), view, nullptr);
+                VkUtils::Allocator::DestroyImage(vkImage, allocation);
+            };
+            s_Data.Retired.emplace_back(s_Data.Frame + (uint64_t)Renderer::GetSpecification().Buffers, std::move(old));
+
+            image->m_Image = upload.NewImage;
+            image->m_Allocation = upload.Allocation;
+            image->m_ImageView = upload.ImageView;
+            image->m_Specification.Width = std::max(streamed->m_Width >> upload.Mip, 1u);
+            image->m_Specification.Height = std::max(streamed->m_Height >> upload.Mip, 1u);
+            image->m_Miplevels = streamed->m_MipLevels - upload.Mip;
+        }
+
+        streamed->m_ResidentMip = upload.Mip;
+        streamed->m_State = VulkanStreamedImage::State::Idle;
+
+        Release(upload, true);
+
+        VulkanDefragmenter::RefreshDeferred(image.Raw());
+    }
+
+    void VulkanTextureStreamer::Release(Upload& upload, bool keepImage)
+    {
+        auto device = VulkanContext::GetDevice()->GetVkDevice();
+
+        if (!keepImage)
+        {
+            vkDestroyImageView(device, upload.ImageView, nullptr);
+            VkUtils::Allocator::DestroyImage(upload.NewImage, upload.Allocation);
+        }
+
+        // Note: Evictions don't stage anything
+        if (upload.StagingBuffer != VK_NULL_HANDLE)
+            VkUtils::Allocator::DestroyBuffer(upload.StagingBuffer, upload.StagingAllocation);
+
+        vkFreeCommandBuffers(device, s_Data.CommandPool, 1, &upload.CommandBuffer);
+        vkDestroyFence(device, upload.Fence, nullptr);
+
+        upload = {};
+    }
+
+    uint64_t VulkanTextureStreamer::GetEffectiveBudget()
+    {
+        switch (s_Data.Pressure.load(std::memory_order_relaxed))
+        {
+        case MemoryPressure::High:
+            return std::min(s_Data.Budget, s_Data.ResidentBytes / 4 * 3);
+        case MemoryPressure::Exceeded:
+            return std::min(s_Data.Budget, s_Data.ResidentBytes / 2);
+
+        default:
+            break;
+        }
+
+        return s_Data.Budget;
+    }
+
+    bool VulkanTextureStreamer::MakeRoom(uint64_t bytes, VulkanStreamedImage* requester)
+    {
+        // Least recently requested first
+        std::vector<VulkanStreamedImage*> candidates = { };
+        for (auto image : s_Data.Images)
+        {
+            if (image != requester && image->m_State == VulkanStreamedImage::State::Idle && image->m_ResidentMip < image->m_TailMip)
+                candidates.push_back(image);
+        }
+
+        std::sort(candidates.begin(), candidates.end(), [](VulkanStreamedImage* a, VulkanStreamedImage* b) { return a->m_Request.Frame < b->m_Request.Frame; });
+
+        uint64_t freed = 0;
+        for (auto image : candidates)
+        {
+            if (freed >= bytes)
+                break;
+
+            // Note: Images requested this frame only give up what they don't need
+            uint32_t target = (image->m_Request.Frame == s_Data.Frame.load(std::memory_order_relaxed) ? image->m_Request.Mip : image->m_TailMip);
+            if (target <= image->m_ResidentMip)
+                continue;
+
+            // Note: Evicting copies the kept mips into a smaller image on the GPU, the memory is
+            // returned once that finished, but it's accounted for right away so we don't evict more.
+            StartUpload(image, target);
+            freed += image->GetResidentSize(image->m_ResidentMip) - image->GetResidentSize(target);
+        }
+
+        s_Data.ResidentBytes -= freed;
+        return freed >= bytes;
+    }
+
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "Horizon/Core/Core.hpp"
+#include "Horizon/Core/Jobs.hpp"
+
+#include "Horizon/Renderer/Renderer.hpp"
+#include "Horizon/Renderer/ImageFile.hpp"
+#include "Horizon/Renderer/StreamedImage.hpp"
+
+#include "Horizon/Vulkan/VulkanImage.hpp"
+
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <limits>
+#include <utility>
+
+#include <vulkan/vulkan.h>
+#include <vma/vk_mem_alloc.h>
+
+namespace Hz
+{
+
+    class VulkanTextureStreamer;
+
+    class VulkanStreamedImage : public StreamedImage
+    {
+    public:
+        VulkanStreamedImage(const StreamedImageSpecification& specs, const SamplerSpecification& samplerSpecs);
+        ~VulkanStreamedImage();
+
+        void RequestMip(uint32_t mip) override;
+        void RequestCoverage(uint32_t pixels) override;
+
+        inline uint32_t GetResidentMip() const override { return m_ResidentMip; }
+        inline uint32_t GetMipLevels() const override { return m_MipLevels; }
+
+        inline uint32_t GetWidth() const override { return m_Width; }
+        inline uint32_t GetHeight() const override { return m_Height; }
+
+        inline Ref<Image> GetImage() const override { return m_Image; }
+
+    private:
+        enum class State : uint8_t
+        {
+            Idle = 0,   // Nothing in flight
+            Decoding,   // Decoding [m_PendingMip, m_DecodeEnd) on a job
+            Decoded,    // The decoded levels wait in m_Staged for an upload slot
+            Uploading,  // An upload to m_PendingMip is in flight
+        };
+
+        // Decodes the file & downsamples it, only the levels in [first, end) are returned
+        static ImageFileData Decode(const std::filesystem::path& path, uint32_t first, uint32_t end);
+        void StartDecode(uint32_t first, uint32_t end);
+        bool FinishDecode(); // Returns false when the file couldn't be decoded
+
+        size_t GetResidentSize(uint32_t mip) const; // Size in bytes when mip is the most detailed resident mip
+        inline uint32_t GetTargetMip() const { return (m_State == State::Idle ? m_ResidentMip : m_PendingMip); } // The resident mip once the work in flight has finished
+
+    private:
+        StreamedImageSpecification m_Specification;
+
+        Ref<VulkanImage> m_Image = nullptr;
+
+        uint32_t m_Width = 0;
+        uint32_t m_Height = 0;
+        uint32_t m_MipLevels = 1;
+
+        uint32_t m_TailMip = 0;         // Least detailed mip that is always resident (once decoded)
+        uint32_t m_ResidentMip = 0;     // m_MipLevels while only the placeholder is resident
+
+        // Note: Requests come from any thread, the streamer takes a snapshot every Update() so it sorts on stable values
+        std::atomic<uint32_t> m_RequestedMip = 0;
+        std::atomic<uint64_t> m_LastRequest = 0; // Streamer frame of the last request
+
+        struct Request
+        {
+        public:
+            uint32_t Mip = 0;
+            uint64_t Frame = 0;
+        };
+        Request m_Request = {}; // Snapshot of the above, Note: Only touched under the streamer's mutex
+
+        // Note: Decoded levels only live in memory until they've been copied into a staging buffer. Paging in decodes
+        // the file again, the levels which are already resident (and evicting) are copied from the current image on the GPU.
+        State m_State = State::Idle;
+        uint32_t m_PendingMip = 0;
+        uint32_t m_DecodeEnd = 0;
+        bool m_Failed = false; // Set when the file couldn't be decoded, the image isn't streamed anymore
+
+        JobHandle m_Decode = {};
+        ImageFileData m_Staged = {}; // Note: Written by the decode job, only read once it's done
+
+        friend class VulkanTextureStreamer;
+    };
+
+    class VulkanTextureStreamer
+    {
+    public:
+        static void Update(); // Note: Gets called by the renderer every frame after waiting on the current frame's fences
+        static void Destroy(); // Waits for the uploads in flight & destroys the replaced handles
+
+        static void SetBudget(uint64_t bytes);
+
+        static void Register(VulkanStreamedImage* image);
+        static void Unregister(VulkanStreamedImage* image);
+
+    private:
+        // Note: A new image holding the target mips, which replaces the image's handles once its fence is signaled
+        struct Upload
+        {
+        public:
+            VulkanStreamedImage* Image = nullptr; // Set to nullptr when the image is destroyed while uploading
+            uint32_t Mip = 0;
+
+            VkImage NewImage = VK_NULL_HANDLE;
+            VmaAllocation Allocation = VK_NULL_HANDLE;
+            VkImageView ImageView = VK_NULL_HANDLE;
+
+            VkBuffer StagingBuffer = VK_NULL_HANDLE;
+            VmaAllocation StagingAllocation = VK_NULL_HANDLE;
+
+            VkCommandBuffer CommandBuffer = VK_NULL_HANDLE;
+            VkFence Fence = VK_NULL_HANDLE;
+        };
+
+        // Uploads the staged levels & copies the levels that stay resident from the current image
+        static void StartUpload(VulkanStreamedImage* image, uint32_t mip);
+        static void FinishUpload(Upload& upload);
+        static void Release(Upload& upload, bool keepImage); // Destroys the staging & submission objects and, unless kept, the new image
+
+        static uint64_t GetEffectiveBudget();
+        static bool MakeRoom(uint64_t bytes, VulkanStreamedImage* requester);
+
+    private:
+        // Note: We store our info in a struct, so we can ensure lifetime
+        // of all objects easily while the class remains static.
+        struct Info
+        {
+        public:
+            uint64_t Budget = std::numeric_limits<uint64_t>::max();
+            uint64_t ResidentBytes = 0; // Of every image's target mip, so uploads in flight are accounted for
+            std::atomic<uint64_t> Frame = 0; // Note: Read by RequestMip() without the mutex
+
+            std::atomic<MemoryPressure> Pressure = MemoryPressure::Normal; // Highest pressure of a device local heap
+            std::once_flag CallbackAdded = {};
+
+            VkCommandPool CommandPool = VK_NULL_HANDLE; // Note: Only used by Update(), so it doesn't need to be shared with the render thread
+            std::vector<Upload> Uploads = { };
+            std::vector<std::pair<uint64_t, FreeFunction>> Retired = { }; // Replaced handles & the frame from which on no frame in flight uses them
+
+            std::vector<VulkanStreamedImage*> Images = { };
+        };
+
+        // Note: Streamed images can be created before and destroyed after the renderer,
+        // so the streamer uses static storage like the defragmenter.
+        // Lock order: s_Mutex may be held while calling into the allocator & defragmenter, never the other way around.
+        // The budget callback only touches the atomic pressure, so it doesn't take s_Mutex.
+        inline static std::mutex s_Mutex = {};
+        inline static Info s_Data = {};
+
+        friend class VulkanStreamedImage;
+
+    public:
+        inline static constexpr const uint32_t MaxUploadsPerFrame = 2;
+        inline static constexpr const uint32_t MaxUploadsInFlight = 4;
+        inline static constexpr const uint32_t MaxDecodesInFlight = 4; // Decodes run on the job system, this keeps streaming from taking all workers
+    };
+
+}
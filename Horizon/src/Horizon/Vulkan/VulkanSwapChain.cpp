@@ -11,6 +11,7 @@
 #include "Horizon/Vulkan/VulkanContext.hpp"
 #include "Horizon/Vulkan/VulkanImage.hpp"
 #include "Horizon/Vulkan/VulkanPhysicalDevice.hpp"
+#include "Horizon/Vulkan/VulkanRenderpassCache.hpp"
 
 #include <Pulse/Core/Defines.hpp>
 #include <Pulse/Enum/Enum.hpp>
@@ -43,8 +44,10 @@ namespace Hz
 	{
         auto device = VulkanContext::GetDevice()->GetVkDevice();
         VulkanContext::GetDevice()->Wait();
-
-        vkQueueWaitIdle(VulkanContext::GetDevice()->GetGraphicsQueue());
+        {
+            auto queueLock = RenderThread::Lock();
+            vkQueueWaitIdle(VulkanContext::GetDevice()->GetGraphicsQueue());
+        }
 
 		if (m_SwapChain)
 			vkDestroySwapchainKHR(device, m_SwapChain, nullptr);
@@ -230,7 +233,8 @@ namespace Hz
             {
                 Ref<VulkanImage> src = m_Images[i].As<VulkanImage>();
 
-                // Destroy old image view
+                // Destroy old image view (and the framebuffers using it)
+                VulkanRenderpassCache::Evict(src->m_ImageView);
                 vkDestroyImageView(device, src->m_ImageView, nullptr);
 
                 // Set new data
@@ -31,6 +31,7 @@ namespace Hz
 		inline std::vector<Ref<Image>>& GetSwapChainImages() { return m_Images; }
 		inline Ref<Image> GetDepthImage() { return m_DepthStencil; }
 
+		inline const VkSurfaceKHR GetVkSurface() const { return m_Surface; }
 		inline const VkCommandPool GetVkCommandPool() const { return m_CommandPool; }
 		inline const VkSemaphore GetImageAvailableSemaphore(uint32_t index) const { return m_ImageAvailableSemaphores[index]; }
 		inline const VkSemaphore GetCurrentImageAvailableSemaphore() const { return GetImageAvailableSemaphore(m_CurrentFrame); }
@@ -7,6 +7,12 @@
 
 #include "Horizon/Vulkan/VulkanContext.hpp"
 #include "Horizon/Vulkan/VulkanCommandBuffer.hpp"
+#include "Horizon/Vulkan/VulkanDefragmenter.hpp"
+
+#include "Horizon/Utils/Profiler.hpp"
+
+#include <atomic>
+#include <mutex>
 
 // Note: This file builds VMA
 #define VMA_IMPLEMENTATION
@@ -17,6 +23,93 @@ namespace Hz::VkUtils
 
     static VmaAllocator s_Allocator = VK_NULL_HANDLE;
 
+    // Note: Allocation counters are atomic since resources can be created from any thread,
+    // everything else in MemoryInfo is only touched by UpdateStatistics() and AddBudgetCallback().
+    struct MemoryInfo
+    {
+    public:
+        struct BudgetCallback
+        {
+        public:
+            MemoryBudgetCallback Callback;
+            float HighThreshold;
+
+            std::vector<MemoryPressure> Pressure = { }; // Per heap, as classified with our own HighThreshold
+        };
+
+        struct PendingCallback
+        {
+        public:
+            MemoryBudgetCallback Callback;
+            uint32_t Heap;
+            MemoryPressure Pressure;
+        };
+
+        inline static constexpr const float DefaultHighThreshold = 0.9f; // Used for MemoryHeapStatistics::Pressure
+
+        std::array<std::atomic<uint32_t>, (size_t)ResourceKind::Count> Allocations = { };
+        std::array<std::atomic<uint64_t>, (size_t)ResourceKind::Count> Bytes = { };
+
+        // Note: Only UpdateStatistics() writes these, the lock is for readers on other threads
+        std::mutex StatisticsMutex = {};
+        MemoryStatistics Statistics = {};
+        uint32_t FrameIndex = 0;
+
+        std::mutex CallbackMutex = {};
+        std::vector<BudgetCallback> Callbacks = { };
+    };
+
+    static MemoryInfo s_Memory = {};
+
+    static MemoryPressure GetMemoryPressure(const MemoryHeapStatistics& heap, float highThreshold)
+    {
+        if (heap.Usage >= heap.Budget)
+            return MemoryPressure::Exceeded;
+        else if ((double)heap.Usage >= (double)heap.Budget * (double)highThreshold)
+            return MemoryPressure::High;
+
+        return MemoryPressure::Normal;
+    }
+
+    static ResourceKind GetResourceKind(VkBufferUsageFlags usage)
+    {
+        if (usage & VK_BUFFER_USAGE_VERTEX_BUFFER_BIT)
+            return ResourceKind::Vertex;
+        else if (usage & VK_BUFFER_USAGE_INDEX_BUFFER_BIT)
+            return ResourceKind::Index;
+        else if (usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)
+            return ResourceKind::Uniform;
+        else if (usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+            return ResourceKind::Storage;
+        else if (usage == VK_BUFFER_USAGE_TRANSFER_SRC_BIT)
+            return ResourceKind::Staging;
+
+        return ResourceKind::Other;
+    }
+
+    static void TrackAllocation(VmaAllocation allocation, ResourceKind kind)
+    {
+        VmaAllocationInfo info = {};
+        vmaGetAllocationInfo(s_Allocator, allocation, &info);
+
+        s_Memory.Allocations[(size_t)kind].fetch_add(1, std::memory_order_relaxed);
+        s_Memory.Bytes[(size_t)kind].fetch_add(info.size, std::memory_order_relaxed);
+    }
+
+    static void UntrackAllocation(VmaAllocation allocation)
+    {
+        if (allocation == VK_NULL_HANDLE)
+            return;
+
+        VmaAllocationInfo info = {};
+        vmaGetAllocationInfo(s_Allocator, allocation, &info);
+
+        // Note: The ResourceKind is stored as the allocation's user data
+        ResourceKind kind = (ResourceKind)(uintptr_t)info.pUserData;
+        s_Memory.Allocations[(size_t)kind].fetch_sub(1, std::memory_order_relaxed);
+        s_Memory.Bytes[(size_t)kind].fetch_sub(info.size, std::memory_order_relaxed);
+    }
+
     ///////////////////////////////////////////////////////////
     // General helper functions
 	///////////////////////////////////////////////////////////
@@ -75,8 +168,17 @@ namespace Hz::VkUtils
 		allocatorInfo.physicalDevice = VulkanContext::GetPhysicalDevice()->GetVkPhysicalDevice();
 		allocatorInfo.device = VulkanContext::GetDevice()->GetVkDevice();
 		allocatorInfo.pAllocationCallbacks = &callbacks;
+		allocatorInfo.vulkanApiVersion = VK_MAKE_API_VERSION(0, VulkanContext::Version.first, VulkanContext::Version.second, 0);
+
+        if (VulkanContext::GetPhysicalDevice()->SupportsBufferDeviceAddress())
+            allocatorInfo.flags |= VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
+        if (VulkanContext::GetPhysicalDevice()->SupportsMemoryBudget())
+            allocatorInfo.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
 
         VK_CHECK_RESULT(vmaCreateAllocator(&allocatorInfo, &s_Allocator));
+
+        s_Memory.Statistics.BudgetExtension = VulkanContext::GetPhysicalDevice()->SupportsMemoryBudget();
+        UpdateStatistics();
 	}
 
     void Allocator::InitPipelineCache(const std::vector<uint8_t>& data)
@@ -91,6 +193,12 @@ namespace Hz::VkUtils
 
     void Allocator::Destroy()
 	{
+        for (size_t i = 0; i < (size_t)ResourceKind::Count; i++)
+        {
+            if (uint32_t count = s_Memory.Allocations[i].load(); count > 0)
+                HZ_LOG_WARN("{0} allocation(s) of ResourceKind::{1} were not freed before destroying the allocator.", count, Enum::Name((ResourceKind)i));
+        }
+
         vmaDestroyAllocator(s_Allocator);
         s_Allocator = VK_NULL_HANDLE;
 	}
@@ -107,13 +215,17 @@ namespace Hz::VkUtils
 		bufferInfo.usage = usage;
 		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE; // Change if necessary
 
+		ResourceKind kind = GetResourceKind(usage);
+
 		VmaAllocationCreateInfo allocInfo = {};
 		allocInfo.usage = memoryUsage; // VMA_MEMORY_USAGE_GPU_ONLY, VMA_MEMORY_USAGE_CPU_ONLY, etc.
 		allocInfo.requiredFlags = requiredFlags;
+		allocInfo.pUserData = (void*)(uintptr_t)kind;
 
 		VmaAllocation allocation = VK_NULL_HANDLE;
         VK_CHECK_RESULT(vmaCreateBuffer(s_Allocator, &bufferInfo, &allocInfo, &dstBuffer, &allocation, nullptr));
 
+		TrackAllocation(allocation, kind);
 		return allocation;
     }
 
@@ -130,20 +242,69 @@ namespace Hz::VkUtils
 
     void Allocator::DestroyBuffer(VkBuffer buffer, VmaAllocation allocation)
     {
+        // Note: Allocations which are being moved can only be freed after the defragmentation pass
+        if (VulkanDefragmenter::DeferDestruction(allocation, [buffer, allocation]() { DestroyBuffer(buffer, allocation); }))
+            return;
+
+        UntrackAllocation(allocation);
         vmaDestroyBuffer(s_Allocator, buffer, allocation);
     }
 
+    VkDeviceAddress Allocator::GetBufferDeviceAddress(VkBuffer buffer)
+    {
+        VkBufferDeviceAddressInfo addressInfo = {};
+        addressInfo.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
+        addressInfo.buffer = buffer;
+
+        return vkGetBufferDeviceAddress(VulkanContext::GetDevice()->GetVkDevice(), &addressInfo);
+    }
+
+    VkBuffer Allocator::CreateBoundBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VmaAllocation allocation)
+    {
+        VkBufferCreateInfo bufferInfo = {};
+		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferInfo.size = size;
+		bufferInfo.usage = usage;
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VK_CHECK_RESULT(vkCreateBuffer(VulkanContext::GetDevice()->GetVkDevice(), &bufferInfo, nullptr, &buffer));
+        VK_CHECK_RESULT(vmaBindBufferMemory(s_Allocator, allocation, buffer));
+
+        return buffer;
+    }
+
     // Image
     VmaAllocation Allocator::AllocateImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VmaMemoryUsage memUsage, VkImage& image, VkMemoryPropertyFlags requiredFlags)
 	{
+		return AllocateImage(GetImageCreateInfo(width, height, mipLevels, format, tiling, usage), memUsage, image, requiredFlags);
+	}
+
+    VmaAllocation Allocator::AllocateImage(const VkImageCreateInfo& imageInfo, VmaMemoryUsage memUsage, VkImage& image, VkMemoryPropertyFlags requiredFlags)
+	{
+		VmaAllocationCreateInfo allocCreateInfo = {};
+		allocCreateInfo.usage = memUsage;
+		allocCreateInfo.requiredFlags = requiredFlags;
+		allocCreateInfo.pUserData = (void*)(uintptr_t)ResourceKind::Image;
+
+		VmaAllocation allocation = VK_NULL_HANDLE;
+        VK_CHECK_RESULT(vmaCreateImage(s_Allocator, &imageInfo, &allocCreateInfo, &image, &allocation, nullptr));
+
+		TrackAllocation(allocation, ResourceKind::Image);
+		return allocation;
+	}
+
+    VkImageCreateInfo Allocator::GetImageCreateInfo(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, uint32_t depth, uint32_t layers, VkImageType type, VkImageCreateFlags flags)
+    {
 		VkImageCreateInfo imageInfo = {};
 		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.flags = flags;
+		imageInfo.imageType = type;
 		imageInfo.extent.width = width;
 		imageInfo.extent.height = height;
-		imageInfo.extent.depth = 1;
+		imageInfo.extent.depth = depth;
 		imageInfo.mipLevels = mipLevels;
-		imageInfo.arrayLayers = 1;
+		imageInfo.arrayLayers = layers;
 		imageInfo.format = format;
 		imageInfo.tiling = tiling;
 		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -151,15 +312,17 @@ namespace Hz::VkUtils
 		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
 		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
-		VmaAllocationCreateInfo allocCreateInfo = {};
-		allocCreateInfo.usage = memUsage;
-		allocCreateInfo.requiredFlags = requiredFlags;
+        return imageInfo;
+    }
 
-		VmaAllocation allocation = VK_NULL_HANDLE;
-        VK_CHECK_RESULT(vmaCreateImage(s_Allocator, &imageInfo, &allocCreateInfo, &image, &allocation, nullptr));
+    VkImage Allocator::CreateBoundImage(const VkImageCreateInfo& createInfo, VmaAllocation allocation)
+    {
+        VkImage image = VK_NULL_HANDLE;
+        VK_CHECK_RESULT(vkCreateImage(VulkanContext::GetDevice()->GetVkDevice(), &createInfo, nullptr, &image));
+        VK_CHECK_RESULT(vmaBindImageMemory(s_Allocator, allocation, image));
 
-		return allocation;
-	}
+        return image;
+    }
 
 	void Allocator::CopyBufferToImage(VkBuffer& buffer, VkImage& image, uint32_t width, uint32_t height)
 	{
@@ -183,18 +346,18 @@ namespace Hz::VkUtils
 		command.EndAndSubmit();
 	}
 
-	VkImageView Allocator::CreateImageView(VkImage& image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels)
+	VkImageView Allocator::CreateImageView(VkImage& image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels, VkImageViewType viewType, uint32_t layers, uint32_t baseMip, uint32_t baseLayer)
 	{
 		VkImageViewCreateInfo viewInfo = {};
 		viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
 		viewInfo.image = image;
-		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		viewInfo.viewType = viewType;
 		viewInfo.format = format;
 		viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		viewInfo.subresourceRange.baseMipLevel = 0;
+		viewInfo.subresourceRange.baseMipLevel = baseMip;
 		viewInfo.subresourceRange.levelCount = mipLevels;
-		viewInfo.subresourceRange.baseArrayLayer = 0;
-		viewInfo.subresourceRange.layerCount = 1;
+		viewInfo.subresourceRange.baseArrayLayer = baseLayer;
+		viewInfo.subresourceRange.layerCount = layers;
 		viewInfo.subresourceRange.aspectMask = aspectFlags;
 
 		VkImageView imageView = VK_NULL_HANDLE;
@@ -203,43 +366,38 @@ namespace Hz::VkUtils
 		return imageView;
 	}
 
-	VkSampler Allocator::CreateSampler(VkFilter magFilter, VkFilter minFilter, VkSamplerAddressMode addressmode, VkSamplerMipmapMode mipmapMode, uint32_t mipLevels)
-	{
-		VkSamplerCreateInfo samplerInfo = {};
-		samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-		samplerInfo.magFilter = magFilter;
-		samplerInfo.minFilter = minFilter;
-		samplerInfo.addressModeU = addressmode;
-		samplerInfo.addressModeV = addressmode;
-		samplerInfo.addressModeW = addressmode;
-
-		VkPhysicalDeviceProperties properties = {};
-		vkGetPhysicalDeviceProperties(VulkanContext::GetPhysicalDevice()->GetVkPhysicalDevice(), &properties);
-
-		samplerInfo.anisotropyEnable = VK_TRUE;								// Can be disabled: just set VK_FALSE
-		samplerInfo.maxAnisotropy = properties.limits.maxSamplerAnisotropy; // And 1.0f
-
-		samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
-		samplerInfo.unnormalizedCoordinates = VK_FALSE;
-		samplerInfo.compareEnable = VK_FALSE;
-		samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
-
-		samplerInfo.mipmapMode = mipmapMode;
-		samplerInfo.minLod = 0.0f;
-		samplerInfo.maxLod = (float)mipLevels;
-		samplerInfo.mipLodBias = 0.0f; // Optional
-
-		VkSampler sampler = VK_NULL_HANDLE;
-        VK_CHECK_RESULT(vkCreateSampler(VulkanContext::GetDevice()->GetVkDevice(), &samplerInfo, nullptr, &sampler));
-
-		return sampler;
-	}
-
 	void Allocator::DestroyImage(VkImage image, VmaAllocation allocation)
 	{
+        // Note: Allocations which are being moved can only be freed after the defragmentation pass
+        if (VulkanDefragmenter::DeferDestruction(allocation, [image, allocation]() { DestroyImage(image, allocation); }))
+            return;
+
+		UntrackAllocation(allocation);
 		vmaDestroyImage(s_Allocator, image, allocation);
 	}
 
+    // Raw memory
+    VmaAllocation Allocator::AllocateImageMemory(const VkMemoryRequirements& requirements, VmaMemoryUsage memUsage)
+    {
+        VmaAllocationCreateInfo allocCreateInfo = {};
+        allocCreateInfo.usage = memUsage;
+        allocCreateInfo.pUserData = (void*)(uintptr_t)ResourceKind::Image;
+
+        // Note: Lazily allocated memory isn't available on most desktop GPUs, so failing is expected
+        VmaAllocation allocation = VK_NULL_HANDLE;
+        if (vmaAllocateMemory(s_Allocator, &requirements, &allocCreateInfo, &allocation, nullptr) != VK_SUCCESS)
+            return VK_NULL_HANDLE;
+
+        TrackAllocation(allocation, ResourceKind::Image);
+        return allocation;
+    }
+
+    void Allocator::FreeMemory(VmaAllocation allocation)
+    {
+        UntrackAllocation(allocation);
+        vmaFreeMemory(s_Allocator, allocation);
+    }
+
     // Utils
     void Allocator::MapMemory(VmaAllocation& allocation, void *&mapData)
     {
@@ -250,4 +408,126 @@ namespace Hz::VkUtils
     {
         vmaUnmapMemory(s_Allocator, allocation);
     }
+
+    VmaAllocator Allocator::GetVmaAllocator()
+    {
+        return s_Allocator;
+    }
+
+    // Statistics
+    void Allocator::UpdateStatistics()
+    {
+        HZ_PROFILE_SCOPE("Allocator::UpdateStatistics");
+
+        // Note: VMA only refetches the budget from the driver when the frame index changes
+        vmaSetCurrentFrameIndex(s_Allocator, ++s_Memory.FrameIndex);
+
+        const VkPhysicalDeviceMemoryProperties* memoryProperties = nullptr;
+        vmaGetMemoryProperties(s_Allocator, &memoryProperties);
+
+        std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> budgets = { };
+        vmaGetHeapBudgets(s_Allocator, budgets.data());
+
+        // Note: Updated on a copy & published at once, so readers never see half updated statistics
+        MemoryStatistics stats = GetStatistics();
+        stats.Heaps.resize((size_t)memoryProperties->memoryHeapCount);
+        stats.TotalUsage = 0;
+        stats.TotalBudget = 0;
+
+        for (uint32_t i = 0; i < memoryProperties->memoryHeapCount; i++)
+        {
+            MemoryHeapStatistics& heap = stats.Heaps[i];
+            heap.DeviceLocal = memoryProperties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+            heap.Usage = budgets[i].usage;
+            heap.Budget = budgets[i].budget;
+            heap.Peak = std::max(heap.Peak, heap.Usage);
+            heap.AllocatedBytes = budgets[i].statistics.allocationBytes;
+            heap.BlockBytes = budgets[i].statistics.blockBytes;
+
+            stats.TotalUsage += heap.Usage;
+            stats.TotalBudget += heap.Budget;
+
+            // Note: The statistics use the default threshold, callbacks classify with their own below
+            MemoryPressure pressure = GetMemoryPressure(heap, MemoryInfo::DefaultHighThreshold);
+            if (pressure == MemoryPressure::Exceeded && heap.Pressure != MemoryPressure::Exceeded)
+                HZ_LOG_WARN("Memory heap {0} exceeded its budget ({1}/{2} bytes).", i, heap.Usage, heap.Budget);
+
+            heap.Pressure = pressure;
+        }
+        stats.PeakUsage = std::max(stats.PeakUsage, stats.TotalUsage);
+
+        for (size_t i = 0; i < (size_t)ResourceKind::Count; i++)
+        {
+            stats.Allocations[i] = s_Memory.Allocations[i].load(std::memory_order_relaxed);
+            stats.Bytes[i] = s_Memory.Bytes[i].load(std::memory_order_relaxed);
+            stats.PeakBytes[i] = std::max(stats.PeakBytes[i], stats.Bytes[i]);
+        }
+
+        // Tracy plots
+        HZ_PROFILE_PLOT("GPU Memory Usage", (int64_t)stats.TotalUsage);
+        HZ_PROFILE_PLOT("GPU Memory Budget", (int64_t)stats.TotalBudget);
+        HZ_PROFILE_PLOT("GPU Memory Vertex", (int64_t)stats.Bytes[(size_t)ResourceKind::Vertex]);
+        HZ_PROFILE_PLOT("GPU Memory Index", (int64_t)stats.Bytes[(size_t)ResourceKind::Index]);
+        HZ_PROFILE_PLOT("GPU Memory Uniform", (int64_t)stats.Bytes[(size_t)ResourceKind::Uniform]);
+        HZ_PROFILE_PLOT("GPU Memory Storage", (int64_t)stats.Bytes[(size_t)ResourceKind::Storage]);
+        HZ_PROFILE_PLOT("GPU Memory Image", (int64_t)stats.Bytes[(size_t)ResourceKind::Image]);
+        HZ_PROFILE_PLOT("GPU Memory Staging", (int64_t)stats.Bytes[(size_t)ResourceKind::Staging]);
+
+        {
+            std::scoped_lock<std::mutex> lock(s_Memory.StatisticsMutex);
+            s_Memory.Statistics = stats;
+        }
+
+        // Budget callbacks
+        // Note: Every callback tracks the pressure of every heap against its own threshold. The callbacks are
+        // copied out & invoked after unlocking, so they're free to add callbacks or allocate themselves.
+        std::vector<MemoryInfo::PendingCallback> pending = { };
+        {
+            std::scoped_lock<std::mutex> lock(s_Memory.CallbackMutex);
+            for (auto& callback : s_Memory.Callbacks)
+            {
+                callback.Pressure.resize(stats.Heaps.size(), MemoryPressure::Normal);
+
+                for (uint32_t i = 0; i < (uint32_t)stats.Heaps.size(); i++)
+                {
+                    MemoryPressure pressure = GetMemoryPressure(stats.Heaps[i], callback.HighThreshold);
+                    if (pressure == callback.Pressure[i])
+                        continue;
+
+                    callback.Pressure[i] = pressure;
+                    pending.push_back({ callback.Callback, i, pressure });
+                }
+            }
+        }
+
+        for (const auto& invocation : pending)
+            invocation.Callback(invocation.Heap, invocation.Pressure, stats);
+    }
+
+    MemoryStatistics Allocator::GetStatistics()
+    {
+        std::scoped_lock<std::mutex> lock(s_Memory.StatisticsMutex);
+        return s_Memory.Statistics;
+    }
+
+    void Allocator::AddBudgetCallback(MemoryBudgetCallback&& callback, float highThreshold)
+    {
+        HZ_ASSERT((highThreshold > 0.0f && highThreshold <= 1.0f), "The high pressure threshold must be in the range (0, 1].");
+
+        std::scoped_lock<std::mutex> lock(s_Memory.CallbackMutex);
+        s_Memory.Callbacks.push_back({ std::move(callback), highThreshold });
+    }
+
+    bool Allocator::FitsInBudget(VkDeviceSize size, bool deviceLocal)
+    {
+        std::scoped_lock<std::mutex> lock(s_Memory.StatisticsMutex);
+        for (const auto& heap : s_Memory.Statistics.Heaps)
+        {
+            if (heap.DeviceLocal == deviceLocal && heap.Usage + size <= heap.Budget)
+                return true;
+        }
+
+        return false;
+    }
+
 }
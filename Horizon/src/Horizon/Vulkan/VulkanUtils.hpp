@@ -3,6 +3,8 @@
 #include "Horizon/Core/Core.hpp"
 #include "Horizon/Core/Logging.hpp"
 
+#include "Horizon/Renderer/Renderer.hpp"
+
 #include <Pulse/Enum/Enum.hpp>
 
 #include <vector>
@@ -42,17 +44,32 @@ namespace Hz::VkUtils
         static VmaAllocation AllocateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VmaMemoryUsage memoryUsage, VkBuffer& dstBuffer, VkMemoryPropertyFlags requiredFlags = 0);
 		static void CopyBuffer(VkBuffer& srcBuffer, VkBuffer& dstBuffer, VkDeviceSize size);
 		static void DestroyBuffer(VkBuffer buffer, VmaAllocation allocation);
+        static VkDeviceAddress GetBufferDeviceAddress(VkBuffer buffer); // Buffer needs VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
+        static VkBuffer CreateBoundBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VmaAllocation allocation); // Creates a buffer bound to an existing allocation (used by defragmentation)
 
         // Image
         static VmaAllocation AllocateImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VmaMemoryUsage memUsage, VkImage& image, VkMemoryPropertyFlags requiredFlags = {});
+        static VmaAllocation AllocateImage(const VkImageCreateInfo& createInfo, VmaMemoryUsage memUsage, VkImage& image, VkMemoryPropertyFlags requiredFlags = {});
+        static VkImageCreateInfo GetImageCreateInfo(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, uint32_t depth = 1, uint32_t layers = 1, VkImageType type = VK_IMAGE_TYPE_2D, VkImageCreateFlags flags = 0);
+        static VkImage CreateBoundImage(const VkImageCreateInfo& createInfo, VmaAllocation allocation); // Creates an image bound to an existing allocation (used by defragmentation)
 		static void CopyBufferToImage(VkBuffer& buffer, VkImage& image, uint32_t width, uint32_t height);
-		static VkImageView CreateImageView(VkImage& image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels);
-		static VkSampler CreateSampler(VkFilter magFilter, VkFilter minFilter, VkSamplerAddressMode addressmode, VkSamplerMipmapMode mipmapMode, uint32_t mipLevels);
+		static VkImageView CreateImageView(VkImage& image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels, VkImageViewType viewType = VK_IMAGE_VIEW_TYPE_2D, uint32_t layers = 1, uint32_t baseMip = 0, uint32_t baseLayer = 0);
 		static void DestroyImage(VkImage image, VmaAllocation allocation);
 
+        // Raw memory, Note: Used by the render target pool to recycle allocations across images
+        static VmaAllocation AllocateImageMemory(const VkMemoryRequirements& requirements, VmaMemoryUsage memUsage); // Returns VK_NULL_HANDLE if no memory type fits
+        static void FreeMemory(VmaAllocation allocation);
+
         // Utils
         static void MapMemory(VmaAllocation& allocation, void*& mapData);
 		static void UnMapMemory(VmaAllocation& allocation);
+        static VmaAllocator GetVmaAllocator();
+
+        // Statistics
+        static void UpdateStatistics(); // Note: Gets called by the renderer every frame, refreshes budgets/peaks and runs the budget callbacks
+        static MemoryStatistics GetStatistics(); // Note: Returns a copy, since the render thread updates them
+        static void AddBudgetCallback(MemoryBudgetCallback&& callback, float highThreshold);
+        static bool FitsInBudget(VkDeviceSize size, bool deviceLocal = true); // Checks the last fetched budget, useful to decide whether to stream something in
 
     public:
         inline static VkPipelineCache s_PipelineCache = VK_NULL_HANDLE;
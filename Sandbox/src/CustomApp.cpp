@@ -12,10 +12,10 @@ const std::vector<float> vertexData = {
     0.5f, -0.5f,        0.0f, 0.0f, 1.0f  // Vertex 3: Bottom-right vertex, Blue
 };
 
-CustomApp::CustomApp()
+CustomApp::CustomApp(bool useRenderThread)
 {
     WindowSpecification windowSpecs = { 1280, 720, "Window", [this](Event& e){ EventCallback(e); }};
-    RendererSpecification rendererSpecs = { BufferCount::Triple, false };
+    RendererSpecification rendererSpecs = { BufferCount::Triple, false, useRenderThread };
     m_Window = Window::Create(windowSpecs, rendererSpecs);
 
     m_Renderpass = Renderpass::Create({
@@ -90,8 +90,13 @@ void CustomApp::Run()
 
         Renderer::Begin(m_Renderpass);
 
-        m_Pipeline->Use(m_Renderpass->GetCommandBuffer());
-        m_VertexBuffer->Bind(m_Renderpass->GetCommandBuffer());
+        // Note: Recording outside of the Renderer has to be enqueued, so it keeps working with a render thread.
+        // The objects are captured by value, so they stay alive until the render thread has executed the frame.
+        Renderer::Enqueue([pipeline = m_Pipeline, renderpass = m_Renderpass, vertexBuffer = m_VertexBuffer]()
+        {
+            pipeline->Use(renderpass->GetCommandBuffer());
+            vertexBuffer->Bind(renderpass->GetCommandBuffer());
+        });
 
         Renderer::Draw(m_Renderpass->GetCommandBuffer(), 3);
 
@@ -18,7 +18,7 @@ using namespace Hz;
 class CustomApp
 {
 public:
-    CustomApp();
+    CustomApp(bool useRenderThread = false);
     ~CustomApp();
 
     void Run();
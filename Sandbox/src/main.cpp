@@ -1,9 +1,27 @@
 #include "CustomApp.hpp"
 
+#include <Horizon/Utils/AllocationTracker.hpp>
+
+#include <string_view>
+
 int main(int argc, char* argv[])
 {
+    bool steadyState = false;
+    bool renderThread = false;
+    for (int i = 1; i < argc; i++)
     {
-        CustomApp app = {};
+        std::string_view arg = argv[i];
+        steadyState |= (arg == "--steady-state");
+        renderThread |= (arg == "--render-thread"); // Executes the frames on a dedicated render thread
+    }
+
+    {
+        CustomApp app = CustomApp(renderThread);
+
+        // Note: Aborts when a frame after the warmup allocates, requires HZ_MEM_PROFILING
+        if (steadyState)
+            AllocationTracker::EnableSteadyStateCheck();
+
         app.Run();
     }
 
@@ -0,0 +1,78 @@
+#include <Horizon/Core/Logging.hpp>
+
+#include <Horizon/Renderer/ImageFile.hpp>
+#include <Horizon/Renderer/ImageEncoder.hpp>
+
+#include <stb_image.h>
+
+#include <string>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+
+using namespace Hz;
+
+// Converts an image (png, jpg, ...) into a .ktx2 file with a pre-generated mip chain.
+// Usage: TextureCompressor <input> <output.ktx2> [--format rgba|bc1|bc1a|bc3|bc4|bc5] [--srgb] [--no-mips]
+int main(int argc, char* argv[])
+{
+    Log::Init();
+
+    if (argc < 3)
+    {
+        std::cout << "Usage: TextureCompressor <input> <output.ktx2> [--format rgba|bc1|bc1a|bc3|bc4|bc5] [--srgb] [--no-mips]\n";
+        return 1;
+    }
+
+    std::string input = argv[1];
+    std::string output = argv[2];
+    std::string format = "bc3";
+    bool sRGB = false;
+    bool mipmaps = true;
+
+    for (int i = 3; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--format") == 0 && i + 1 < argc)
+            format = argv[++i];
+        else if (std::strcmp(argv[i], "--srgb") == 0)
+            sRGB = true;
+        else if (std::strcmp(argv[i], "--no-mips") == 0)
+            mipmaps = false;
+        else
+            HZ_LOG_WARN("Unknown argument '{0}'", argv[i]);
+    }
+
+    static const std::unordered_map<std::string, std::pair<ImageFormat, ImageFormat>> formats = // Linear, sRGB
+    {
+        { "rgba", { ImageFormat::RGBA, ImageFormat::sRGB } },
+        { "bc1",  { ImageFormat::BC1, ImageFormat::BC1sRGB } },
+        { "bc1a", { ImageFormat::BC1A, ImageFormat::BC1AsRGB } },
+        { "bc3",  { ImageFormat::BC3, ImageFormat::BC3sRGB } },
+        { "bc4",  { ImageFormat::BC4, ImageFormat::BC4 } },
+        { "bc5",  { ImageFormat::BC5, ImageFormat::BC5 } },
+    };
+
+    auto it = formats.find(format);
+    if (it == formats.end())
+    {
+        HZ_LOG_ERROR("Unsupported format '{0}'", format);
+        return 1;
+    }
+
+    int width, height, texChannels;
+    stbi_uc* pixels = stbi_load(input.c_str(), &width, &height, &texChannels, STBI_rgb_alpha);
+    if (!pixels)
+    {
+        HZ_LOG_ERROR("Failed to load image from '{0}'", input);
+        return 1;
+    }
+
+    auto data = ImageEncoder::Encode(pixels, (uint32_t)width, (uint32_t)height, sRGB ? it->second.second : it->second.first, mipmaps);
+    stbi_image_free((void*)pixels);
+
+    if (!data || !ImageFile::WriteKTX2(output, data.value()))
+        return 1;
+
+    HZ_LOG_INFO("Wrote '{0}' ({1}x{2}, {3} levels, {4} bytes)", output, width, height, data->Levels.size(), data->Data.size());
+    return 0;
+}
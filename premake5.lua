@@ -90,5 +90,9 @@ group "Horizon"
 	include "Horizon"
 group ""
 
+group "Tools"
+	include "Tools/TextureCompressor"
+group ""
+
 include "Sandbox"
 ------------------------------------------------------------------------------